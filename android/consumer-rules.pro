@@ -0,0 +1,2 @@
+# Frame classes are constructed and their fields are written from JNI by name.
+-keep class io.agora.rtc.rawdata.base.** { *; }
@@ -1,15 +1,194 @@
 #include "AudioFrameObserver.h"
+#include "AudioInjector.h"
+#include "AudioRenderPump.h"
+#include "VMUtil.h"
 #include "VideoFrameObserver.h"
 #include <jni.h>
+#include <map>
+#include <string>
+#include <vector>
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeRegisterAudioFrameObserver(
-    JNIEnv *env, jobject jCaller, jlong engineHandle) {
-  auto observer = new agora::AudioFrameObserver(env, jCaller, engineHandle);
+    JNIEnv *env, jobject jCaller, jlong engineHandle, jint bufferType,
+    jint observedPosition, jintArray jAudioParams, jint deliveryMode,
+    jint deliveryFrames) {
+  using agora::AudioFrameObserver;
+  const int count = AudioFrameObserver::POSITION_INDEX_COUNT;
+  // Four ints per POSITION_INDEX: rate, channels, mode, samples per call.
+  AudioFrameObserver::AudioParams params[count];
+  jint values[count * 4];
+  env->GetIntArrayRegion(jAudioParams, 0, count * 4, values);
+  for (int i = 0; i < count; ++i) {
+    params[i] = AudioFrameObserver::AudioParams(
+        values[i * 4], values[i * 4 + 1],
+        (agora::rtc::RAW_AUDIO_FRAME_OP_MODE_TYPE)values[i * 4 + 2],
+        values[i * 4 + 3]);
+  }
+  auto observer =
+      new AudioFrameObserver(env, jCaller, engineHandle, bufferType,
+                             observedPosition, params, deliveryMode,
+                             deliveryFrames);
   jlong ret = reinterpret_cast<intptr_t>(observer);
   return ret;
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetAudioParams(
+    JNIEnv *, jobject, jlong nativeHandle, jint position, jint sampleRate,
+    jint channels, jint mode, jint samplesPerCall) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->setAudioParams(
+      position, agora::AudioFrameObserver::AudioParams(
+                    sampleRate, channels,
+                    (agora::rtc::RAW_AUDIO_FRAME_OP_MODE_TYPE)mode,
+                    samplesPerCall));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetObservedAudioFramePosition(
+    JNIEnv *, jobject, jlong nativeHandle, jint position) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->setObservedAudioFramePosition(position);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetBeforeMixingUidFilter(
+    JNIEnv *env, jobject, jlong nativeHandle, jintArray jAllow,
+    jintArray jDeny) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  // uid_t and jint have the same width, Java ints carry uids above 2^31 as
+  // negative values.
+  std::vector<agora::rtc::uid_t> allow, deny;
+  if (jAllow) {
+    allow.resize(env->GetArrayLength(jAllow));
+    env->GetIntArrayRegion(jAllow, 0, allow.size(),
+                           reinterpret_cast<jint *>(allow.data()));
+  }
+  if (jDeny) {
+    deny.resize(env->GetArrayLength(jDeny));
+    env->GetIntArrayRegion(jDeny, 0, deny.size(),
+                           reinterpret_cast<jint *>(deny.data()));
+  }
+  observer->setBeforeMixingUidFilter(allow.data(),
+                                     jAllow ? (int)allow.size() : -1,
+                                     deny.data(), (int)deny.size());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetBeforeMixingSampleRate(
+    JNIEnv *, jobject, jlong nativeHandle, jint sampleRate) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->setBeforeMixingSampleRate(sampleRate);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetAudioLevelMetering(
+    JNIEnv *, jobject, jlong nativeHandle, jint positions, jint intervalMs) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->setAudioLevelMetering(positions, intervalMs);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeSetVoiceActivityDetection(
+    JNIEnv *, jobject, jlong nativeHandle, jint positions, jboolean gating) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->setVoiceActivityDetection(positions, gating);
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeStartAudioRecording(
+    JNIEnv *env, jobject, jlong nativeHandle, jint position, jlong uid,
+    jstring jPathPrefix, jint format, jlong maxFileBytes,
+    jint maxFileDurationMs) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  agora::AudioFileRecorder::Config config;
+  const char *pathPrefix = env->GetStringUTFChars(jPathPrefix, nullptr);
+  config.pathPrefix = pathPrefix;
+  env->ReleaseStringUTFChars(jPathPrefix, pathPrefix);
+  config.format = format;
+  // A negative uid records every uid.
+  config.filterUid = uid >= 0;
+  config.uid = static_cast<agora::rtc::uid_t>(uid);
+  config.maxFileBytes = maxFileBytes;
+  config.maxFileDurationMs = maxFileDurationMs;
+  return observer->startAudioRecording(position, config);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeStopAudioRecording(
+    JNIEnv *, jobject, jlong nativeHandle, jint id) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->stopAudioRecording(id);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeGetAudioRecordingStats(
+    JNIEnv *env, jobject, jlong nativeHandle, jint id) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  agora::AudioFileRecorder::Stats stats;
+  if (!observer->getAudioRecordingStats(id, stats)) {
+    return nullptr;
+  }
+  jlong values[] = {stats.bytesWritten, stats.bytesDropped, stats.files};
+  jlongArray jValues = env->NewLongArray(3);
+  env->SetLongArrayRegion(jValues, 0, 3, values);
+  return jValues;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeGetDeliveryStats(
+    JNIEnv *env, jobject, jlong nativeHandle, jint position) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  agora::AsyncAudioDelivery::Stats stats;
+  if (!observer->getDeliveryStats(position, stats)) {
+    return nullptr;
+  }
+  // Same order as IAudioFrameObserver.STATS_*.
+  jlong values[] = {stats.delivered, stats.overflow, stats.dropped,
+                    stats.highWaterMark, stats.capacity};
+  jlongArray jValues = env->NewLongArray(5);
+  env->SetLongArrayRegion(jValues, 0, 5, values);
+  return jValues;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeGetCallbackTiming(
+    JNIEnv *env, jobject, jlong nativeHandle, jint position, jint metric) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  agora::LatencyHistogram::Snapshot snapshot;
+  if (!observer->getCallbackTiming(
+          position, static_cast<agora::CallbackTiming::METRIC>(metric),
+          snapshot)) {
+    return nullptr;
+  }
+  // Same order as IAudioFrameObserver.TIMING_*, then a lower bound and count
+  // pair per non-empty bucket.
+  std::vector<jlong> values = {snapshot.count,
+                               snapshot.sumUs,
+                               snapshot.minUs,
+                               snapshot.maxUs,
+                               snapshot.Percentile(0.5),
+                               snapshot.Percentile(0.9),
+                               snapshot.Percentile(0.99)};
+  for (int i = 0; i < agora::LatencyHistogram::BUCKET_COUNT; ++i) {
+    if (snapshot.buckets[i] > 0) {
+      values.push_back(agora::LatencyHistogram::BucketLowerBound(i));
+      values.push_back(snapshot.buckets[i]);
+    }
+  }
+  jlongArray jValues = env->NewLongArray(values.size());
+  env->SetLongArrayRegion(jValues, 0, values.size(), values.data());
+  return jValues;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeResetCallbackTiming(
+    JNIEnv *, jobject, jlong nativeHandle) {
+  auto observer = reinterpret_cast<agora::AudioFrameObserver *>(nativeHandle);
+  observer->resetCallbackTiming();
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeUnregisterAudioFrameObserver(
     JNIEnv *, jobject, jlong nativeHandle) {
@@ -19,15 +198,310 @@ Java_io_agora_rtc_rawdata_base_IAudioFrameObserver_nativeUnregisterAudioFrameObs
 
 extern "C" JNIEXPORT jlong JNICALL
 Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeRegisterVideoFrameObserver(
-    JNIEnv *env, jobject jCaller, jlong engineHandle) {
-  auto observer = new agora::VideoFrameObserver(env, jCaller, engineHandle);
+    JNIEnv *env, jobject jCaller, jlong engineHandle, jint bufferType,
+    jint planeMode, jint formatPreference, jboolean rotationApplied, jboolean mirrorApplied,
+    jint observedFramePosition) {
+  agora::VideoFrameObserver::Preferences preferences;
+  preferences.formatPreference =
+      (agora::media::base::VIDEO_PIXEL_FORMAT)formatPreference;
+  preferences.rotationApplied = rotationApplied;
+  preferences.mirrorApplied = mirrorApplied;
+  preferences.observedFramePosition = observedFramePosition;
+  auto observer = new agora::VideoFrameObserver(
+      env, jCaller, engineHandle, bufferType, planeMode, preferences);
   jlong ret = reinterpret_cast<intptr_t>(observer);
   return ret;
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeSetPreferences(
+    JNIEnv *, jobject, jlong nativeHandle, jint formatPreference,
+    jboolean rotationApplied, jboolean mirrorApplied,
+    jint observedFramePosition) {
+  auto observer = reinterpret_cast<agora::VideoFrameObserver *>(nativeHandle);
+  agora::VideoFrameObserver::Preferences preferences;
+  preferences.formatPreference =
+      (agora::media::base::VIDEO_PIXEL_FORMAT)formatPreference;
+  preferences.rotationApplied = rotationApplied;
+  preferences.mirrorApplied = mirrorApplied;
+  preferences.observedFramePosition = observedFramePosition;
+  observer->setPreferences(preferences);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeUnregisterVideoFrameObserver(
     JNIEnv *, jobject, jlong nativeHandle) {
   auto observer = reinterpret_cast<agora::VideoFrameObserver *>(nativeHandle);
   delete observer;
 }
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeClearVideoProcessors(
+    JNIEnv *, jobject, jlong nativeHandle, jint position) {
+  auto observer = reinterpret_cast<agora::VideoFrameObserver *>(nativeHandle);
+  observer->clearVideoProcessors(position);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeAddVideoProcessor(
+    JNIEnv *env, jobject, jlong nativeHandle, jint position, jstring jName,
+    jobjectArray jKeys, jdoubleArray jValues) {
+  auto observer = reinterpret_cast<agora::VideoFrameObserver *>(nativeHandle);
+  const char *name = env->GetStringUTFChars(jName, nullptr);
+  std::string processorName(name);
+  env->ReleaseStringUTFChars(jName, name);
+
+  std::map<std::string, double> params;
+  std::vector<double> values(env->GetArrayLength(jValues));
+  env->GetDoubleArrayRegion(jValues, 0, values.size(), values.data());
+  for (jsize i = 0; i < (jsize)values.size(); ++i) {
+    jstring jKey = static_cast<jstring>(env->GetObjectArrayElement(jKeys, i));
+    const char *key = env->GetStringUTFChars(jKey, nullptr);
+    params[key] = values[i];
+    env->ReleaseStringUTFChars(jKey, key);
+    env->DeleteLocalRef(jKey);
+  }
+
+  auto processor = agora::CreateVideoProcessor(processorName, params);
+  if (!processor) {
+    LOGE("VideoFrameObserver: unknown video processor %s",
+         processorName.c_str());
+    return JNI_FALSE;
+  }
+  observer->addVideoProcessor(position, processor);
+  return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_IVideoFrameObserver_nativeSetNativeOnlyPositions(
+    JNIEnv *, jobject, jlong nativeHandle, jint positions) {
+  auto observer = reinterpret_cast<agora::VideoFrameObserver *>(nativeHandle);
+  observer->setNativeOnlyPositions(positions);
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_io_agora_rtc_rawdata_base_AttachThreadStats_getAttachCount(JNIEnv *,
+                                                                jclass) {
+  return AttachThreadCount().load();
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_io_agora_rtc_rawdata_base_AttachThreadStats_getDetachCount(JNIEnv *,
+                                                                jclass) {
+  return DetachThreadCount().load();
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_io_agora_rtc_rawdata_base_AudioInjector_nativeStart(
+    JNIEnv *, jobject, jlong engineHandle, jint sampleRate, jint channels,
+    jint trackId, jint jitterFrames, jint capacityFrames) {
+  agora::AudioInjector::Config config;
+  config.sampleRate = sampleRate;
+  config.channels = channels;
+  config.trackId = static_cast<unsigned>(trackId);
+  if (jitterFrames > 0) {
+    config.jitterFrames = jitterFrames;
+  }
+  if (capacityFrames > 0) {
+    config.capacityFrames = capacityFrames;
+  }
+  auto injector = new agora::AudioInjector(engineHandle, config);
+  if (!injector->Start()) {
+    delete injector;
+    return 0;
+  }
+  return reinterpret_cast<intptr_t>(injector);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_AudioInjector_nativeStop(JNIEnv *, jobject,
+                                                        jlong nativeHandle) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  delete injector;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_agora_rtc_rawdata_base_AudioInjector_nativeWrite(
+    JNIEnv *env, jobject, jlong nativeHandle, jbyteArray jData, jint offset,
+    jint length) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  if (offset < 0 || length < 0 ||
+      offset + length > env->GetArrayLength(jData)) {
+    return 0;
+  }
+  // Write() only copies and never blocks, so the critical section is short.
+  auto data =
+      static_cast<jbyte *>(env->GetPrimitiveArrayCritical(jData, nullptr));
+  if (!data) {
+    return 0;
+  }
+  jint accepted = injector->Write(data + offset, length);
+  env->ReleasePrimitiveArrayCritical(jData, data, JNI_ABORT);
+  return accepted;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_agora_rtc_rawdata_base_AudioInjector_nativeWriteDirect(
+    JNIEnv *env, jobject, jlong nativeHandle, jobject jData, jint offset,
+    jint length) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  auto data = static_cast<jbyte *>(env->GetDirectBufferAddress(jData));
+  if (!data || offset < 0 || length < 0 ||
+      static_cast<jlong>(offset) + length >
+          env->GetDirectBufferCapacity(jData)) {
+    return 0;
+  }
+  return injector->Write(data + offset, length);
+}
+
+// Dart copies into the injection ring through dart:ffi, with the handle
+// returned by startAudioInjection, on one isolate and never concurrently with
+// AudioInjector.write on the Java side. The pointer never outlives one Dart
+// pushAudio call, and Dart drops the handle before asking to stop.
+extern "C" __attribute__((visibility("default"))) int32_t
+AgoraRtcRawdata_AudioInjectorBeginWrite(int64_t nativeHandle) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  unsigned char *data;
+  return injector->BeginWrite(data);
+}
+
+extern "C" __attribute__((visibility("default"))) uint8_t *
+AgoraRtcRawdata_AudioInjectorWritePointer(int64_t nativeHandle) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  unsigned char *data = nullptr;
+  return injector->BeginWrite(data) > 0 ? data : nullptr;
+}
+
+extern "C" __attribute__((visibility("default"))) void
+AgoraRtcRawdata_AudioInjectorCommitWrite(int64_t nativeHandle,
+                                         int32_t length) {
+  reinterpret_cast<agora::AudioInjector *>(nativeHandle)->CommitWrite(length);
+}
+
+extern "C" __attribute__((visibility("default"))) void
+AgoraRtcRawdata_AudioInjectorRefuse(int64_t nativeHandle, int32_t length) {
+  reinterpret_cast<agora::AudioInjector *>(nativeHandle)->Refuse(length);
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_io_agora_rtc_rawdata_base_AudioInjector_nativeGetStats(
+    JNIEnv *env, jobject, jlong nativeHandle) {
+  auto injector = reinterpret_cast<agora::AudioInjector *>(nativeHandle);
+  agora::AudioInjector::Stats stats = injector->GetStats();
+  // Same order as AudioInjector.STATS_*.
+  jlong values[] = {stats.framesPushed,   stats.silentFrames,
+                    stats.underruns,      stats.bytesRefused,
+                    stats.lateTicks,      stats.pushErrors,
+                    stats.bufferedFrames, stats.capacityFrames};
+  jlongArray jValues = env->NewLongArray(8);
+  env->SetLongArrayRegion(jValues, 0, 8, values);
+  return jValues;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeStart(
+    JNIEnv *, jobject, jlong engineHandle, jint sampleRate, jint channels,
+    jint periodMs, jint depthFrames) {
+  agora::AudioRenderPump::Config config;
+  config.sampleRate = sampleRate;
+  config.channels = channels;
+  if (periodMs > 0) {
+    config.periodMs = periodMs;
+  }
+  if (depthFrames > 0) {
+    config.depthFrames = depthFrames;
+  }
+  auto pump = new agora::AudioRenderPump(engineHandle, config);
+  if (!pump->Start()) {
+    delete pump;
+    return 0;
+  }
+  return reinterpret_cast<intptr_t>(pump);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeStop(JNIEnv *, jobject,
+                                                          jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  delete pump;
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeGetBuffer(
+    JNIEnv *env, jobject, jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  return env->NewDirectByteBuffer(pump->buffer(), pump->bufferBytes());
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeGetFrameBytes(
+    JNIEnv *, jobject, jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  return pump->frameBytes();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeAcquire(
+    JNIEnv *, jobject, jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  agora::AudioRenderPump::AudioFrame frame;
+  if (!pump->Acquire(frame)) {
+    return -1;
+  }
+  return static_cast<jint>(static_cast<unsigned char *>(frame.buffer) -
+                           static_cast<unsigned char *>(pump->buffer()));
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeRelease(
+    JNIEnv *, jobject, jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  pump->Release();
+}
+
+// Dart reads the pulled frames in place through dart:ffi, with the handle
+// returned by startAudioRendering, on one isolate and never concurrently with
+// AudioRenderPump.acquire on the Java side. A frame never outlives one Dart
+// readRenderedAudio call, and Dart drops the handle before asking to stop.
+extern "C" __attribute__((visibility("default"))) uint8_t *
+AgoraRtcRawdata_AudioRenderPumpAcquire(int64_t nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  agora::AudioRenderPump::AudioFrame frame;
+  if (!pump->Acquire(frame)) {
+    return nullptr;
+  }
+  return static_cast<uint8_t *>(frame.buffer);
+}
+
+extern "C" __attribute__((visibility("default"))) int32_t
+AgoraRtcRawdata_AudioRenderPumpFrameBytes(int64_t nativeHandle) {
+  return reinterpret_cast<agora::AudioRenderPump *>(nativeHandle)
+      ->frameBytes();
+}
+
+extern "C" __attribute__((visibility("default"))) void
+AgoraRtcRawdata_AudioRenderPumpRelease(int64_t nativeHandle) {
+  reinterpret_cast<agora::AudioRenderPump *>(nativeHandle)->Release();
+}
+
+extern "C" __attribute__((visibility("default"))) int32_t
+AgoraRtcRawdata_AudioRenderPumpBufferedFrames(int64_t nativeHandle) {
+  return reinterpret_cast<agora::AudioRenderPump *>(nativeHandle)
+      ->GetStats()
+      .bufferedFrames;
+}
+
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_io_agora_rtc_rawdata_base_AudioRenderPump_nativeGetStats(
+    JNIEnv *env, jobject, jlong nativeHandle) {
+  auto pump = reinterpret_cast<agora::AudioRenderPump *>(nativeHandle);
+  agora::AudioRenderPump::Stats stats = pump->GetStats();
+  // Same order as AudioRenderPump.STATS_*.
+  jlong values[] = {stats.framesPulled, stats.pullErrors,
+                    stats.overruns,     stats.underruns,
+                    stats.lateTicks,    stats.bufferedFrames,
+                    stats.depthFrames};
+  jlongArray jValues = env->NewLongArray(7);
+  env->SetLongArrayRegion(jValues, 0, 7, values);
+  return jValues;
+}
@@ -0,0 +1,14 @@
+package io.agora.rtc.rawdata.base;
+
+/**
+ * How often native callback threads were attached to and detached from the
+ * Java VM. Each SDK thread is attached once and detached when it exits, so
+ * both counters stay flat while frames are flowing.
+ */
+public final class AttachThreadStats {
+  private AttachThreadStats() {}
+
+  public static native long getAttachCount();
+
+  public static native long getDetachCount();
+}
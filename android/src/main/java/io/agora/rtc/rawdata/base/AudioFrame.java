@@ -1,8 +1,14 @@
 package io.agora.rtc.rawdata.base;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
 public class AudioFrame {
   public enum AudioFrameType {
-    PCM16(0);
+    PCM16(0),
+    /** {@link IAudioFrameObserver#BUFFER_TYPE_FLOAT_PLANAR}, Java side only. */
+    FLOAT32_PLANAR(1);
 
     private final int value;
 
@@ -17,6 +23,7 @@ public class AudioFrame {
   private int channels;
   private int samplesPerSec;
   private byte[] buffer;
+  private ByteBuffer byteBuffer;
   private long renderTimeMs;
   private int avsync_type;
 
@@ -33,6 +40,25 @@ public class AudioFrame {
     this.avsync_type = avsync_type;
   }
 
+  /**
+   * Wraps the SDK buffer without copying, used with
+   * {@link IAudioFrameObserver#BUFFER_TYPE_DIRECT_BYTE_BUFFER}. The buffer is
+   * only valid during the callback, writes go straight to the SDK. A factory
+   * rather than a constructor overload, so {@code new AudioFrame(..., null,
+   * ...)} stays unambiguous.
+   */
+  public static AudioFrame fromByteBuffer(int type, int samples,
+                                          int bytesPerSample, int channels,
+                                          int samplesPerSec,
+                                          ByteBuffer byteBuffer,
+                                          long renderTimeMs, int avsync_type) {
+    AudioFrame frame = new AudioFrame(type, samples, bytesPerSample, channels,
+                                      samplesPerSec, null, renderTimeMs,
+                                      avsync_type);
+    frame.byteBuffer = byteBuffer;
+    return frame;
+  }
+
   public AudioFrameType getType() { return type; }
 
   public void setType(int type) { this.type = AudioFrameType.values()[type]; }
@@ -61,6 +87,23 @@ public class AudioFrame {
 
   public void setBuffer(byte[] buffer) { this.buffer = buffer; }
 
+  public ByteBuffer getByteBuffer() { return byteBuffer; }
+
+  /**
+   * The samples of a {@link AudioFrameType#FLOAT32_PLANAR} frame, channel
+   * {@code c} at {@link #getChannelOffset(int)}. Only valid during the
+   * callback.
+   */
+  public FloatBuffer getFloatBuffer() {
+    if (byteBuffer == null || type != AudioFrameType.FLOAT32_PLANAR) {
+      return null;
+    }
+    return byteBuffer.order(ByteOrder.nativeOrder()).asFloatBuffer();
+  }
+
+  /** Index of the first sample of {@code channel} in the planar layout. */
+  public int getChannelOffset(int channel) { return channel * samples; }
+
   public long getRenderTimeMs() { return renderTimeMs; }
 
   public void setRenderTimeMs(long renderTimeMs) {
@@ -0,0 +1,54 @@
+package io.agora.rtc.rawdata.base;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Consecutive frames of one position delivered in a single call, see
+ * {@link IAudioFrameObserver#DELIVERY_MODE_BATCH}. Every frame of a batch has
+ * the same format, their PCM is stored back to back, frame {@code i} starts at
+ * {@code i * getFrameBytes()}. Read-only, reused for the next batch.
+ */
+public class AudioFrameBatch {
+  private int position;
+  private int frameCount;
+  private int samples;
+  private int bytesPerSample;
+  private int channels;
+  private int samplesPerSec;
+  private byte[] buffer;
+  private ByteBuffer byteBuffer;
+  private final int[] uids;
+  private final long[] renderTimeMs;
+
+  AudioFrameBatch(int capacity) {
+    uids = new int[capacity];
+    renderTimeMs = new long[capacity];
+  }
+
+  /** One of the {@code IAudioFrameObserver.POSITION_*} bits. */
+  public int getPosition() { return position; }
+
+  public int getFrameCount() { return frameCount; }
+
+  /** Samples per channel of each frame. */
+  public int getSamples() { return samples; }
+
+  public int getBytesPerSample() { return bytesPerSample; }
+
+  public int getChannels() { return channels; }
+
+  public int getSamplesPerSec() { return samplesPerSec; }
+
+  public int getFrameBytes() { return samples * channels * bytesPerSample; }
+
+  /** Set with {@link IAudioFrameObserver#BUFFER_TYPE_BYTE_ARRAY}. */
+  public byte[] getBuffer() { return buffer; }
+
+  /** Set with {@link IAudioFrameObserver#BUFFER_TYPE_DIRECT_BYTE_BUFFER}. */
+  public ByteBuffer getByteBuffer() { return byteBuffer; }
+
+  /** Uid of each frame, only meaningful for POSITION_BEFORE_MIXING. */
+  public int getUid(int frame) { return uids[frame]; }
+
+  public long getRenderTimeMs(int frame) { return renderTimeMs[frame]; }
+}
@@ -0,0 +1,110 @@
+package io.agora.rtc.rawdata.base;
+
+import androidx.annotation.NonNull;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Pushes app PCM16 into the SDK through {@code IMediaEngine::pushAudioFrame}.
+ * {@link #write} copies straight into a native lock-free ring of 10 ms frames
+ * and never blocks; a native thread paces the frames out every 10 ms after
+ * {@code jitterFrames} are buffered. Enable the external audio source or
+ * create a custom audio track before starting.
+ */
+public class AudioInjector {
+  /** Indices of the array returned by {@link #getStats()}. */
+  public static final int STATS_FRAMES_PUSHED = 0;
+  public static final int STATS_SILENT_FRAMES = 1;
+  public static final int STATS_UNDERRUNS = 2;
+  public static final int STATS_BYTES_REFUSED = 3;
+  public static final int STATS_LATE_TICKS = 4;
+  public static final int STATS_PUSH_ERRORS = 5;
+  public static final int STATS_BUFFERED_FRAMES = 6;
+  public static final int STATS_CAPACITY_FRAMES = 7;
+
+  private final long engineHandle;
+  private final int sampleRate, channels, trackId;
+  private final int jitterFrames, capacityFrames;
+  private long nativeHandle;
+
+  public AudioInjector(long engineHandle, int sampleRate, int channels,
+                       int trackId, int jitterFrames, int capacityFrames) {
+    this.engineHandle = engineHandle;
+    this.sampleRate = sampleRate;
+    this.channels = channels;
+    this.trackId = trackId;
+    this.jitterFrames = jitterFrames;
+    this.capacityFrames = capacityFrames;
+  }
+
+  /** Returns false if the engine or the format is invalid. */
+  public synchronized boolean start() {
+    if (nativeHandle == 0) {
+      nativeHandle = nativeStart(engineHandle, sampleRate, channels, trackId,
+                                 jitterFrames, capacityFrames);
+    }
+    return nativeHandle != 0;
+  }
+
+  /** Stops pacing and drops what is still buffered. */
+  public synchronized void stop() {
+    if (nativeHandle != 0) {
+      nativeStop(nativeHandle);
+      nativeHandle = 0;
+    }
+  }
+
+  /**
+   * The native injector, 0 when stopped. The Flutter plugin hands it to Dart,
+   * which fills the ring in place through {@code dart:ffi}; Dart and Java must
+   * not write to the same injector.
+   */
+  public synchronized long getNativeHandle() { return nativeHandle; }
+
+  /**
+   * Queues interleaved PCM16, in any amount. Returns the bytes accepted, fewer
+   * than {@code length} when the ring is full.
+   */
+  public synchronized int write(@NonNull byte[] data, int offset, int length) {
+    if (nativeHandle == 0) {
+      return 0;
+    }
+    return nativeWrite(nativeHandle, data, offset, length);
+  }
+
+  /**
+   * Queues the remaining bytes of a direct buffer without a Java-side copy and
+   * advances its position by the bytes accepted.
+   */
+  public synchronized int write(@NonNull ByteBuffer data) {
+    if (nativeHandle == 0 || !data.isDirect()) {
+      return 0;
+    }
+    int accepted = nativeWriteDirect(nativeHandle, data, data.position(),
+                                     data.remaining());
+    data.position(data.position() + accepted);
+    return accepted;
+  }
+
+  /** Counters indexed by the {@code STATS_*} constants, or null if stopped. */
+  public synchronized long[] getStats() {
+    if (nativeHandle == 0) {
+      return null;
+    }
+    return nativeGetStats(nativeHandle);
+  }
+
+  private native long nativeStart(long engineHandle, int sampleRate,
+                                  int channels, int trackId, int jitterFrames,
+                                  int capacityFrames);
+
+  private native void nativeStop(long nativeHandle);
+
+  private native int nativeWrite(long nativeHandle, byte[] data, int offset,
+                                 int length);
+
+  private native int nativeWriteDirect(long nativeHandle, ByteBuffer data,
+                                       int offset, int length);
+
+  private native long[] nativeGetStats(long nativeHandle);
+}
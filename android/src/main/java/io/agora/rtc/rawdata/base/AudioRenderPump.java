@@ -0,0 +1,148 @@
+package io.agora.rtc.rawdata.base;
+
+import androidx.annotation.Nullable;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Pulls the mixed playback through {@code IMediaEngine::pullAudioFrame} for a
+ * custom audio sink. A native thread pulls {@code periodMs} of PCM16 every
+ * {@code periodMs} into a ring of {@code depthFrames}; {@link #acquire()} gives
+ * the offset of the oldest frame in {@link #getBuffer()}, which is read in
+ * place until {@link #release()}. Start before joining the channel. Acquire
+ * and release from one thread at a time; {@link #stop()} waits for a frame
+ * acquired on another thread to be released before it frees the ring.
+ */
+public class AudioRenderPump {
+  /** Indices of the array returned by {@link #getStats()}. */
+  public static final int STATS_FRAMES_PULLED = 0;
+  public static final int STATS_PULL_ERRORS = 1;
+  public static final int STATS_OVERRUNS = 2;
+  public static final int STATS_UNDERRUNS = 3;
+  public static final int STATS_LATE_TICKS = 4;
+  public static final int STATS_BUFFERED_FRAMES = 5;
+  public static final int STATS_DEPTH_FRAMES = 6;
+
+  private final long engineHandle;
+  private final int sampleRate, channels, periodMs, depthFrames;
+  private long nativeHandle;
+  private ByteBuffer buffer;
+  private int frameBytes;
+  // A frame is between acquire() and release(), the ring must stay alive.
+  private boolean acquired;
+
+  public AudioRenderPump(long engineHandle, int sampleRate, int channels,
+                         int periodMs, int depthFrames) {
+    this.engineHandle = engineHandle;
+    this.sampleRate = sampleRate;
+    this.channels = channels;
+    this.periodMs = periodMs;
+    this.depthFrames = depthFrames;
+  }
+
+  /**
+   * Enables the external audio sink and starts pulling. Returns false if the
+   * engine refuses the format.
+   */
+  public synchronized boolean start() {
+    if (nativeHandle == 0) {
+      nativeHandle = nativeStart(engineHandle, sampleRate, channels, periodMs,
+                                 depthFrames);
+      if (nativeHandle != 0) {
+        buffer = nativeGetBuffer(nativeHandle);
+        frameBytes = nativeGetFrameBytes(nativeHandle);
+      }
+    }
+    return nativeHandle != 0;
+  }
+
+  /**
+   * Frees the ring once the frame of an outstanding {@link #acquire()} is
+   * released. Never call it between acquire and release on the reading
+   * thread.
+   */
+  public synchronized void stop() {
+    boolean interrupted = false;
+    while (acquired) {
+      try {
+        wait();
+      } catch (InterruptedException e) {
+        interrupted = true;
+      }
+    }
+    if (interrupted) {
+      Thread.currentThread().interrupt();
+    }
+    if (nativeHandle != 0) {
+      nativeStop(nativeHandle);
+      nativeHandle = 0;
+      buffer = null;
+    }
+  }
+
+  /**
+   * The ring storage, wrapped once. Only the range returned by
+   * {@link #acquire()} may be read, and only until {@link #release()}. The
+   * memory is freed by {@link #stop()}, never use the buffer after it.
+   */
+  @Nullable
+  public synchronized ByteBuffer getBuffer() {
+    return buffer;
+  }
+
+  public synchronized int getFrameBytes() { return frameBytes; }
+
+  /**
+   * The native pump, 0 when stopped. The Flutter plugin hands it to Dart,
+   * which reads the ring in place through {@code dart:ffi}; Dart and Java must
+   * not both read from the same pump.
+   */
+  public synchronized long getNativeHandle() { return nativeHandle; }
+
+  /**
+   * Byte offset in {@link #getBuffer()} of the oldest pulled frame, or -1 if
+   * none is ready, which counts as an underrun.
+   */
+  public synchronized int acquire() {
+    if (nativeHandle == 0) {
+      return -1;
+    }
+    int offset = nativeAcquire(nativeHandle);
+    if (offset >= 0) {
+      acquired = true;
+    }
+    return offset;
+  }
+
+  /** Hands the frame of the last {@link #acquire()} back to the pump. */
+  public synchronized void release() {
+    if (nativeHandle != 0 && acquired) {
+      nativeRelease(nativeHandle);
+      acquired = false;
+      notifyAll();
+    }
+  }
+
+  /** Counters indexed by the {@code STATS_*} constants, or null if stopped. */
+  public synchronized long[] getStats() {
+    if (nativeHandle == 0) {
+      return null;
+    }
+    return nativeGetStats(nativeHandle);
+  }
+
+  private native long nativeStart(long engineHandle, int sampleRate,
+                                  int channels, int periodMs, int depthFrames);
+
+  private native void nativeStop(long nativeHandle);
+
+  private native ByteBuffer nativeGetBuffer(long nativeHandle);
+
+  private native int nativeGetFrameBytes(long nativeHandle);
+
+  private native int nativeAcquire(long nativeHandle);
+
+  private native void nativeRelease(long nativeHandle);
+
+  private native long[] nativeGetStats(long nativeHandle);
+}
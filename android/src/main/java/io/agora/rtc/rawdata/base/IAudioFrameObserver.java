@@ -1,9 +1,107 @@
 package io.agora.rtc.rawdata.base;
 
 import androidx.annotation.NonNull;
+import androidx.annotation.Nullable;
 
+/**
+ * The {@link AudioFrame} passed to each callback, and its buffers, are reused
+ * for the next frame of the same position. Do not keep them after returning.
+ */
 public abstract class IAudioFrameObserver {
+  /** PCM is copied into a {@code byte[]} and copied back after the call. */
+  public static final int BUFFER_TYPE_BYTE_ARRAY = 0;
+  /** PCM is exposed in place through {@link AudioFrame#getByteBuffer()}. */
+  public static final int BUFFER_TYPE_DIRECT_BYTE_BUFFER = 1;
+  /**
+   * PCM is converted natively to float32 in [-1, 1), one plane per channel,
+   * and exposed read-only through {@link AudioFrame#getFloatBuffer()}. Frame
+   * batches stay PCM16 in a direct ByteBuffer.
+   */
+  public static final int BUFFER_TYPE_FLOAT_PLANAR = 2;
+
+  /** Bits of {@code AUDIO_FRAME_POSITION}, see setObservedAudioFramePosition. */
+  public static final int POSITION_PLAYBACK = 1 << 0;
+  public static final int POSITION_RECORD = 1 << 1;
+  public static final int POSITION_MIXED = 1 << 2;
+  public static final int POSITION_BEFORE_MIXING = 1 << 3;
+  public static final int POSITION_EAR_MONITORING = 1 << 4;
+  public static final int POSITION_DEFAULT = POSITION_PLAYBACK |
+                                             POSITION_RECORD | POSITION_MIXED |
+                                             POSITION_BEFORE_MIXING;
+  private static final int POSITION_COUNT = 5;
+
+  /** Values of {@code RAW_AUDIO_FRAME_OP_MODE_TYPE}. */
+  public static final int MODE_READ_ONLY = 0;
+  public static final int MODE_READ_WRITE = 2;
+
+  /** Callbacks run on the SDK audio thread and may edit the frame. */
+  public static final int DELIVERY_MODE_SYNC = 0;
+  /**
+   * The SDK thread only copies each frame into a lock-free ring, callbacks run
+   * later on a dedicated thread. Read-only, return values are ignored.
+   */
+  public static final int DELIVERY_MODE_ASYNC = 1;
+  /**
+   * Consecutive frames of each position are collected natively and passed to
+   * {@link #onAudioFrameBatch(AudioFrameBatch)} in one call, on the SDK audio
+   * thread. The per-frame callbacks are not called. Read-only.
+   */
+  public static final int DELIVERY_MODE_BATCH = 2;
+  /**
+   * Frames never reach Java, only native processors and the level meter, see
+   * {@link #setAudioLevelMetering(int, int)}.
+   */
+  public static final int DELIVERY_MODE_NONE = 3;
+
+  /** Indices of the array returned by {@link #getDeliveryStats(int)}. */
+  public static final int STATS_DELIVERED = 0;
+  public static final int STATS_OVERFLOW = 1;
+  public static final int STATS_DROPPED = 2;
+  public static final int STATS_HIGH_WATER_MARK = 3;
+  public static final int STATS_CAPACITY = 4;
+
+  /**
+   * Metrics of {@link #getCallbackTiming(int, int)}: the interval between SDK
+   * callbacks, the time spent in the whole native callback, and within it the
+   * JNI marshalling and the Java handler. With {@link #DELIVERY_MODE_ASYNC}
+   * the last two are measured on the delivery thread. No interval is recorded
+   * for {@link #POSITION_BEFORE_MIXING}, it is called back once per uid.
+   */
+  public static final int TIMING_INTERVAL = 0;
+  public static final int TIMING_CALLBACK = 1;
+  public static final int TIMING_JNI = 2;
+  public static final int TIMING_HANDLER = 3;
+
+  /**
+   * Indices of the array returned by {@link #getCallbackTiming(int, int)}, in
+   * microseconds. {@code TIMING_BUCKETS} starts pairs of bucket lower bound
+   * and count, for the non-empty buckets.
+   */
+  public static final int TIMING_COUNT = 0;
+  public static final int TIMING_SUM_US = 1;
+  public static final int TIMING_MIN_US = 2;
+  public static final int TIMING_MAX_US = 3;
+  public static final int TIMING_P50_US = 4;
+  public static final int TIMING_P90_US = 5;
+  public static final int TIMING_P99_US = 6;
+  public static final int TIMING_BUCKETS = 7;
+
+  /** File formats of {@link #startAudioRecording}. */
+  public static final int RECORDING_FORMAT_WAV = 0;
+  public static final int RECORDING_FORMAT_RAW = 1;
+
   private long engineHandle, nativeHandle;
+  private int deliveryMode = DELIVERY_MODE_SYNC, deliveryFrames;
+  private int observedPosition = POSITION_DEFAULT;
+  // Four ints per position: sample rate, channels, mode, samples per call.
+  // All zero lets the SDK choose.
+  private final int[] audioParams = new int[POSITION_COUNT * 4];
+  private int[] allowUids;
+  private int[] denyUids = new int[0];
+  private int beforeMixingSampleRate;
+  private int meteredPosition, meteringIntervalMs;
+  private int vadPosition;
+  private boolean vadGating;
 
   public IAudioFrameObserver(long engineHandle) {
     this.engineHandle = engineHandle;
@@ -18,6 +116,35 @@ public abstract class IAudioFrameObserver {
   public abstract boolean
   onPlaybackAudioFrameBeforeMixing(int uid, @NonNull AudioFrame audioFrame);
 
+  /**
+   * The in-ear monitoring mix, only called when
+   * {@link #POSITION_EAR_MONITORING} is observed. Its format is negotiated
+   * with {@link #setAudioParams} like the other positions.
+   */
+  public boolean onEarMonitoringAudioFrame(@NonNull AudioFrame audioFrame) {
+    return true;
+  }
+
+  /**
+   * Levels of one position since the previous call, one entry per uid for
+   * {@link #POSITION_BEFORE_MIXING} and a single uid 0 entry otherwise. Peak
+   * and RMS are linear in [0, 1], dBFS is the RMS level. Called on the SDK
+   * audio thread.
+   */
+  public void onAudioLevels(int position, @NonNull int[] uids,
+                            @NonNull float[] peak, @NonNull float[] rms,
+                            @NonNull float[] dbfs) {}
+
+  /**
+   * Speech start ({@code speaking} true) or end of one uid, see
+   * {@link #setVoiceActivityDetection(int, boolean)}. The uid is 0 except for
+   * {@link #POSITION_BEFORE_MIXING}. Called on the SDK audio thread.
+   */
+  public void onVoiceActivity(int position, int uid, boolean speaking) {}
+
+  /** Called instead of the per-frame callbacks in DELIVERY_MODE_BATCH. */
+  public void onAudioFrameBatch(@NonNull AudioFrameBatch batch) {}
+
   public boolean isMultipleChannelFrameWanted() { return false; }
 
   public boolean
@@ -27,8 +154,44 @@ public abstract class IAudioFrameObserver {
   }
 
   public void registerAudioFrameObserver() {
+    registerAudioFrameObserver(BUFFER_TYPE_BYTE_ARRAY);
+  }
+
+  public void registerAudioFrameObserver(int bufferType) {
+    registerAudioFrameObserver(bufferType, observedPosition);
+  }
+
+  public void registerAudioFrameObserver(int bufferType, int observedPosition) {
+    this.observedPosition = observedPosition;
     if (nativeHandle == 0) {
-      nativeHandle = nativeRegisterAudioFrameObserver(engineHandle);
+      nativeHandle = nativeRegisterAudioFrameObserver(
+          engineHandle, bufferType, observedPosition, audioParams,
+          deliveryMode, deliveryFrames);
+      if (allowUids != null || denyUids.length > 0) {
+        nativeSetBeforeMixingUidFilter(nativeHandle, allowUids, denyUids);
+      }
+      if (beforeMixingSampleRate != 0) {
+        nativeSetBeforeMixingSampleRate(nativeHandle, beforeMixingSampleRate);
+      }
+      if (meteredPosition != 0) {
+        nativeSetAudioLevelMetering(nativeHandle, meteredPosition,
+                                    meteringIntervalMs);
+      }
+      if (vadPosition != 0) {
+        nativeSetVoiceActivityDetection(nativeHandle, vadPosition, vadGating);
+      }
+    }
+  }
+
+  /**
+   * Changes which positions are delivered. Positions that are not set cost
+   * nothing, neither in the SDK nor in JNI. Before registration the value is
+   * kept and used by {@link #registerAudioFrameObserver(int)}.
+   */
+  public void setObservedAudioFramePosition(int observedPosition) {
+    this.observedPosition = observedPosition;
+    if (nativeHandle != 0) {
+      nativeSetObservedAudioFramePosition(nativeHandle, observedPosition);
     }
   }
 
@@ -39,7 +202,216 @@ public abstract class IAudioFrameObserver {
     }
   }
 
-  private native long nativeRegisterAudioFrameObserver(long engineHandle);
+  /**
+   * Sets the format the SDK delivers at one of {@link #POSITION_PLAYBACK},
+   * {@link #POSITION_RECORD}, {@link #POSITION_MIXED} or
+   * {@link #POSITION_EAR_MONITORING}. Can be called before or after
+   * registration, zeros let the SDK choose.
+   */
+  public void setAudioParams(int position, int sampleRate, int channels,
+                             int mode, int samplesPerCall) {
+    int index = Integer.numberOfTrailingZeros(position);
+    if (Integer.bitCount(position) != 1 || index >= POSITION_COUNT) {
+      throw new IllegalArgumentException("Invalid position: " + position);
+    }
+    audioParams[index * 4] = sampleRate;
+    audioParams[index * 4 + 1] = channels;
+    audioParams[index * 4 + 2] = mode;
+    audioParams[index * 4 + 3] = samplesPerCall;
+    if (nativeHandle != 0) {
+      nativeSetAudioParams(nativeHandle, position, sampleRate, channels, mode,
+                           samplesPerCall);
+    }
+  }
+
+  /**
+   * Limits {@link #onPlaybackAudioFrameBeforeMixing(int, AudioFrame)} to the
+   * uids in {@code allow}, or to every uid when it is null, minus the uids in
+   * {@code deny}. Other uids are skipped natively, before any copy or JNI
+   * call. Can be called before or after registration.
+   */
+  public void setBeforeMixingUidFilter(@Nullable int[] allow,
+                                       @NonNull int[] deny) {
+    allowUids = allow != null ? allow.clone() : null;
+    denyUids = deny.clone();
+    if (nativeHandle != 0) {
+      nativeSetBeforeMixingUidFilter(nativeHandle, allowUids, denyUids);
+    }
+  }
+
+  /**
+   * Resamples the frames passed to
+   * {@link #onPlaybackAudioFrameBeforeMixing(int, AudioFrame)} to
+   * {@code sampleRate} natively, with one filter state per uid, since the SDK
+   * delivers every remote stream at its own rate. Resampled frames are
+   * read-only. 0 turns resampling off. Can be called before or after
+   * registration.
+   */
+  public void setBeforeMixingSampleRate(int sampleRate) {
+    beforeMixingSampleRate = sampleRate;
+    if (nativeHandle != 0) {
+      nativeSetBeforeMixingSampleRate(nativeHandle, sampleRate);
+    }
+  }
+
+  /**
+   * Meters the {@code positions} bits natively and reports them through
+   * {@link #onAudioLevels} every {@code intervalMs}. Together with
+   * {@link #DELIVERY_MODE_NONE} no PCM crosses into Java at all. 0 positions
+   * turns metering off. Can be called before or after registration.
+   */
+  public void setAudioLevelMetering(int positions, int intervalMs) {
+    meteredPosition = positions;
+    meteringIntervalMs = intervalMs;
+    if (nativeHandle != 0) {
+      nativeSetAudioLevelMetering(nativeHandle, positions, intervalMs);
+    }
+  }
+
+  /**
+   * Runs native voice activity detection at the {@code positions} bits,
+   * meant for {@link #POSITION_RECORD} and {@link #POSITION_BEFORE_MIXING},
+   * and reports changes through {@link #onVoiceActivity}. With
+   * {@code gating}, only frames of speaking uids reach the frame callbacks. 0
+   * positions turns detection off. Can be called before or after registration.
+   */
+  public void setVoiceActivityDetection(int positions, boolean gating) {
+    vadPosition = positions;
+    vadGating = gating;
+    if (nativeHandle != 0) {
+      nativeSetVoiceActivityDetection(nativeHandle, positions, gating);
+    }
+  }
+
+  /**
+   * Selects how frames reach the callbacks, takes effect on the next
+   * registration. For {@link #DELIVERY_MODE_ASYNC}, {@code deliveryFrames} is
+   * the ring capacity per position, for {@link #DELIVERY_MODE_BATCH} the frames
+   * per batch. 0 picks a default.
+   */
+  public void setDeliveryMode(int deliveryMode, int deliveryFrames) {
+    this.deliveryMode = deliveryMode;
+    this.deliveryFrames = deliveryFrames;
+  }
+
+  /**
+   * Records one position to {@code <pathPrefix>_<n>.wav} or {@code .pcm} on a
+   * native writer thread, the audio thread never touches the filesystem.
+   * {@code uid} limits {@link #POSITION_BEFORE_MIXING} to one uid, -1 records
+   * all. Files rotate after {@code maxFileBytes} of PCM or
+   * {@code maxFileDurationMs}, 0 for no limit. Returns an id for
+   * {@link #stopAudioRecording(int)}, or -1 on failure. Requires registration.
+   */
+  public int startAudioRecording(int position, long uid,
+                                 @NonNull String pathPrefix, int format,
+                                 long maxFileBytes, int maxFileDurationMs) {
+    if (nativeHandle == 0) {
+      return -1;
+    }
+    return nativeStartAudioRecording(nativeHandle, position, uid, pathPrefix,
+                                     format, maxFileBytes, maxFileDurationMs);
+  }
+
+  /** Writes what is buffered and closes the file. */
+  public void stopAudioRecording(int id) {
+    if (nativeHandle != 0) {
+      nativeStopAudioRecording(nativeHandle, id);
+    }
+  }
+
+  /**
+   * Bytes written, bytes dropped and files created by a recording, or null if
+   * it is not running.
+   */
+  public long[] getAudioRecordingStats(int id) {
+    if (nativeHandle == 0) {
+      return null;
+    }
+    return nativeGetAudioRecordingStats(nativeHandle, id);
+  }
+
+  /**
+   * A histogram of one position and {@code TIMING_INTERVAL} to
+   * {@code TIMING_HANDLER} metric, indexed by the {@code TIMING_COUNT} to
+   * {@code TIMING_BUCKETS} constants. Recorded without locks on the audio
+   * threads, for finding slow handlers in production.
+   */
+  public long[] getCallbackTiming(int position, int metric) {
+    if (nativeHandle == 0) {
+      return null;
+    }
+    return nativeGetCallbackTiming(nativeHandle, position, metric);
+  }
+
+  /** Clears every callback timing histogram. */
+  public void resetCallbackTiming() {
+    if (nativeHandle != 0) {
+      nativeResetCallbackTiming(nativeHandle);
+    }
+  }
+
+  /**
+   * Ring counters of one position, indexed by the {@code STATS_*} constants.
+   * Returns null unless registered with {@link #DELIVERY_MODE_ASYNC}.
+   */
+  public long[] getDeliveryStats(int position) {
+    if (nativeHandle == 0) {
+      return null;
+    }
+    return nativeGetDeliveryStats(nativeHandle, position);
+  }
+
+  /**
+   * The native {@code agora::AudioFrameObserver*} while registered, or 0. Lets
+   * native code attach {@code IAudioProcessor} stages to this observer.
+   */
+  public long getNativeHandle() { return nativeHandle; }
+
+  private native long nativeRegisterAudioFrameObserver(long engineHandle,
+                                                       int bufferType,
+                                                       int observedPosition,
+                                                       int[] audioParams,
+                                                       int deliveryMode,
+                                                       int deliveryFrames);
+
+  private native void nativeSetAudioParams(long nativeHandle, int position,
+                                           int sampleRate, int channels,
+                                           int mode, int samplesPerCall);
+
+  private native void nativeSetObservedAudioFramePosition(long nativeHandle,
+                                                          int observedPosition);
+
+  private native void nativeSetBeforeMixingUidFilter(long nativeHandle,
+                                                     int[] allow, int[] deny);
+
+  private native void nativeSetBeforeMixingSampleRate(long nativeHandle,
+                                                      int sampleRate);
+
+  private native void nativeSetAudioLevelMetering(long nativeHandle,
+                                                  int positions,
+                                                  int intervalMs);
+
+  private native void nativeSetVoiceActivityDetection(long nativeHandle,
+                                                      int positions,
+                                                      boolean gating);
+
+  private native int nativeStartAudioRecording(long nativeHandle, int position,
+                                               long uid, String pathPrefix,
+                                               int format, long maxFileBytes,
+                                               int maxFileDurationMs);
+
+  private native void nativeStopAudioRecording(long nativeHandle, int id);
+
+  private native long[] nativeGetAudioRecordingStats(long nativeHandle,
+                                                     int id);
+
+  private native long[] nativeGetDeliveryStats(long nativeHandle,
+                                               int position);
+
+  private native long[] nativeGetCallbackTiming(long nativeHandle,
+                                                int position, int metric);
+
+  private native void nativeResetCallbackTiming(long nativeHandle);
 
   private native void nativeUnregisterAudioFrameObserver(long nativeHandle);
 }
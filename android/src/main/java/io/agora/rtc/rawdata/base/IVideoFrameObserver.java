@@ -2,12 +2,69 @@ package io.agora.rtc.rawdata.base;
 
 import androidx.annotation.NonNull;
 
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * The {@link VideoFrame} passed to each callback, and its buffers, are reused
+ * for the next frame of the same position and remote uid. Do not keep them
+ * after returning.
+ */
 public abstract class IVideoFrameObserver {
-  static int POSITION_POST_CAPTURER = 1 << 0;
-  static int POSITION_PRE_RENDERER = 1 << 1;
-  static int POSITION_PRE_ENCODER = 1 << 2;
+  /** Bits of {@code VIDEO_MODULE_POSITION}, see setObservedFramePosition. */
+  public static final int POSITION_POST_CAPTURER = 1 << 0;
+  public static final int POSITION_PRE_RENDERER = 1 << 1;
+  public static final int POSITION_PRE_ENCODER = 1 << 2;
+
+  /** Planes are copied into {@code byte[]}s and copied back after the call. */
+  public static final int BUFFER_TYPE_BYTE_ARRAY = 0;
+  /** Planes are exposed in place through {@code VideoFrame.get*ByteBuffer()}. */
+  public static final int BUFFER_TYPE_DIRECT_BYTE_BUFFER = 1;
+  /**
+   * Planes are copied into one pooled native block exposed through
+   * {@code VideoFrame.getContiguousBuffer()} and copied back after the call.
+   */
+  public static final int BUFFER_TYPE_CONTIGUOUS = 2;
+
+  /**
+   * Copied planes keep the SDK stride, row padding included, and are copied
+   * back in one go.
+   */
+  public static final int PLANE_MODE_STRIDED = 0;
+  /**
+   * Copied planes are packed to their visible width, the stride of the frame
+   * is the row size in bytes. Padding is never copied. Ignored with
+   * {@link #BUFFER_TYPE_DIRECT_BYTE_BUFFER}.
+   */
+  public static final int PLANE_MODE_PACKED = 1;
+
+  /**
+   * A built-in native stage by name and parameters, see
+   * {@code cpp/android/VideoProcessor.h} for the names.
+   */
+  public static class VideoProcessorConfig {
+    public final String name;
+    public final Map<String, Double> params;
+
+    public VideoProcessorConfig(@NonNull String name,
+                                @NonNull Map<String, Double> params) {
+      this.name = name;
+      this.params = params;
+    }
+  }
 
   private long engineHandle, nativeHandle;
+  private VideoFrame.VideoFrameType formatPreference =
+      VideoFrame.VideoFrameType.YUV420;
+  private boolean rotationApplied, mirrorApplied;
+  private int observedFramePosition =
+      POSITION_POST_CAPTURER | POSITION_PRE_RENDERER;
+  // Keyed by position.
+  private final Map<Integer, List<VideoProcessorConfig>> videoProcessors =
+      new HashMap<>();
+  private int nativeOnlyPositions;
 
   public IVideoFrameObserver(long engineHandle) {
     this.engineHandle = engineHandle;
@@ -22,18 +79,43 @@ public abstract class IVideoFrameObserver {
   public abstract boolean onRenderVideoFrame(int uid,
                                              @NonNull VideoFrame videoFrame);
 
+  /**
+   * The SDK never calls the preference getters through JNI, the native
+   * observer answers from values passed at registration and by the setters
+   * below. Overrides are therefore only read at those times.
+   */
   public VideoFrame.VideoFrameType getVideoFormatPreference() {
-    return VideoFrame.VideoFrameType.YUV420;
+    return formatPreference;
   }
 
-  public boolean getRotationApplied() { return false; }
+  public boolean getRotationApplied() { return rotationApplied; }
 
-  public boolean getMirrorApplied() { return false; }
+  public boolean getMirrorApplied() { return mirrorApplied; }
 
   public boolean getSmoothRenderingEnabled() { return false; }
 
-  public int getObservedFramePosition() {
-    return POSITION_POST_CAPTURER | POSITION_PRE_RENDERER;
+  public int getObservedFramePosition() { return observedFramePosition; }
+
+  public void setVideoFormatPreference(
+      @NonNull VideoFrame.VideoFrameType formatPreference) {
+    this.formatPreference = formatPreference;
+    applyPreferences();
+  }
+
+  public void setRotationApplied(boolean rotationApplied) {
+    this.rotationApplied = rotationApplied;
+    applyPreferences();
+  }
+
+  public void setMirrorApplied(boolean mirrorApplied) {
+    this.mirrorApplied = mirrorApplied;
+    applyPreferences();
+  }
+
+  /** Positions that are not set are never delivered. */
+  public void setObservedFramePosition(int observedFramePosition) {
+    this.observedFramePosition = observedFramePosition;
+    applyPreferences();
   }
 
   public boolean isMultipleChannelFrameWanted() { return false; }
@@ -44,11 +126,59 @@ public abstract class IVideoFrameObserver {
   }
 
   public void registerVideoFrameObserver() {
+    registerVideoFrameObserver(BUFFER_TYPE_BYTE_ARRAY);
+  }
+
+  public void registerVideoFrameObserver(int bufferType) {
+    registerVideoFrameObserver(bufferType, PLANE_MODE_STRIDED);
+  }
+
+  public void registerVideoFrameObserver(int bufferType, int planeMode) {
     if (nativeHandle == 0) {
-      nativeHandle = nativeRegisterVideoFrameObserver(engineHandle);
+      nativeHandle = nativeRegisterVideoFrameObserver(
+          engineHandle, bufferType, planeMode,
+          getVideoFormatPreference().getValue(),
+          getRotationApplied(), getMirrorApplied(), getObservedFramePosition());
+      for (Map.Entry<Integer, List<VideoProcessorConfig>> entry :
+           videoProcessors.entrySet()) {
+        applyVideoProcessors(entry.getKey(), entry.getValue());
+      }
+      if (nativeOnlyPositions != 0) {
+        nativeSetNativeOnlyPositions(nativeHandle, nativeOnlyPositions);
+      }
+    }
+  }
+
+  /**
+   * Replaces the native stages run on the SDK planes of one position, before
+   * the frame reaches Java. Unknown names are skipped.
+   */
+  public void setVideoProcessors(int position,
+                                 @NonNull List<VideoProcessorConfig> configs) {
+    List<VideoProcessorConfig> copy = new ArrayList<>(configs);
+    videoProcessors.put(position, copy);
+    if (nativeHandle != 0) {
+      applyVideoProcessors(position, copy);
     }
   }
 
+  /**
+   * Positions whose frames only go through the native stages and never reach
+   * the Java callbacks, so they cost no JNI at all.
+   */
+  public void setNativeOnlyPositions(int positions) {
+    nativeOnlyPositions = positions;
+    if (nativeHandle != 0) {
+      nativeSetNativeOnlyPositions(nativeHandle, positions);
+    }
+  }
+
+  /**
+   * The native {@code agora::VideoFrameObserver*} while registered, or 0. Lets
+   * native code attach {@code IVideoProcessor} stages to this observer.
+   */
+  public long getNativeHandle() { return nativeHandle; }
+
   public void unregisterVideoFrameObserver() {
     if (nativeHandle != 0) {
       nativeUnregisterVideoFrameObserver(nativeHandle);
@@ -56,7 +186,52 @@ public abstract class IVideoFrameObserver {
     }
   }
 
-  private native long nativeRegisterVideoFrameObserver(long engineHandle);
+  private void applyVideoProcessors(int position,
+                                    List<VideoProcessorConfig> configs) {
+    nativeClearVideoProcessors(nativeHandle, position);
+    for (VideoProcessorConfig config : configs) {
+      String[] keys = new String[config.params.size()];
+      double[] values = new double[keys.length];
+      int i = 0;
+      for (Map.Entry<String, Double> param : config.params.entrySet()) {
+        keys[i] = param.getKey();
+        values[i] = param.getValue();
+        ++i;
+      }
+      nativeAddVideoProcessor(nativeHandle, position, config.name, keys,
+                              values);
+    }
+  }
+
+  private void applyPreferences() {
+    if (nativeHandle != 0) {
+      nativeSetPreferences(nativeHandle, getVideoFormatPreference().getValue(),
+                           getRotationApplied(), getMirrorApplied(),
+                           getObservedFramePosition());
+    }
+  }
+
+  private native long nativeRegisterVideoFrameObserver(
+      long engineHandle, int bufferType, int planeMode, int formatPreference,
+      boolean rotationApplied, boolean mirrorApplied,
+      int observedFramePosition);
+
+  private native void nativeClearVideoProcessors(long nativeHandle,
+                                                 int position);
+
+  private native boolean nativeAddVideoProcessor(long nativeHandle,
+                                                 int position, String name,
+                                                 String[] keys,
+                                                 double[] values);
+
+  private native void nativeSetNativeOnlyPositions(long nativeHandle,
+                                                   int positions);
+
+  private native void nativeSetPreferences(long nativeHandle,
+                                           int formatPreference,
+                                           boolean rotationApplied,
+                                           boolean mirrorApplied,
+                                           int observedFramePosition);
 
   private native void nativeUnregisterVideoFrameObserver(long nativeHandle);
 }
@@ -1,16 +1,38 @@
 package io.agora.rtc.rawdata.base;
 
+import java.nio.ByteBuffer;
+
 public class VideoFrame {
+  /**
+   * The CPU-accessible {@code VIDEO_PIXEL_FORMAT}s. NV12 and NV21 carry the
+   * interleaved chroma in the u plane and have no v plane, BGRA and RGBA only
+   * have the y plane, and I010 stores each sample in two little-endian bytes.
+   */
   public enum VideoFrameType {
     YUV420(1),
+    BGRA(2),
+    NV21(3),
+    RGBA(4),
+    NV12(8),
     YUV422(16),
-    RGBA(4);
+    I010(18);
 
     private final int value;
 
     VideoFrameType(int value) { this.value = value; }
 
     public int getValue() { return value; }
+
+    /** The constant of a {@code VIDEO_PIXEL_FORMAT} value. */
+    public static VideoFrameType fromValue(int value) {
+      for (VideoFrameType type : values()) {
+        if (type.value == value) {
+          return type;
+        }
+      }
+      throw new IllegalArgumentException("Unsupported VIDEO_PIXEL_FORMAT " +
+                                         value);
+    }
   }
 
   private VideoFrameType type;
@@ -22,6 +44,13 @@ public class VideoFrame {
   private byte[] yBuffer;
   private byte[] uBuffer;
   private byte[] vBuffer;
+  private ByteBuffer yByteBuffer;
+  private ByteBuffer uByteBuffer;
+  private ByteBuffer vByteBuffer;
+  // BUFFER_TYPE_CONTIGUOUS only, -1 offsets for absent planes.
+  private ByteBuffer contiguousBuffer;
+  private int yOffset, uOffset, vOffset;
+  private int yLength, uLength, vLength;
   private int rotation;
   private long renderTimeMs;
   private int avsync_type;
@@ -29,24 +58,7 @@ public class VideoFrame {
   public VideoFrame(int type, int width, int height, int yStride, int uStride,
                     int vStride, byte[] yBuffer, byte[] uBuffer, byte[] vBuffer,
                     int rotation, long renderTimeMs, int avsync_type) {
-    // Only support VIDEO_PIXEL_I420/VIDEO_PIXEL_RGBA/VIDEO_PIXEL_I422 for
-    // demostration purpose. If you need more format, please check the value of
-    // type of `VIDEO_PIXEL_FORMAT`(locate in header
-    // cpp/android/include/AgoraMediaBase.h)
-    switch (type) {
-    case 1: // VIDEO_PIXEL_I420
-      this.type = VideoFrameType.YUV420;
-      break;
-    case 4: // VIDEO_PIXEL_RGBA
-      this.type = VideoFrameType.RGBA;
-      break;
-    case 16: // VIDEO_PIXEL_I422
-      this.type = VideoFrameType.YUV422;
-      break;
-    default:
-      throw new IllegalArgumentException(
-          "Only VIDEO_PIXEL_I420/VIDEO_PIXEL_I422/VIDEO_PIXEL_RGBA supported for demostration purpose.");
-    }
+    this.type = VideoFrameType.fromValue(type);
 
     this.width = width;
     this.height = height;
@@ -61,9 +73,33 @@ public class VideoFrame {
     this.avsync_type = avsync_type;
   }
 
+  /**
+   * Wraps the SDK planes without copying, used with
+   * {@link IVideoFrameObserver#BUFFER_TYPE_DIRECT_BYTE_BUFFER}. The buffers
+   * are only valid during the callback, writes go straight to the SDK. A
+   * factory rather than a constructor overload, so that passing {@code null}
+   * planes to the constructor stays unambiguous.
+   */
+  public static VideoFrame fromByteBuffers(int type, int width, int height,
+                                           int yStride, int uStride,
+                                           int vStride, ByteBuffer yByteBuffer,
+                                           ByteBuffer uByteBuffer,
+                                           ByteBuffer vByteBuffer, int rotation,
+                                           long renderTimeMs, int avsync_type) {
+    VideoFrame frame =
+        new VideoFrame(type, width, height, yStride, uStride, vStride, null,
+                       null, null, rotation, renderTimeMs, avsync_type);
+    frame.yByteBuffer = yByteBuffer;
+    frame.uByteBuffer = uByteBuffer;
+    frame.vByteBuffer = vByteBuffer;
+    return frame;
+  }
+
   public VideoFrameType getType() { return type; }
 
-  public void setType(int type) { this.type = VideoFrameType.values()[type]; }
+  public void setType(int type) {
+    this.type = VideoFrameType.fromValue(type);
+  }
 
   public int getWidth() { return width; }
 
@@ -97,6 +133,33 @@ public class VideoFrame {
 
   public void setvBuffer(byte[] vBuffer) { this.vBuffer = vBuffer; }
 
+  public ByteBuffer getyByteBuffer() { return yByteBuffer; }
+
+  public ByteBuffer getuByteBuffer() { return uByteBuffer; }
+
+  public ByteBuffer getvByteBuffer() { return vByteBuffer; }
+
+  /**
+   * All planes in one 64-byte-aligned native block, used with
+   * {@link IVideoFrameObserver#BUFFER_TYPE_CONTIGUOUS}. Plane y spans
+   * {@code [getyOffset(), getyOffset() + getyLength())} with rows
+   * {@code getyStride()} apart, and likewise for u and v. Edits are copied
+   * back after the callback, the buffer is reused for later frames.
+   */
+  public ByteBuffer getContiguousBuffer() { return contiguousBuffer; }
+
+  public int getyOffset() { return yOffset; }
+
+  public int getuOffset() { return uOffset; }
+
+  public int getvOffset() { return vOffset; }
+
+  public int getyLength() { return yLength; }
+
+  public int getuLength() { return uLength; }
+
+  public int getvLength() { return vLength; }
+
   public int getRotation() { return rotation; }
 
   public void setRotation(int rotation) { this.rotation = rotation; }
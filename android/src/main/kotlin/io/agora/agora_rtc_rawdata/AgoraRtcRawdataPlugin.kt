@@ -1,7 +1,12 @@
 package io.agora.agora_rtc_rawdata
 
+import android.os.Handler
+import android.os.Looper
 import androidx.annotation.NonNull
+import io.agora.rtc.rawdata.base.AttachThreadStats
 import io.agora.rtc.rawdata.base.AudioFrame
+import io.agora.rtc.rawdata.base.AudioInjector
+import io.agora.rtc.rawdata.base.AudioRenderPump
 import io.agora.rtc.rawdata.base.IAudioFrameObserver
 import io.agora.rtc.rawdata.base.IVideoFrameObserver
 import io.agora.rtc.rawdata.base.VideoFrame
@@ -10,6 +15,7 @@ import io.flutter.plugin.common.MethodCall
 import io.flutter.plugin.common.MethodChannel
 import io.flutter.plugin.common.MethodChannel.MethodCallHandler
 import io.flutter.plugin.common.MethodChannel.Result
+import java.nio.ByteBuffer
 import java.util.*
 
 /** AgoraRtcRawdataPlugin */
@@ -20,8 +26,12 @@ class AgoraRtcRawdataPlugin : FlutterPlugin, MethodCallHandler {
   /// when the Flutter Engine is detached from the Activity
   private lateinit var channel: MethodChannel
 
+  private val mainHandler = Handler(Looper.getMainLooper())
+
   private var audioObserver: IAudioFrameObserver? = null
   private var videoObserver: IVideoFrameObserver? = null
+  private var audioInjector: AudioInjector? = null
+  private var audioRenderPump: AudioRenderPump? = null
 
   override fun onAttachedToEngine(@NonNull flutterPluginBinding: FlutterPlugin.FlutterPluginBinding) {
     channel = MethodChannel(flutterPluginBinding.binaryMessenger, "agora_rtc_rawdata")
@@ -31,8 +41,16 @@ class AgoraRtcRawdataPlugin : FlutterPlugin, MethodCallHandler {
   override fun onMethodCall(@NonNull call: MethodCall, @NonNull result: Result) {
     when (call.method) {
       "registerAudioFrameObserver" -> {
+        val engineHandle = call.argument<Number>("engineHandle")!!.toLong()
+        val bufferType = call.argument<Number>("bufferType")?.toInt()
+          ?: IAudioFrameObserver.BUFFER_TYPE_BYTE_ARRAY
+        val observedPosition = call.argument<Number>("observedPosition")?.toInt()
+          ?: IAudioFrameObserver.POSITION_DEFAULT
+        val deliveryMode = call.argument<Number>("deliveryMode")?.toInt()
+          ?: IAudioFrameObserver.DELIVERY_MODE_SYNC
+        val deliveryFrames = call.argument<Number>("deliveryFrames")?.toInt() ?: 0
         if (audioObserver == null) {
-          audioObserver = object : IAudioFrameObserver((call.arguments as Number).toLong()) {
+          audioObserver = object : IAudioFrameObserver(engineHandle) {
             override fun onRecordAudioFrame(audioFrame: AudioFrame): Boolean {
               return true
             }
@@ -48,11 +66,131 @@ class AgoraRtcRawdataPlugin : FlutterPlugin, MethodCallHandler {
             override fun onPlaybackAudioFrameBeforeMixing(uid: Int, audioFrame: AudioFrame): Boolean {
               return true
             }
+
+            override fun onEarMonitoringAudioFrame(audioFrame: AudioFrame): Boolean {
+              return true
+            }
+
+            override fun onAudioLevels(position: Int, uids: IntArray, peak: FloatArray,
+                                       rms: FloatArray, dbfs: FloatArray) {
+              // Method channels must be used on the platform thread.
+              val levels = mapOf(
+                "position" to position,
+                "uids" to uids,
+                "peak" to peak.map { it.toDouble() },
+                "rms" to rms.map { it.toDouble() },
+                "dbfs" to dbfs.map { it.toDouble() }
+              )
+              mainHandler.post { channel.invokeMethod("onAudioLevels", levels) }
+            }
+
+            override fun onVoiceActivity(position: Int, uid: Int, speaking: Boolean) {
+              val activity = mapOf("position" to position, "uid" to uid, "speaking" to speaking)
+              mainHandler.post { channel.invokeMethod("onVoiceActivity", activity) }
+            }
           }
         }
-        audioObserver?.registerAudioFrameObserver()
+        call.argument<Map<*, *>>("audioParams")?.forEach { (position, params) ->
+          setAudioParams(audioObserver, (position as Number).toInt(), params as Map<*, *>)
+        }
+        audioObserver?.setDeliveryMode(deliveryMode, deliveryFrames)
+        audioObserver?.registerAudioFrameObserver(bufferType, observedPosition)
+        result.success(null)
+      }
+      "setObservedAudioFramePosition" -> {
+        audioObserver?.setObservedAudioFramePosition((call.arguments as Number).toInt())
+        result.success(null)
+      }
+      "setAudioParams" -> {
+        setAudioParams(audioObserver, call.argument<Number>("position")!!.toInt(),
+          call.argument<Map<*, *>>("params")!!)
+        result.success(null)
+      }
+      "setAudioLevelMetering" -> {
+        audioObserver?.setAudioLevelMetering(
+          call.argument<Number>("positions")!!.toInt(),
+          call.argument<Number>("intervalMs")!!.toInt()
+        )
+        result.success(null)
+      }
+      "startAudioRecording" -> {
+        result.success(audioObserver?.startAudioRecording(
+          call.argument<Number>("position")!!.toInt(),
+          call.argument<Number>("uid")?.toLong() ?: -1L,
+          call.argument<String>("pathPrefix")!!,
+          call.argument<Number>("format")?.toInt() ?: IAudioFrameObserver.RECORDING_FORMAT_WAV,
+          call.argument<Number>("maxFileBytes")?.toLong() ?: 0L,
+          call.argument<Number>("maxFileDurationMs")?.toInt() ?: 0
+        ) ?: -1)
+      }
+      "stopAudioRecording" -> {
+        audioObserver?.stopAudioRecording((call.arguments as Number).toInt())
         result.success(null)
       }
+      "getAudioRecordingStats" -> {
+        val stats = audioObserver?.getAudioRecordingStats((call.arguments as Number).toInt())
+        result.success(stats?.let {
+          mapOf("bytesWritten" to it[0], "bytesDropped" to it[1], "files" to it[2])
+        })
+      }
+      "setVoiceActivityDetection" -> {
+        audioObserver?.setVoiceActivityDetection(
+          call.argument<Number>("positions")!!.toInt(),
+          call.argument<Boolean>("gating") ?: false
+        )
+        result.success(null)
+      }
+      "setBeforeMixingUidFilter" -> {
+        val allow = call.argument<List<Number>>("allow")?.map { it.toInt() }?.toIntArray()
+        val deny = call.argument<List<Number>>("deny")?.map { it.toInt() }?.toIntArray()
+          ?: IntArray(0)
+        audioObserver?.setBeforeMixingUidFilter(allow, deny)
+        result.success(null)
+      }
+      "setBeforeMixingSampleRate" -> {
+        audioObserver?.setBeforeMixingSampleRate((call.arguments as Number).toInt())
+        result.success(null)
+      }
+      "getAudioCallbackTiming" -> {
+        val timing = HashMap<Int, Map<String, Map<String, Any>>>()
+        audioObserver?.let { observer ->
+          for (index in 0 until 5) {
+            val position = 1 shl index
+            val metrics = HashMap<String, Map<String, Any>>()
+            timingMetrics.forEach { (name, metric) ->
+              observer.getCallbackTiming(position, metric)?.let {
+                metrics[name] = timingHistogram(it)
+              }
+            }
+            if ((metrics["callback"]?.get("count") as Long? ?: 0L) > 0L) {
+              timing[position] = metrics
+            }
+          }
+        }
+        result.success(timing)
+      }
+      "resetAudioCallbackTiming" -> {
+        audioObserver?.resetCallbackTiming()
+        result.success(null)
+      }
+      "getAudioDeliveryStats" -> {
+        val stats = HashMap<Int, Map<String, Long>>()
+        audioObserver?.let { observer ->
+          for (index in 0 until 5) {
+            val position = 1 shl index
+            observer.getDeliveryStats(position)?.let {
+              stats[position] = mapOf(
+                "delivered" to it[IAudioFrameObserver.STATS_DELIVERED],
+                "overflow" to it[IAudioFrameObserver.STATS_OVERFLOW],
+                "dropped" to it[IAudioFrameObserver.STATS_DROPPED],
+                "highWaterMark" to it[IAudioFrameObserver.STATS_HIGH_WATER_MARK],
+                "capacity" to it[IAudioFrameObserver.STATS_CAPACITY]
+              )
+            }
+          }
+        }
+        result.success(stats)
+      }
       "unregisterAudioFrameObserver" -> {
         audioObserver?.let {
           it.unregisterAudioFrameObserver()
@@ -60,24 +198,116 @@ class AgoraRtcRawdataPlugin : FlutterPlugin, MethodCallHandler {
         }
         result.success(null)
       }
+      "startAudioInjection" -> {
+        audioInjector?.stop()
+        val injector = AudioInjector(
+          call.argument<Number>("engineHandle")!!.toLong(),
+          call.argument<Number>("sampleRate")!!.toInt(),
+          call.argument<Number>("channels")!!.toInt(),
+          call.argument<Number>("trackId")?.toInt() ?: 0,
+          call.argument<Number>("jitterFrames")?.toInt() ?: 0,
+          call.argument<Number>("capacityFrames")?.toInt() ?: 0
+        )
+        audioInjector = if (injector.start()) injector else null
+        // Dart writes PCM into the native ring through FFI with this handle.
+        result.success(audioInjector?.nativeHandle ?: 0L)
+      }
+      "getAudioInjectionStats" -> {
+        val stats = audioInjector?.getStats()
+        result.success(stats?.let {
+          mapOf(
+            "framesPushed" to it[AudioInjector.STATS_FRAMES_PUSHED],
+            "silentFrames" to it[AudioInjector.STATS_SILENT_FRAMES],
+            "underruns" to it[AudioInjector.STATS_UNDERRUNS],
+            "bytesRefused" to it[AudioInjector.STATS_BYTES_REFUSED],
+            "lateTicks" to it[AudioInjector.STATS_LATE_TICKS],
+            "pushErrors" to it[AudioInjector.STATS_PUSH_ERRORS],
+            "bufferedFrames" to it[AudioInjector.STATS_BUFFERED_FRAMES],
+            "capacityFrames" to it[AudioInjector.STATS_CAPACITY_FRAMES]
+          )
+        })
+      }
+      "stopAudioInjection" -> {
+        audioInjector?.stop()
+        audioInjector = null
+        result.success(null)
+      }
+      "startAudioRendering" -> {
+        audioRenderPump?.stop()
+        val pump = AudioRenderPump(
+          call.argument<Number>("engineHandle")!!.toLong(),
+          call.argument<Number>("sampleRate")!!.toInt(),
+          call.argument<Number>("channels")!!.toInt(),
+          call.argument<Number>("periodMs")?.toInt() ?: 0,
+          call.argument<Number>("depthFrames")?.toInt() ?: 0
+        )
+        audioRenderPump = if (pump.start()) pump else null
+        // Dart reads the pulled frames in place through FFI with this handle.
+        result.success(audioRenderPump?.nativeHandle ?: 0L)
+      }
+      "getAudioRenderStats" -> {
+        val stats = audioRenderPump?.getStats()
+        result.success(stats?.let {
+          mapOf(
+            "framesPulled" to it[AudioRenderPump.STATS_FRAMES_PULLED],
+            "pullErrors" to it[AudioRenderPump.STATS_PULL_ERRORS],
+            "overruns" to it[AudioRenderPump.STATS_OVERRUNS],
+            "underruns" to it[AudioRenderPump.STATS_UNDERRUNS],
+            "lateTicks" to it[AudioRenderPump.STATS_LATE_TICKS],
+            "bufferedFrames" to it[AudioRenderPump.STATS_BUFFERED_FRAMES],
+            "depthFrames" to it[AudioRenderPump.STATS_DEPTH_FRAMES]
+          )
+        })
+      }
+      "stopAudioRendering" -> {
+        audioRenderPump?.stop()
+        audioRenderPump = null
+        result.success(null)
+      }
       "registerVideoFrameObserver" -> {
+        val engineHandle = call.argument<Number>("engineHandle")!!.toLong()
+        val bufferType = call.argument<Number>("bufferType")?.toInt()
+          ?: IVideoFrameObserver.BUFFER_TYPE_BYTE_ARRAY
+        val planeMode = call.argument<Number>("planeMode")?.toInt()
+          ?: IVideoFrameObserver.PLANE_MODE_STRIDED
         if (videoObserver == null) {
-          videoObserver = object : IVideoFrameObserver((call.arguments as Number).toLong()) {
+          videoObserver = object : IVideoFrameObserver(engineHandle) {
             override fun onCaptureVideoFrame(sourceType: Int, videoFrame: VideoFrame): Boolean {
-              Arrays.fill(videoFrame.getuBuffer(), 0)
-              Arrays.fill(videoFrame.getvBuffer(), 0)
+              fill(videoFrame.getuBuffer(), videoFrame.getuByteBuffer(), 0)
+              fill(videoFrame.getvBuffer(), videoFrame.getvByteBuffer(), 0)
+              fillChroma(videoFrame, 0)
               return true
             }
 
             override fun onRenderVideoFrame(uid: Int, videoFrame: VideoFrame): Boolean {
               // unsigned char value 255
-              Arrays.fill(videoFrame.getuBuffer(), -1)
-              Arrays.fill(videoFrame.getvBuffer(), -1)
+              fill(videoFrame.getuBuffer(), videoFrame.getuByteBuffer(), -1)
+              fill(videoFrame.getvBuffer(), videoFrame.getvByteBuffer(), -1)
+              fillChroma(videoFrame, -1)
               return true
             }
           }
         }
-        videoObserver?.registerVideoFrameObserver()
+        setVideoPreferences(videoObserver, call)
+        videoObserver?.registerVideoFrameObserver(bufferType, planeMode)
+        result.success(null)
+      }
+      "setVideoFramePreferences" -> {
+        setVideoPreferences(videoObserver, call)
+        result.success(null)
+      }
+      "setVideoProcessors" -> {
+        val processors = call.argument<List<Map<*, *>>>("processors")!!.map {
+          val params = (it["params"] as? Map<*, *>)?.entries?.associate { param ->
+            param.key as String to (param.value as Number).toDouble()
+          } ?: emptyMap()
+          IVideoFrameObserver.VideoProcessorConfig(it["name"] as String, params)
+        }
+        videoObserver?.setVideoProcessors(call.argument<Number>("position")!!.toInt(), processors)
+        result.success(null)
+      }
+      "setVideoNativeOnlyPositions" -> {
+        videoObserver?.setNativeOnlyPositions((call.arguments as Number).toInt())
         result.success(null)
       }
       "unregisterVideoFrameObserver" -> {
@@ -87,12 +317,90 @@ class AgoraRtcRawdataPlugin : FlutterPlugin, MethodCallHandler {
         }
         result.success(null)
       }
+      "getThreadAttachStats" -> {
+        result.success(mapOf(
+          "attachCount" to AttachThreadStats.getAttachCount(),
+          "detachCount" to AttachThreadStats.getDetachCount()
+        ))
+      }
       else -> result.notImplemented()
     }
   }
 
+  private fun setAudioParams(observer: IAudioFrameObserver?, position: Int, params: Map<*, *>) {
+    observer?.setAudioParams(
+      position,
+      (params["sampleRate"] as Number).toInt(),
+      (params["channels"] as Number).toInt(),
+      (params["mode"] as Number).toInt(),
+      (params["samplesPerCall"] as Number).toInt()
+    )
+  }
+
+  // Absent arguments leave the preference as it is.
+  private fun setVideoPreferences(observer: IVideoFrameObserver?, call: MethodCall) {
+    observer ?: return
+    call.argument<Number>("formatPreference")?.let {
+      observer.setVideoFormatPreference(VideoFrame.VideoFrameType.fromValue(it.toInt()))
+    }
+    call.argument<Boolean>("rotationApplied")?.let { observer.setRotationApplied(it) }
+    call.argument<Boolean>("mirrorApplied")?.let { observer.setMirrorApplied(it) }
+    call.argument<Number>("observedPosition")?.let {
+      observer.setObservedFramePosition(it.toInt())
+    }
+  }
+
+  private val timingMetrics = mapOf(
+    "interval" to IAudioFrameObserver.TIMING_INTERVAL,
+    "callback" to IAudioFrameObserver.TIMING_CALLBACK,
+    "jni" to IAudioFrameObserver.TIMING_JNI,
+    "handler" to IAudioFrameObserver.TIMING_HANDLER
+  )
+
+  private fun timingHistogram(values: LongArray): Map<String, Any> {
+    val buckets = HashMap<Long, Long>()
+    for (i in IAudioFrameObserver.TIMING_BUCKETS until values.size step 2) {
+      buckets[values[i]] = values[i + 1]
+    }
+    return mapOf(
+      "count" to values[IAudioFrameObserver.TIMING_COUNT],
+      "sumUs" to values[IAudioFrameObserver.TIMING_SUM_US],
+      "minUs" to values[IAudioFrameObserver.TIMING_MIN_US],
+      "maxUs" to values[IAudioFrameObserver.TIMING_MAX_US],
+      "p50Us" to values[IAudioFrameObserver.TIMING_P50_US],
+      "p90Us" to values[IAudioFrameObserver.TIMING_P90_US],
+      "p99Us" to values[IAudioFrameObserver.TIMING_P99_US],
+      "buckets" to buckets
+    )
+  }
+
+  /// Fills whichever of the two plane representations the observer was registered with.
+  private fun fill(array: ByteArray?, buffer: ByteBuffer?, value: Byte) {
+    array?.let { Arrays.fill(it, value) }
+    buffer?.let {
+      for (i in 0 until it.capacity()) {
+        it.put(i, value)
+      }
+    }
+  }
+
+  // The U and V planes of a BUFFER_TYPE_CONTIGUOUS frame.
+  private fun fillChroma(videoFrame: VideoFrame, value: Byte) {
+    val buffer = videoFrame.contiguousBuffer ?: return
+    for ((offset, length) in listOf(videoFrame.getuOffset() to videoFrame.getuLength(),
+                                    videoFrame.getvOffset() to videoFrame.getvLength())) {
+      for (i in offset until offset + length) {
+        buffer.put(i, value)
+      }
+    }
+  }
+
   override fun onDetachedFromEngine(@NonNull binding: FlutterPlugin.FlutterPluginBinding) {
     channel.setMethodCallHandler(null)
+    audioInjector?.stop()
+    audioInjector = null
+    audioRenderPump?.stop()
+    audioRenderPump = null
   }
 
   companion object {
@@ -0,0 +1,83 @@
+#include "AlignedBufferPool.h"
+
+#include <stdlib.h>
+
+namespace agora {
+namespace {
+const int LOG2_MIN_BLOCK = 12;
+static_assert(1 << LOG2_MIN_BLOCK == AlignedBufferPool::MIN_BLOCK,
+              "LOG2_MIN_BLOCK");
+} // namespace
+
+AlignedBufferPool::AlignedBufferPool(int capacity) : capacity(capacity) {
+  freeBlocks.reserve(capacity);
+}
+
+AlignedBufferPool::~AlignedBufferPool() {
+  for (auto &entry : freeBlocks) {
+    free(entry.block.data);
+  }
+}
+
+int AlignedBufferPool::SizeClass(int size) {
+  if (size <= MIN_BLOCK) {
+    return 0;
+  }
+  // 2^shift <= size - 1 < 2^(shift + 1), the two bits below the top one pick
+  // the quarter.
+  int shift = 31 - __builtin_clz(static_cast<unsigned>(size - 1));
+  int quarter = ((size - 1) >> (shift - 2)) & 3;
+  return (shift - LOG2_MIN_BLOCK) * 4 + quarter + 1;
+}
+
+int AlignedBufferPool::ClassCapacity(int sizeClass) {
+  if (sizeClass <= 0) {
+    return MIN_BLOCK;
+  }
+  int shift = (sizeClass - 1) / 4 + LOG2_MIN_BLOCK;
+  int quarter = (sizeClass - 1) % 4;
+  return (4 + quarter + 1) << (shift - 2);
+}
+
+AlignedBufferPool::Block AlignedBufferPool::Acquire(int size) {
+  const int capacityOfClass = ClassCapacity(SizeClass(size));
+  for (size_t i = 0; i < freeBlocks.size(); ++i) {
+    if (freeBlocks[i].block.capacity == capacityOfClass) {
+      Block block = freeBlocks[i].block;
+      freeBlocks[i] = freeBlocks.back();
+      freeBlocks.pop_back();
+      return block;
+    }
+  }
+  void *data = nullptr;
+  if (posix_memalign(&data, ALIGNMENT, capacityOfClass) != 0) {
+    return Block{nullptr, 0};
+  }
+  ++allocationCount;
+  return Block{static_cast<unsigned char *>(data), capacityOfClass};
+}
+
+void AlignedBufferPool::Recycle(const Block &block) {
+  if (!block.data) {
+    return;
+  }
+  Entry entry = {block, ++useCounter};
+  if (static_cast<int>(freeBlocks.size()) < capacity) {
+    freeBlocks.push_back(entry);
+    return;
+  }
+  if (freeBlocks.empty()) {
+    free(block.data);
+    return;
+  }
+  // Evict the least recently used block.
+  Entry *victim = &freeBlocks[0];
+  for (auto &e : freeBlocks) {
+    if (e.lastUse < victim->lastUse) {
+      victim = &e;
+    }
+  }
+  free(victim->block.data);
+  *victim = entry;
+}
+} // namespace agora
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+namespace agora {
+// Recycles 64-byte-aligned native blocks across frames. Requests are rounded
+// up to a size class, four per doubling above MIN_BLOCK, so frames whose size
+// wobbles slightly share a block and at most a quarter of a block is slack.
+// Blocks beyond `capacity` free the least recently used one. Not thread safe,
+// use one pool per callback thread.
+class AlignedBufferPool {
+public:
+  enum { ALIGNMENT = 64, MIN_BLOCK = 4096 };
+
+  struct Block {
+    unsigned char *data;
+    // Bytes usable at data, at least the requested size.
+    int capacity;
+  };
+
+public:
+  explicit AlignedBufferPool(int capacity = 4);
+  ~AlignedBufferPool();
+
+  // A block of at least `size` bytes, taken from the free blocks of its size
+  // class or newly allocated. `data` is null if the allocation failed.
+  Block Acquire(int size);
+
+  // Hands a block from Acquire() back for reuse.
+  void Recycle(const Block &block);
+
+  // Blocks allocated so far, steady once the frame sizes are.
+  long long allocations() const { return allocationCount; }
+
+  static int SizeClass(int size);
+  static int ClassCapacity(int sizeClass);
+
+  // `offset` rounded up to the next ALIGNMENT boundary.
+  static int Align(int offset) {
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+private:
+  struct Entry {
+    Block block;
+    unsigned long long lastUse;
+  };
+
+private:
+  const int capacity;
+  unsigned long long useCounter = 0;
+  long long allocationCount = 0;
+  std::vector<Entry> freeBlocks;
+};
+} // namespace agora
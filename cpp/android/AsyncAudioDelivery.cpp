@@ -0,0 +1,104 @@
+#include "AsyncAudioDelivery.h"
+
+#include <cstring>
+
+namespace agora {
+AsyncAudioDelivery::Ring::Ring(int capacity, int frameBytes)
+    : ring(capacity), slots(ring.capacity()) {
+  for (auto &slot : slots) {
+    slot.pcm.resize(frameBytes);
+    slot.frame.buffer = slot.pcm.data();
+  }
+}
+
+AsyncAudioDelivery::AsyncAudioDelivery(int ringCount, int capacity,
+                                       const int *frameBytes,
+                                       Consumer consumer)
+    : consumer(std::move(consumer)) {
+  for (int i = 0; i < ringCount; ++i) {
+    int bytes = frameBytes && frameBytes[i] > 0 ? frameBytes[i]
+                                                : DEFAULT_FRAME_BYTES;
+    rings.emplace_back(new Ring(capacity, bytes));
+  }
+  sem_init(&pending, 0, 0);
+  thread = std::thread(&AsyncAudioDelivery::Run, this);
+}
+
+AsyncAudioDelivery::~AsyncAudioDelivery() {
+  running.store(false);
+  sem_post(&pending);
+  thread.join();
+  sem_destroy(&pending);
+}
+
+bool AsyncAudioDelivery::Push(int ring, rtc::uid_t uid,
+                              const AudioFrame &frame) {
+  Ring &r = *rings[ring];
+  int length =
+      frame.samplesPerChannel * frame.channels * frame.bytesPerSample;
+  if (!frame.buffer || length <= 0) {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  unsigned index;
+  if (!r.ring.BeginWrite(index)) {
+    r.overflow.fetch_add(1, std::memory_order_relaxed);
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  Slot &slot = r.slots[index];
+  if (static_cast<size_t>(length) > slot.pcm.size()) {
+    // A frame larger than expected, e.g. after setAudioParams. The slot keeps
+    // the larger size, so this happens once per slot.
+    slot.pcm.resize(length);
+  }
+  slot.frame = frame;
+  slot.frame.buffer = slot.pcm.data();
+  slot.uid = uid;
+  memcpy(slot.pcm.data(), frame.buffer, length);
+  int size = static_cast<int>(r.ring.EndWrite());
+
+  // Only this thread writes the mark, readers just need a consistent value.
+  if (size > r.highWaterMark.load(std::memory_order_relaxed)) {
+    r.highWaterMark.store(size, std::memory_order_relaxed);
+  }
+  // sem_post is async-signal-safe and does not take a lock.
+  sem_post(&pending);
+  return true;
+}
+
+AsyncAudioDelivery::Stats AsyncAudioDelivery::GetStats(int ring) const {
+  const Ring &r = *rings[ring];
+  Stats stats;
+  stats.delivered = r.delivered.load(std::memory_order_relaxed);
+  stats.overflow = r.overflow.load(std::memory_order_relaxed);
+  stats.dropped = r.dropped.load(std::memory_order_relaxed);
+  stats.highWaterMark = r.highWaterMark.load(std::memory_order_relaxed);
+  stats.capacity = static_cast<int>(r.ring.capacity());
+  return stats;
+}
+
+void AsyncAudioDelivery::Run() {
+  while (true) {
+    while (sem_wait(&pending) != 0) {
+      // EINTR, wait again.
+    }
+    if (!running.load()) {
+      break;
+    }
+    // One post per frame, but drain everything that is ready and let the
+    // surplus posts fall through as empty passes.
+    for (unsigned i = 0; i < rings.size(); ++i) {
+      Ring &r = *rings[i];
+      unsigned index;
+      while (r.ring.BeginRead(index)) {
+        Slot &slot = r.slots[index];
+        consumer(static_cast<int>(i), slot.uid, slot.frame);
+        r.ring.EndRead();
+        r.delivered.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+} // namespace agora
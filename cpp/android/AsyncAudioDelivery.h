@@ -0,0 +1,86 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include "SpscRing.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <semaphore.h>
+#include <thread>
+#include <vector>
+
+namespace agora {
+// Moves read-only audio frames off the SDK callback threads. Every ring is a
+// preallocated single-producer/single-consumer queue of frame slots: Push()
+// copies the PCM and never blocks, a consumer thread drains all rings and
+// hands each frame to `consumer`. Slots are sized up front from the expected
+// frame size and only grow, on the producer thread, for a larger frame.
+class AsyncAudioDelivery {
+public:
+  typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+  typedef std::function<void(int ring, rtc::uid_t uid, AudioFrame &frame)>
+      Consumer;
+
+  // Slot size when the frame size is not known, 20 ms of 48 kHz stereo.
+  enum { DEFAULT_FRAME_BYTES = 3840 };
+
+  struct Stats {
+    long long delivered;
+    // Frames that found their ring full.
+    long long overflow;
+    // Every frame that was not delivered, overflow included.
+    long long dropped;
+    int highWaterMark;
+    int capacity;
+  };
+
+public:
+  // `frameBytes` holds the expected frame size of each ring, or is null; a
+  // size of 0 or less picks DEFAULT_FRAME_BYTES.
+  AsyncAudioDelivery(int ringCount, int capacity, const int *frameBytes,
+                     Consumer consumer);
+  ~AsyncAudioDelivery();
+
+  // Must only be called from the one producer thread of `ring`. Returns false
+  // if the frame was dropped.
+  bool Push(int ring, rtc::uid_t uid, const AudioFrame &frame);
+
+  Stats GetStats(int ring) const;
+
+  // Slots per ring, `capacity` rounded up to a power of two.
+  int capacity() const {
+    return static_cast<int>(rings.front()->ring.capacity());
+  }
+
+private:
+  struct Slot {
+    AudioFrame frame;
+    rtc::uid_t uid = 0;
+    // Only touched by whoever owns the slot in the ring, so the producer may
+    // grow it while the consumer reads other slots.
+    std::vector<unsigned char> pcm;
+  };
+
+  struct Ring {
+    Ring(int capacity, int frameBytes);
+
+    SpscRing ring;
+    std::vector<Slot> slots;
+    std::atomic<long long> delivered{0};
+    std::atomic<long long> overflow{0};
+    std::atomic<long long> dropped{0};
+    std::atomic<int> highWaterMark{0};
+  };
+
+  void Run();
+
+private:
+  std::vector<std::unique_ptr<Ring>> rings;
+  Consumer consumer;
+  sem_t pending;
+  std::atomic<bool> running{true};
+  std::thread thread;
+};
+} // namespace agora
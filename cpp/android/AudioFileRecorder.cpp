@@ -0,0 +1,244 @@
+#include "AudioFileRecorder.h"
+
+#include "VMUtil.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace agora {
+namespace {
+const int WAV_HEADER_BYTES = 44;
+
+void PutLe(unsigned char *out, unsigned value, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    out[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+bool WriteAll(int fd, const unsigned char *data, long long length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+} // namespace
+
+AudioFileRecorder::AudioFileRecorder(const Config &config) : config(config) {
+  buffers[0].resize(config.bufferBytes);
+  buffers[1].resize(config.bufferBytes);
+  sem_init(&wakeup, 0, 0);
+}
+
+AudioFileRecorder::~AudioFileRecorder() {
+  Stop();
+  sem_destroy(&wakeup);
+}
+
+bool AudioFileRecorder::Start() {
+  if (running.load() || !OpenFile()) {
+    return false;
+  }
+  exiting.store(false);
+  writer = std::thread(&AudioFileRecorder::Run, this);
+  running.store(true);
+  return true;
+}
+
+void AudioFileRecorder::Stop() {
+  if (!running.exchange(false)) {
+    return;
+  }
+  // process() sets `busy` before checking `running`, so once `busy` is clear
+  // the SDK thread can no longer touch the buffers.
+  while (busy.load()) {
+    std::this_thread::yield();
+  }
+  exiting.store(true);
+  sem_post(&wakeup);
+  writer.join();
+
+  if (fill > 0) {
+    Write(buffers[active].data(), fill);
+    fill = 0;
+  }
+  CloseFile();
+}
+
+AudioFileRecorder::Stats AudioFileRecorder::GetStats() const {
+  Stats stats;
+  stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+  stats.bytesDropped = bytesDropped.load(std::memory_order_relaxed);
+  stats.files = files.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool AudioFileRecorder::process(
+    media::IAudioFrameObserverBase::AudioFrame &audioFrame, rtc::uid_t uid) {
+  if (config.filterUid && uid != config.uid) {
+    return true;
+  }
+  busy.store(true);
+  if (running.load()) {
+    Append(audioFrame);
+  }
+  busy.store(false);
+  return true;
+}
+
+void AudioFileRecorder::Append(
+    const media::IAudioFrameObserverBase::AudioFrame &audioFrame) {
+  int length = audioFrame.samplesPerChannel * audioFrame.channels *
+               audioFrame.bytesPerSample;
+  if (!audioFrame.buffer || length <= 0) {
+    return;
+  }
+  if (sampleRate == 0) {
+    // Published to the writer by the release store in HandOff().
+    sampleRate = audioFrame.samplesPerSec;
+    channels = audioFrame.channels;
+    bytesPerSample = audioFrame.bytesPerSample;
+  }
+  if (audioFrame.samplesPerSec != sampleRate ||
+      audioFrame.channels != channels ||
+      audioFrame.bytesPerSample != bytesPerSample ||
+      length > config.bufferBytes) {
+    bytesDropped.fetch_add(length, std::memory_order_relaxed);
+    return;
+  }
+
+  if (fill + length > config.bufferBytes && !HandOff()) {
+    bytesDropped.fetch_add(length, std::memory_order_relaxed);
+    return;
+  }
+  memcpy(buffers[active].data() + fill, audioFrame.buffer, length);
+  fill += length;
+}
+
+bool AudioFileRecorder::HandOff() {
+  if (pending.load(std::memory_order_acquire)) {
+    // The writer is still busy with the other buffer.
+    return false;
+  }
+  pendingIndex = active;
+  pendingLength = fill;
+  pending.store(true, std::memory_order_release);
+  sem_post(&wakeup);
+  active ^= 1;
+  fill = 0;
+  return true;
+}
+
+void AudioFileRecorder::Run() {
+  while (true) {
+    while (sem_wait(&wakeup) != 0) {
+      // EINTR, wait again.
+    }
+    if (pending.load(std::memory_order_acquire)) {
+      Write(buffers[pendingIndex].data(), pendingLength);
+      pending.store(false, std::memory_order_release);
+    }
+    if (exiting.load()) {
+      break;
+    }
+  }
+}
+
+void AudioFileRecorder::Write(const unsigned char *data, long long length) {
+  long long limit = FileLimit();
+  while (length > 0) {
+    if (fd < 0 && !OpenFile()) {
+      bytesDropped.fetch_add(length, std::memory_order_relaxed);
+      return;
+    }
+    long long chunk = length;
+    if (limit > 0 && fileBytes + chunk > limit) {
+      chunk = limit - fileBytes;
+    }
+    if (!WriteAll(fd, data, chunk)) {
+      LOGE("AudioFileRecorder: write failed, errno %d", errno);
+      bytesDropped.fetch_add(length, std::memory_order_relaxed);
+      return;
+    }
+    fileBytes += chunk;
+    bytesWritten.fetch_add(chunk, std::memory_order_relaxed);
+    data += chunk;
+    length -= chunk;
+    if (limit > 0 && fileBytes >= limit) {
+      CloseFile();
+    }
+  }
+}
+
+bool AudioFileRecorder::OpenFile() {
+  std::string path = config.pathPrefix + "_" + std::to_string(fileIndex) +
+                     (config.format == FORMAT_WAV ? ".wav" : ".pcm");
+  fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOGE("AudioFileRecorder: cannot open %s, errno %d", path.c_str(), errno);
+    return false;
+  }
+  ++fileIndex;
+  fileBytes = 0;
+  files.fetch_add(1, std::memory_order_relaxed);
+  if (config.format == FORMAT_WAV) {
+    // Filled in by CloseFile() once the sizes are known.
+    unsigned char header[WAV_HEADER_BYTES] = {0};
+    WriteAll(fd, header, sizeof(header));
+  }
+  return true;
+}
+
+void AudioFileRecorder::CloseFile() {
+  if (fd < 0) {
+    return;
+  }
+  if (config.format == FORMAT_WAV) {
+    unsigned dataBytes = static_cast<unsigned>(fileBytes);
+    int blockAlign = channels * bytesPerSample;
+    unsigned char header[WAV_HEADER_BYTES];
+    memcpy(header, "RIFF", 4);
+    PutLe(header + 4, 36 + dataBytes, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    PutLe(header + 16, 16, 4);
+    PutLe(header + 20, 1, 2); // PCM
+    PutLe(header + 22, channels, 2);
+    PutLe(header + 24, sampleRate, 4);
+    PutLe(header + 28, sampleRate * blockAlign, 4);
+    PutLe(header + 32, blockAlign, 2);
+    PutLe(header + 34, bytesPerSample * 8, 2);
+    memcpy(header + 36, "data", 4);
+    PutLe(header + 40, dataBytes, 4);
+    pwrite(fd, header, sizeof(header), 0);
+  }
+  close(fd);
+  fd = -1;
+}
+
+long long AudioFileRecorder::FileLimit() const {
+  long long frameBytes = static_cast<long long>(channels) * bytesPerSample;
+  if (frameBytes <= 0) {
+    return 0;
+  }
+  long long limit = config.maxFileBytes;
+  if (config.maxFileDurationMs > 0) {
+    long long bytes = static_cast<long long>(sampleRate) * frameBytes *
+                      config.maxFileDurationMs / 1000;
+    if (limit <= 0 || bytes < limit) {
+      limit = bytes;
+    }
+  }
+  // Never split a sample frame across files.
+  limit -= limit % frameBytes;
+  return limit > 0 ? limit : 0;
+}
+} // namespace agora
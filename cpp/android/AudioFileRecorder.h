@@ -0,0 +1,103 @@
+#pragma once
+
+#include "AudioProcessor.h"
+
+#include <atomic>
+#include <semaphore.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace agora {
+// An IAudioProcessor that records the frames passing through it to disk. The
+// SDK thread only copies into one of two preallocated buffers; a writer thread
+// writes each full buffer with a single write(), so storage stalls never
+// reach the audio callback. A partly filled buffer is written on Stop(). When
+// both buffers are busy the frame is dropped and counted. Files are
+// `<pathPrefix>_<n>.wav` or `.pcm`, n from 0, and rotate by size or duration.
+// The format is fixed by the first frame, frames in another format are
+// dropped.
+class AudioFileRecorder : public IAudioProcessor {
+public:
+  // Must match IAudioFrameObserver.RECORDING_FORMAT_* on the Java side.
+  enum FORMAT {
+    FORMAT_WAV = 0,
+    FORMAT_RAW = 1,
+  };
+
+  struct Config {
+    std::string pathPrefix;
+    int format = FORMAT_WAV;
+    // Only record this uid, for the before-mixing position.
+    bool filterUid = false;
+    rtc::uid_t uid = 0;
+    // Rotation limits of the PCM data per file, 0 for none. The smaller wins.
+    long long maxFileBytes = 0;
+    int maxFileDurationMs = 0;
+    // Size of each of the two buffers.
+    int bufferBytes = 256 * 1024;
+  };
+
+  struct Stats {
+    long long bytesWritten;
+    long long bytesDropped;
+    int files;
+  };
+
+public:
+  explicit AudioFileRecorder(const Config &config);
+  ~AudioFileRecorder();
+
+  // Opens the first file and starts the writer thread.
+  bool Start();
+  // Writes what is buffered, finalizes the file and joins the writer. Safe to
+  // call while the SDK thread is inside process().
+  void Stop();
+
+  Stats GetStats() const;
+
+  bool process(media::IAudioFrameObserverBase::AudioFrame &audioFrame,
+               rtc::uid_t uid) override;
+
+private:
+  void Append(const media::IAudioFrameObserverBase::AudioFrame &audioFrame);
+  bool HandOff();
+
+  void Run();
+  void Write(const unsigned char *data, long long length);
+  bool OpenFile();
+  void CloseFile();
+  long long FileLimit() const;
+
+private:
+  const Config config;
+
+  // Producer side, only touched by the SDK thread while `busy`.
+  std::vector<unsigned char> buffers[2];
+  int active = 0;
+  int fill = 0;
+  int sampleRate = 0;
+  int channels = 0;
+  int bytesPerSample = 0;
+
+  // The buffer handed to the writer, owned by it while `pending` is set.
+  int pendingIndex = 0;
+  int pendingLength = 0;
+  std::atomic<bool> pending{false};
+
+  std::atomic<bool> running{false};
+  std::atomic<bool> busy{false};
+  std::atomic<bool> exiting{false};
+  sem_t wakeup;
+  std::thread writer;
+
+  // Writer side.
+  int fd = -1;
+  int fileIndex = 0;
+  long long fileBytes = 0;
+
+  std::atomic<long long> bytesWritten{0};
+  std::atomic<long long> bytesDropped{0};
+  std::atomic<int> files{0};
+};
+} // namespace agora
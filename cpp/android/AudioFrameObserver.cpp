@@ -1,11 +1,84 @@
 #include "AudioFrameObserver.h"
 
+#include "PcmKernels.h"
 #include "VMUtil.h"
 
+#include <cstring>
+
 namespace agora {
 AudioFrameObserver::AudioFrameObserver(JNIEnv *env, jobject jCaller,
-                                       long long engineHandle)
-    : jCallerRef(env->NewGlobalRef(jCaller)), engineHandle(engineHandle) {
+                                       long long engineHandle, int bufferType,
+                                       int observedPosition,
+                                       const AudioParams *audioParams,
+                                       int deliveryMode, int deliveryFrames)
+    : jCallerRef(jCaller ? env->NewGlobalRef(jCaller) : nullptr),
+      bufferType(bufferType), deliveryMode(deliveryMode),
+      observedPosition(observedPosition),
+      engineHandle(engineHandle) {
+  if (audioParams) {
+    for (int i = 0; i < POSITION_INDEX_COUNT; ++i) {
+      this->audioParams[i] = audioParams[i];
+    }
+  }
+
+  if (jCallerRef) {
+    InitJavaObserver(env);
+
+    if (deliveryMode == DELIVERY_MODE_ASYNC) {
+      int capacity = deliveryFrames > 0 ? deliveryFrames : 32;
+      // Slots sized for the negotiated frames, 0 where the SDK picks.
+      int frameBytes[POSITION_INDEX_COUNT];
+      for (int i = 0; i < POSITION_INDEX_COUNT; ++i) {
+        frameBytes[i] = this->audioParams[i].samples_per_call *
+                        this->audioParams[i].channels *
+                        rtc::TWO_BYTES_PER_SAMPLE;
+      }
+      asyncDelivery.reset(new AsyncAudioDelivery(
+          POSITION_INDEX_COUNT, capacity, frameBytes,
+          [this](int ring, rtc::uid_t uid, AudioFrame &frame) {
+            // The consumer thread stays attached until it exits.
+            AttachCurrentThreadOnce attach(jvm);
+            CallJavaObserver(attach.env(), static_cast<POSITION_INDEX>(ring),
+                             uid, frame, false);
+          }));
+      // Every ring slot has its own address, keep a direct buffer for each.
+      for (auto &slot : slots) {
+        slot.bufferPool.SetCapacity(asyncDelivery->capacity());
+      }
+    } else if (deliveryMode == DELIVERY_MODE_BATCH) {
+      // 100 ms with the SDK's default 10 ms callbacks.
+      batchFrames = deliveryFrames > 0 ? deliveryFrames : 10;
+      InitJavaBatches(env);
+    }
+  }
+
+  RegisterWithMediaEngine(this);
+}
+
+AudioFrameObserver::~AudioFrameObserver() {
+  RegisterWithMediaEngine(nullptr);
+  // Joins the consumer thread before the Java observer goes away.
+  asyncDelivery.reset();
+  for (auto &recording : recordings) {
+    recording.second.recorder->Stop();
+  }
+
+  if (jCallerRef) {
+    if (batchFrames > 0) {
+      AttachCurrentThreadOnce attach(jvm);
+      // Hand over the partial batches rather than dropping their tail.
+      for (int i = 0; i < POSITION_INDEX_COUNT; ++i) {
+        if (batches[i].count > 0) {
+          FlushBatch(attach.env(), static_cast<POSITION_INDEX>(i));
+        }
+      }
+      ReleaseJavaBatches(attach.env());
+    }
+    ReleaseJavaObserver();
+  }
+}
+
+void AudioFrameObserver::InitJavaObserver(JNIEnv *env) {
   jclass jCallerClass = env->GetObjectClass(jCallerRef);
   jOnRecordAudioFrame =
       env->GetMethodID(jCallerClass, "onRecordAudioFrame",
@@ -19,6 +92,13 @@ AudioFrameObserver::AudioFrameObserver(JNIEnv *env, jobject jCaller,
   jOnPlaybackAudioFrameBeforeMixing =
       env->GetMethodID(jCallerClass, "onPlaybackAudioFrameBeforeMixing",
                        "(ILio/agora/rtc/rawdata/base/AudioFrame;)Z");
+  jOnEarMonitoringAudioFrame =
+      env->GetMethodID(jCallerClass, "onEarMonitoringAudioFrame",
+                       "(Lio/agora/rtc/rawdata/base/AudioFrame;)Z");
+  jOnAudioLevels =
+      env->GetMethodID(jCallerClass, "onAudioLevels", "(I[I[F[F[F)V");
+  jOnVoiceActivity =
+      env->GetMethodID(jCallerClass, "onVoiceActivity", "(IIZ)V");
 
   env->DeleteLocalRef(jCallerClass);
 
@@ -26,147 +106,671 @@ AudioFrameObserver::AudioFrameObserver(JNIEnv *env, jobject jCaller,
   jAudioFrameClass = (jclass)env->NewGlobalRef(jAudioFrame);
   jAudioFrameInit =
       env->GetMethodID(jAudioFrameClass, "<init>", "(IIIII[BJI)V");
+  jAudioFrameType =
+      env->GetFieldID(jAudioFrameClass, "type",
+                      "Lio/agora/rtc/rawdata/base/AudioFrame$AudioFrameType;");
+  jAudioFrameSamples = env->GetFieldID(jAudioFrameClass, "samples", "I");
+  jAudioFrameBytesPerSample =
+      env->GetFieldID(jAudioFrameClass, "bytesPerSample", "I");
+  jAudioFrameChannels = env->GetFieldID(jAudioFrameClass, "channels", "I");
+  jAudioFrameSamplesPerSec =
+      env->GetFieldID(jAudioFrameClass, "samplesPerSec", "I");
+  jAudioFrameBuffer = env->GetFieldID(jAudioFrameClass, "buffer", "[B");
+  jAudioFrameByteBuffer =
+      env->GetFieldID(jAudioFrameClass, "byteBuffer", "Ljava/nio/ByteBuffer;");
+  jAudioFrameRenderTimeMs =
+      env->GetFieldID(jAudioFrameClass, "renderTimeMs", "J");
+  jAudioFrameAvsyncType = env->GetFieldID(jAudioFrameClass, "avsync_type", "I");
   env->DeleteLocalRef(jAudioFrame);
 
+  // FRAME_TYPE_PCM16 is the only AUDIO_FRAME_TYPE, FLOAT32_PLANAR only exists
+  // on the Java side for BUFFER_TYPE_FLOAT_PLANAR.
+  jclass jAudioFrameTypeClass =
+      env->FindClass("io/agora/rtc/rawdata/base/AudioFrame$AudioFrameType");
+  jfieldID jPcm16 = env->GetStaticFieldID(
+      jAudioFrameTypeClass, "PCM16",
+      "Lio/agora/rtc/rawdata/base/AudioFrame$AudioFrameType;");
+  jobject jAudioFrameTypeObj =
+      env->GetStaticObjectField(jAudioFrameTypeClass, jPcm16);
+  jAudioFrameTypePcm16 = env->NewGlobalRef(jAudioFrameTypeObj);
+  env->DeleteLocalRef(jAudioFrameTypeObj);
+  jfieldID jFloat32Planar = env->GetStaticFieldID(
+      jAudioFrameTypeClass, "FLOAT32_PLANAR",
+      "Lio/agora/rtc/rawdata/base/AudioFrame$AudioFrameType;");
+  jAudioFrameTypeObj =
+      env->GetStaticObjectField(jAudioFrameTypeClass, jFloat32Planar);
+  jAudioFrameTypeFloat32Planar = env->NewGlobalRef(jAudioFrameTypeObj);
+  env->DeleteLocalRef(jAudioFrameTypeObj);
+  env->DeleteLocalRef(jAudioFrameTypeClass);
+
+  // Preallocate one frame object per position, its fields are updated in place
+  // for every callback.
+  for (auto &slot : slots) {
+    jobject jFrame = env->NewObject(jAudioFrameClass, jAudioFrameInit, 0, 0, 0,
+                                    0, 0, nullptr, (jlong)0, 0);
+    slot.jFrame = env->NewGlobalRef(jFrame);
+    env->DeleteLocalRef(jFrame);
+  }
+
   env->GetJavaVM(&jvm);
+}
 
-  auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
-  if (rtcEngine) {
-    util::AutoPtr<media::IMediaEngine> mediaEngine;
-    mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
-    if (mediaEngine) {
-      mediaEngine->registerAudioFrameObserver(this);
+void AudioFrameObserver::InitJavaBatches(JNIEnv *env) {
+  jclass jCallerClass = env->GetObjectClass(jCallerRef);
+  jOnAudioFrameBatch =
+      env->GetMethodID(jCallerClass, "onAudioFrameBatch",
+                       "(Lio/agora/rtc/rawdata/base/AudioFrameBatch;)V");
+  env->DeleteLocalRef(jCallerClass);
+
+  jclass jBatchClass =
+      env->FindClass("io/agora/rtc/rawdata/base/AudioFrameBatch");
+  jmethodID jBatchInit = env->GetMethodID(jBatchClass, "<init>", "(I)V");
+  jfieldID jBatchUids = env->GetFieldID(jBatchClass, "uids", "[I");
+  jfieldID jBatchRenderTimeMs =
+      env->GetFieldID(jBatchClass, "renderTimeMs", "[J");
+  jBatchPosition = env->GetFieldID(jBatchClass, "position", "I");
+  jBatchFrameCount = env->GetFieldID(jBatchClass, "frameCount", "I");
+  jBatchSamples = env->GetFieldID(jBatchClass, "samples", "I");
+  jBatchBytesPerSample = env->GetFieldID(jBatchClass, "bytesPerSample", "I");
+  jBatchChannels = env->GetFieldID(jBatchClass, "channels", "I");
+  jBatchSamplesPerSec = env->GetFieldID(jBatchClass, "samplesPerSec", "I");
+  jBatchBuffer = env->GetFieldID(jBatchClass, "buffer", "[B");
+  jBatchByteBuffer =
+      env->GetFieldID(jBatchClass, "byteBuffer", "Ljava/nio/ByteBuffer;");
+
+  for (auto &batch : batches) {
+    jobject jBatch = env->NewObject(jBatchClass, jBatchInit, batchFrames);
+    batch.jBatch = env->NewGlobalRef(jBatch);
+    jobject jUids = env->GetObjectField(jBatch, jBatchUids);
+    batch.jUids = static_cast<jintArray>(env->NewGlobalRef(jUids));
+    jobject jRenderTimeMs = env->GetObjectField(jBatch, jBatchRenderTimeMs);
+    batch.jRenderTimeMs =
+        static_cast<jlongArray>(env->NewGlobalRef(jRenderTimeMs));
+    env->DeleteLocalRef(jRenderTimeMs);
+    env->DeleteLocalRef(jUids);
+    env->DeleteLocalRef(jBatch);
+    batch.uids.resize(batchFrames);
+    batch.renderTimeMs.resize(batchFrames);
+  }
+  env->DeleteLocalRef(jBatchClass);
+}
+
+void AudioFrameObserver::ReleaseJavaBatches(JNIEnv *env) {
+  for (auto &batch : batches) {
+    env->DeleteGlobalRef(batch.jBatch);
+    env->DeleteGlobalRef(batch.jUids);
+    env->DeleteGlobalRef(batch.jRenderTimeMs);
+    batch.jBatch = nullptr;
+    batch.jUids = nullptr;
+    batch.jRenderTimeMs = nullptr;
+  }
+  jOnAudioFrameBatch = nullptr;
+}
+
+void AudioFrameObserver::ReleaseJavaObserver() {
+  AttachCurrentThreadOnce attach(jvm);
+
+  attach.env()->DeleteGlobalRef(jCallerRef);
+  jOnRecordAudioFrame = nullptr;
+  jOnPlaybackAudioFrame = nullptr;
+  jOnMixedAudioFrame = nullptr;
+  jOnPlaybackAudioFrameBeforeMixing = nullptr;
+  jOnEarMonitoringAudioFrame = nullptr;
+  jOnAudioLevels = nullptr;
+  jOnVoiceActivity = nullptr;
+
+  for (auto &slot : slots) {
+    attach.env()->DeleteGlobalRef(slot.jFrame);
+    slot.jFrame = nullptr;
+    slot.bufferPool.Release(attach.env());
+  }
+
+  attach.env()->DeleteGlobalRef(jAudioFrameTypePcm16);
+  attach.env()->DeleteGlobalRef(jAudioFrameTypeFloat32Planar);
+  attach.env()->DeleteGlobalRef(jAudioFrameClass);
+  jAudioFrameInit = nullptr;
+  jCallerRef = nullptr;
+}
+
+void AudioFrameObserver::setObservedAudioFramePosition(int position) {
+  if (observedPosition.exchange(position) != position) {
+    // Registering again makes the SDK call getObservedAudioFramePosition.
+    RegisterWithMediaEngine(this);
+  }
+}
+
+int AudioFrameObserver::PositionIndex(int position) {
+  if (position <= 0 || (position & (position - 1)) != 0) {
+    return -1;
+  }
+  int index = __builtin_ctz(position);
+  return index < POSITION_INDEX_COUNT ? index : -1;
+}
+
+void AudioFrameObserver::setAudioParams(int position,
+                                        const AudioParams &params) {
+  int index = PositionIndex(position);
+  if (index < 0 || index == POSITION_INDEX_BEFORE_MIXING) {
+    LOGE("AudioFrameObserver: no AudioParams for position %d", position);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(audioParamsMutex);
+    AudioParams &current = audioParams[index];
+    if (current.sample_rate == params.sample_rate &&
+        current.channels == params.channels && current.mode == params.mode &&
+        current.samples_per_call == params.samples_per_call) {
+      return;
     }
+    current = params;
   }
+  // Registering again makes the SDK query the params.
+  RegisterWithMediaEngine(this);
 }
 
-AudioFrameObserver::~AudioFrameObserver() {
+media::IAudioFrameObserverBase::AudioParams
+AudioFrameObserver::GetAudioParams(POSITION_INDEX position) {
+  std::lock_guard<std::mutex> lock(audioParamsMutex);
+  return audioParams[position];
+}
+
+void AudioFrameObserver::addAudioProcessor(
+    int position, std::shared_ptr<IAudioProcessor> processor) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].add(std::move(processor));
+  }
+}
+
+void AudioFrameObserver::removeAudioProcessor(
+    int position, const std::shared_ptr<IAudioProcessor> &processor) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].remove(processor);
+  }
+}
+
+void AudioFrameObserver::clearAudioProcessors(int position) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].clear();
+  }
+}
+
+void AudioFrameObserver::RegisterWithMediaEngine(
+    media::IAudioFrameObserver *observer) {
   auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
   if (rtcEngine) {
     util::AutoPtr<media::IMediaEngine> mediaEngine;
     mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
     if (mediaEngine) {
-      mediaEngine->registerAudioFrameObserver(nullptr);
+      mediaEngine->registerAudioFrameObserver(observer);
     }
   }
+}
 
-  AttachThreadScoped ats(jvm);
+void AudioFrameObserver::setBeforeMixingUidFilter(const rtc::uid_t *allow,
+                                                  int allowCount,
+                                                  const rtc::uid_t *deny,
+                                                  int denyCount) {
+  beforeMixingUidFilter.set(allow, allowCount, deny, denyCount);
+}
 
-  ats.env()->DeleteGlobalRef(jCallerRef);
-  jOnRecordAudioFrame = nullptr;
-  jOnPlaybackAudioFrame = nullptr;
-  jOnMixedAudioFrame = nullptr;
-  jOnPlaybackAudioFrameBeforeMixing = nullptr;
+void AudioFrameObserver::setBeforeMixingSampleRate(int sampleRate) {
+  if (sampleRate > 0) {
+    // Builds the filters from the rates remote streams arrive at here, so
+    // the audio thread only looks them up.
+    const int inputRates[] = {8000, 16000, 32000, 44100, 48000};
+    for (int inputRate : inputRates) {
+      if (inputRate != sampleRate) {
+        PolyphaseFilter::Get(inputRate, sampleRate);
+      }
+    }
+  }
+  beforeMixingSampleRate.store(sampleRate, std::memory_order_relaxed);
+}
 
-  ats.env()->DeleteGlobalRef(jAudioFrameClass);
-  jAudioFrameInit = nullptr;
+void AudioFrameObserver::setAudioLevelMetering(int positions, int intervalMs) {
+  levelMeter.setInterval(intervalMs);
+  meteredPosition.store(positions, std::memory_order_relaxed);
+}
+
+int AudioFrameObserver::startAudioRecording(
+    int position, const AudioFileRecorder::Config &config) {
+  int index = PositionIndex(position);
+  if (index < 0) {
+    return -1;
+  }
+  auto recorder = std::make_shared<AudioFileRecorder>(config);
+  if (!recorder->Start()) {
+    return -1;
+  }
+  processorChains[index].add(recorder);
+
+  std::lock_guard<std::mutex> lock(recordingsMutex);
+  int id = nextRecordingId++;
+  recordings[id] = {index, recorder};
+  return id;
+}
+
+void AudioFrameObserver::stopAudioRecording(int id) {
+  Recording recording;
+  {
+    std::lock_guard<std::mutex> lock(recordingsMutex);
+    auto it = recordings.find(id);
+    if (it == recordings.end()) {
+      return;
+    }
+    recording = it->second;
+    recordings.erase(it);
+  }
+  processorChains[recording.position].remove(recording.recorder);
+  // Safe even if the SDK thread still runs the old chain snapshot.
+  recording.recorder->Stop();
+}
+
+bool AudioFrameObserver::getAudioRecordingStats(
+    int id, AudioFileRecorder::Stats &stats) {
+  std::lock_guard<std::mutex> lock(recordingsMutex);
+  auto it = recordings.find(id);
+  if (it == recordings.end()) {
+    return false;
+  }
+  stats = it->second.recorder->GetStats();
+  return true;
+}
+
+void AudioFrameObserver::setVoiceActivityDetection(int positions,
+                                                   bool gating) {
+  vadGating.store(gating, std::memory_order_relaxed);
+  vadPosition.store(positions, std::memory_order_relaxed);
+}
+
+bool AudioFrameObserver::getDeliveryStats(
+    int position, AsyncAudioDelivery::Stats &stats) const {
+  int index = PositionIndex(position);
+  if (!asyncDelivery || index < 0) {
+    return false;
+  }
+  stats = asyncDelivery->GetStats(index);
+  return true;
+}
+
+bool AudioFrameObserver::getCallbackTiming(
+    int position, CallbackTiming::METRIC metric,
+    LatencyHistogram::Snapshot &snapshot) const {
+  int index = PositionIndex(position);
+  if (index < 0 || metric < 0 || metric >= CallbackTiming::METRIC_COUNT) {
+    return false;
+  }
+  callbackTiming.Read(index, metric, snapshot);
+  return true;
+}
+
+void AudioFrameObserver::resetCallbackTiming() { callbackTiming.Reset(); }
+
+bool AudioFrameObserver::OnAudioFrame(POSITION_INDEX position, rtc::uid_t uid,
+                                      AudioFrame &audioFrame) {
+  long long start = CallbackTiming::NowUs();
+  // Before mixing arrives once per remote uid, so the gap to the previous
+  // callback belongs to another stream and says nothing about underruns.
+  if (position != POSITION_INDEX_BEFORE_MIXING) {
+    callbackTiming.Arrive(position, start);
+  }
+  bool ret = HandleAudioFrame(position, uid, audioFrame);
+  callbackTiming.Record(position, CallbackTiming::METRIC_CALLBACK,
+                        CallbackTiming::NowUs() - start);
+  return ret;
+}
+
+bool AudioFrameObserver::HandleAudioFrame(POSITION_INDEX position,
+                                          rtc::uid_t uid,
+                                          AudioFrame &audioFrame) {
+  if (!processorChains[position].process(audioFrame, uid)) {
+    return false;
+  }
+  if (!jCallerRef) {
+    return true;
+  }
+  if (meteredPosition.load(std::memory_order_relaxed) & (1 << position)) {
+    MeterAudioFrame(position, uid, audioFrame);
+  }
+  if ((vadPosition.load(std::memory_order_relaxed) & (1 << position)) &&
+      !DetectVoiceActivity(position, uid, audioFrame) &&
+      vadGating.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  if (deliveryMode == DELIVERY_MODE_NONE) {
+    return true;
+  }
+  AudioFrame resampled;
+  AudioFrame *delivered = &audioFrame;
+  if (position == POSITION_INDEX_BEFORE_MIXING &&
+      beforeMixingResamplers.Process(
+          uid, beforeMixingSampleRate.load(std::memory_order_relaxed),
+          audioFrame, resampled, CallbackTiming::NowUs() / 1000)) {
+    delivered = &resampled;
+  }
+  if (asyncDelivery) {
+    asyncDelivery->Push(position, uid, *delivered);
+    return true;
+  }
+  if (batchFrames > 0) {
+    AppendToBatch(position, uid, *delivered);
+    return true;
+  }
+  AttachCurrentThreadOnce attach(jvm);
+  JNIEnv *env = attach.env();
+  return CallJavaObserver(env, position, uid, *delivered,
+                          delivered == &audioFrame);
+}
+
+jboolean AudioFrameObserver::CallJavaObserver(JNIEnv *env,
+                                              POSITION_INDEX position,
+                                              rtc::uid_t uid,
+                                              AudioFrame &audioFrame,
+                                              bool writeBack) {
+  long long start = CallbackTiming::NowUs();
+  jobject obj = NativeToJavaAudioFrame(env, position, audioFrame);
+  long long called = CallbackTiming::NowUs();
+  jboolean ret = InvokeJavaObserver(env, position, uid, obj);
+  long long returned = CallbackTiming::NowUs();
+  long long jniUs = called - start;
+  if (writeBack) {
+    JavaToNativeBuffer(env, slots[position], audioFrame);
+    jniUs += CallbackTiming::NowUs() - returned;
+  }
+  callbackTiming.Record(position, CallbackTiming::METRIC_JNI, jniUs);
+  callbackTiming.Record(position, CallbackTiming::METRIC_HANDLER,
+                        returned - called);
+  return ret;
+}
+
+jboolean AudioFrameObserver::InvokeJavaObserver(JNIEnv *env,
+                                                POSITION_INDEX position,
+                                                rtc::uid_t uid,
+                                                jobject obj) {
+  switch (position) {
+  case POSITION_INDEX_PLAYBACK:
+    return env->CallBooleanMethod(jCallerRef, jOnPlaybackAudioFrame, obj);
+  case POSITION_INDEX_RECORD:
+    return env->CallBooleanMethod(jCallerRef, jOnRecordAudioFrame, obj);
+  case POSITION_INDEX_MIXED:
+    return env->CallBooleanMethod(jCallerRef, jOnMixedAudioFrame, obj);
+  case POSITION_INDEX_BEFORE_MIXING:
+    return env->CallBooleanMethod(jCallerRef, jOnPlaybackAudioFrameBeforeMixing,
+                                  uid, obj);
+  case POSITION_INDEX_EAR_MONITORING:
+    return env->CallBooleanMethod(jCallerRef, jOnEarMonitoringAudioFrame, obj);
+  default:
+    return true;
+  }
+}
+
+void AudioFrameObserver::MeterAudioFrame(POSITION_INDEX position,
+                                         rtc::uid_t uid,
+                                         const AudioFrame &audioFrame) {
+  if (!levelMeter.Add(position, uid, audioFrame)) {
+    return;
+  }
+  std::vector<AudioLevelMeter::Reading> &readings = levelReadings[position];
+  levelMeter.Collect(position, readings);
+  if (readings.empty()) {
+    return;
+  }
+
+  // Once per interval, so plain vectors are fine here.
+  int count = static_cast<int>(readings.size());
+  std::vector<jint> uids(count);
+  std::vector<jfloat> peak(count), rms(count), dbfs(count);
+  for (int i = 0; i < count; ++i) {
+    uids[i] = static_cast<jint>(readings[i].uid);
+    peak[i] = readings[i].peak;
+    rms[i] = readings[i].rms;
+    dbfs[i] = readings[i].dbfs;
+  }
+
+  AttachCurrentThreadOnce attach(jvm);
+  JNIEnv *env = attach.env();
+  jintArray jUids = env->NewIntArray(count);
+  jfloatArray jPeak = env->NewFloatArray(count);
+  jfloatArray jRms = env->NewFloatArray(count);
+  jfloatArray jDbfs = env->NewFloatArray(count);
+  env->SetIntArrayRegion(jUids, 0, count, uids.data());
+  env->SetFloatArrayRegion(jPeak, 0, count, peak.data());
+  env->SetFloatArrayRegion(jRms, 0, count, rms.data());
+  env->SetFloatArrayRegion(jDbfs, 0, count, dbfs.data());
+  env->CallVoidMethod(jCallerRef, jOnAudioLevels, 1 << position, jUids, jPeak,
+                      jRms, jDbfs);
+  env->DeleteLocalRef(jDbfs);
+  env->DeleteLocalRef(jRms);
+  env->DeleteLocalRef(jPeak);
+  env->DeleteLocalRef(jUids);
+}
+
+bool AudioFrameObserver::DetectVoiceActivity(POSITION_INDEX position,
+                                             rtc::uid_t uid,
+                                             const AudioFrame &audioFrame) {
+  bool speaking;
+  VoiceActivityDetector::EVENT event =
+      voiceActivityDetectors[position].Process(uid, audioFrame, speaking);
+  if (event != VoiceActivityDetector::EVENT_NONE) {
+    AttachCurrentThreadOnce attach(jvm);
+    attach.env()->CallVoidMethod(jCallerRef, jOnVoiceActivity, 1 << position,
+                              static_cast<jint>(uid),
+                              static_cast<jboolean>(speaking));
+  }
+  return speaking;
+}
+
+void AudioFrameObserver::AppendToBatch(POSITION_INDEX position,
+                                       rtc::uid_t uid,
+                                       const AudioFrame &audioFrame) {
+  FrameBatch &batch = batches[position];
+  int length = audioFrame.samplesPerChannel * audioFrame.channels *
+               audioFrame.bytesPerSample;
+  if (!audioFrame.buffer || length <= 0) {
+    return;
+  }
+
+  // A batch only holds frames of one format, a change closes it early.
+  if (batch.count > 0 &&
+      (batch.samplesPerChannel != audioFrame.samplesPerChannel ||
+       batch.bytesPerSample != audioFrame.bytesPerSample ||
+       batch.channels != audioFrame.channels ||
+       batch.samplesPerSec != audioFrame.samplesPerSec)) {
+    AttachCurrentThreadOnce attach(jvm);
+    FlushBatch(attach.env(), position);
+  }
+  if (batch.count == 0) {
+    batch.samplesPerChannel = audioFrame.samplesPerChannel;
+    batch.bytesPerSample = audioFrame.bytesPerSample;
+    batch.channels = audioFrame.channels;
+    batch.samplesPerSec = audioFrame.samplesPerSec;
+    // Only grows when the format does, so steady state never allocates.
+    if (batch.pcm.size() < static_cast<size_t>(length) * batchFrames) {
+      batch.pcm.resize(static_cast<size_t>(length) * batchFrames);
+    }
+  }
+
+  memcpy(&batch.pcm[static_cast<size_t>(length) * batch.count],
+         audioFrame.buffer, length);
+  batch.uids[batch.count] = static_cast<jint>(uid);
+  batch.renderTimeMs[batch.count] = audioFrame.renderTimeMs;
+  if (++batch.count == batchFrames) {
+    AttachCurrentThreadOnce attach(jvm);
+    FlushBatch(attach.env(), position);
+  }
+}
+
+void AudioFrameObserver::FlushBatch(JNIEnv *env, POSITION_INDEX position) {
+  long long start = CallbackTiming::NowUs();
+  FrameBatch &batch = batches[position];
+  JavaFrameSlot &slot = slots[position];
+  int length = batch.samplesPerChannel * batch.channels *
+               batch.bytesPerSample * batch.count;
+
+  jobject obj = batch.jBatch;
+  if (bufferType != BUFFER_TYPE_BYTE_ARRAY) {
+    env->SetObjectField(
+        obj, jBatchByteBuffer,
+        slot.bufferPool.DirectByteBuffer(env, batch.pcm.data(), length));
+  } else {
+    jbyteArray jByteArray = slot.bufferPool.ByteArray(env, length);
+    env->SetByteArrayRegion(jByteArray, 0, length,
+                            reinterpret_cast<const jbyte *>(batch.pcm.data()));
+    env->SetObjectField(obj, jBatchBuffer, jByteArray);
+  }
+  env->SetIntArrayRegion(batch.jUids, 0, batch.count, batch.uids.data());
+  env->SetLongArrayRegion(batch.jRenderTimeMs, 0, batch.count,
+                          batch.renderTimeMs.data());
+  env->SetIntField(obj, jBatchPosition, 1 << position);
+  env->SetIntField(obj, jBatchFrameCount, batch.count);
+  env->SetIntField(obj, jBatchSamples, batch.samplesPerChannel);
+  env->SetIntField(obj, jBatchBytesPerSample, batch.bytesPerSample);
+  env->SetIntField(obj, jBatchChannels, batch.channels);
+  env->SetIntField(obj, jBatchSamplesPerSec, batch.samplesPerSec);
+  batch.count = 0;
+
+  long long called = CallbackTiming::NowUs();
+  env->CallVoidMethod(jCallerRef, jOnAudioFrameBatch, obj);
+  callbackTiming.Record(position, CallbackTiming::METRIC_JNI, called - start);
+  callbackTiming.Record(position, CallbackTiming::METRIC_HANDLER,
+                        CallbackTiming::NowUs() - called);
 }
 
 bool AudioFrameObserver::onRecordAudioFrame(const char *channelId,
                                             AudioFrame &audioFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jbyteArray arr = NativeToJavaByteArray(env, audioFrame);
-  jobject obj = NativeToJavaAudioFrame(env, audioFrame, arr);
-  jboolean ret = env->CallBooleanMethod(jCallerRef, jOnRecordAudioFrame, obj);
-  env->GetByteArrayRegion(arr, 0, env->GetArrayLength(arr),
-                          static_cast<jbyte *>(audioFrame.buffer));
-  env->DeleteLocalRef(arr);
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!IsObserved(AUDIO_FRAME_POSITION_RECORD)) {
+    return true;
+  }
+  return OnAudioFrame(POSITION_INDEX_RECORD, 0, audioFrame);
 }
 
 bool AudioFrameObserver::onPlaybackAudioFrame(const char *channelId,
                                               AudioFrame &audioFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jbyteArray arr = NativeToJavaByteArray(env, audioFrame);
-  jobject obj = NativeToJavaAudioFrame(env, audioFrame, arr);
-  jboolean ret = env->CallBooleanMethod(jCallerRef, jOnPlaybackAudioFrame, obj);
-  env->GetByteArrayRegion(arr, 0, env->GetArrayLength(arr),
-                          static_cast<jbyte *>(audioFrame.buffer));
-  env->DeleteLocalRef(arr);
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!IsObserved(AUDIO_FRAME_POSITION_PLAYBACK)) {
+    return true;
+  }
+  return OnAudioFrame(POSITION_INDEX_PLAYBACK, 0, audioFrame);
 }
 
 bool AudioFrameObserver::onMixedAudioFrame(const char *channelId,
                                            AudioFrame &audioFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jbyteArray arr = NativeToJavaByteArray(env, audioFrame);
-  jobject obj = NativeToJavaAudioFrame(env, audioFrame, arr);
-  jboolean ret = env->CallBooleanMethod(jCallerRef, jOnMixedAudioFrame, obj);
-  env->GetByteArrayRegion(arr, 0, env->GetArrayLength(arr),
-                          static_cast<jbyte *>(audioFrame.buffer));
-  env->DeleteLocalRef(arr);
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!IsObserved(AUDIO_FRAME_POSITION_MIXED)) {
+    return true;
+  }
+  return OnAudioFrame(POSITION_INDEX_MIXED, 0, audioFrame);
 }
 
 bool AudioFrameObserver::onPlaybackAudioFrameBeforeMixing(
     const char *channelId, rtc::uid_t uid, AudioFrame &audioFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jbyteArray arr = NativeToJavaByteArray(env, audioFrame);
-  jobject obj = NativeToJavaAudioFrame(env, audioFrame, arr);
-  jboolean ret = env->CallBooleanMethod(
-      jCallerRef, jOnPlaybackAudioFrameBeforeMixing, uid, obj);
-  env->GetByteArrayRegion(arr, 0, env->GetArrayLength(arr),
-                          static_cast<jbyte *>(audioFrame.buffer));
-  env->DeleteLocalRef(arr);
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!IsObserved(AUDIO_FRAME_POSITION_BEFORE_MIXING) ||
+      !beforeMixingUidFilter.accepts(uid)) {
+    return true;
+  }
+  return OnAudioFrame(POSITION_INDEX_BEFORE_MIXING, uid, audioFrame);
 }
 
-jbyteArray AudioFrameObserver::NativeToJavaByteArray(JNIEnv *env,
-                                                     AudioFrame &audioFrame) {
+jobject AudioFrameObserver::NativeToJavaBuffer(JNIEnv *env,
+                                               JavaFrameSlot &slot,
+                                               AudioFrame &audioFrame) {
   int length = audioFrame.samplesPerChannel * audioFrame.channels *
                audioFrame.bytesPerSample;
 
-  jbyteArray jByteArray = env->NewByteArray(length);
-
-  if (audioFrame.buffer) {
-    env->SetByteArrayRegion(jByteArray, 0, length,
-                            static_cast<const jbyte *>(audioFrame.buffer));
+  if (!audioFrame.buffer || length <= 0) {
+    return nullptr;
+  }
+  if (bufferType == BUFFER_TYPE_DIRECT_BYTE_BUFFER) {
+    return slot.bufferPool.DirectByteBuffer(env, audioFrame.buffer, length);
   }
+  if (bufferType == BUFFER_TYPE_FLOAT_PLANAR) {
+    if (audioFrame.type != FRAME_TYPE_PCM16) {
+      return nullptr;
+    }
+    int count = audioFrame.samplesPerChannel * audioFrame.channels;
+    if (slot.planar.size() < static_cast<size_t>(count)) {
+      slot.planar.resize(count);
+    }
+    pcm::Int16ToFloatPlanar(static_cast<const int16_t *>(audioFrame.buffer),
+                            slot.planar.data(), audioFrame.samplesPerChannel,
+                            audioFrame.channels);
+    return slot.bufferPool.DirectByteBuffer(
+        env, slot.planar.data(), count * static_cast<int>(sizeof(float)));
+  }
+  jbyteArray jByteArray = slot.bufferPool.ByteArray(env, length);
+  env->SetByteArrayRegion(jByteArray, 0, length,
+                          static_cast<const jbyte *>(audioFrame.buffer));
   return jByteArray;
 }
 
+void AudioFrameObserver::JavaToNativeBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                                            AudioFrame &audioFrame) {
+  // The direct buffer aliases audioFrame.buffer, Java already wrote in place.
+  // Float planar frames are read-only.
+  if (bufferType != BUFFER_TYPE_BYTE_ARRAY || !slot.jBuffer) {
+    return;
+  }
+  jbyteArray jByteArray = static_cast<jbyteArray>(slot.jBuffer);
+  env->GetByteArrayRegion(jByteArray, 0, env->GetArrayLength(jByteArray),
+                          static_cast<jbyte *>(audioFrame.buffer));
+}
+
 jobject AudioFrameObserver::NativeToJavaAudioFrame(JNIEnv *env,
-                                                   AudioFrame &audioFrame,
-                                                   jbyteArray jByteArray) {
-  return env->NewObject(jAudioFrameClass, jAudioFrameInit, (int)audioFrame.type,
-                        audioFrame.samplesPerChannel,
-                        (int)audioFrame.bytesPerSample, audioFrame.channels,
-                        audioFrame.samplesPerSec, jByteArray,
-                        audioFrame.renderTimeMs, audioFrame.avsync_type);
+                                                   POSITION_INDEX position,
+                                                   AudioFrame &audioFrame) {
+  JavaFrameSlot &slot = slots[position];
+  slot.jBuffer = NativeToJavaBuffer(env, slot, audioFrame);
+
+  jobject obj = slot.jFrame;
+  bool planar = bufferType == BUFFER_TYPE_FLOAT_PLANAR;
+  env->SetObjectField(obj, jAudioFrameType,
+                      planar ? jAudioFrameTypeFloat32Planar
+                             : jAudioFrameTypePcm16);
+  env->SetIntField(obj, jAudioFrameSamples, audioFrame.samplesPerChannel);
+  env->SetIntField(obj, jAudioFrameBytesPerSample,
+                   planar ? static_cast<int>(sizeof(float))
+                          : (int)audioFrame.bytesPerSample);
+  env->SetIntField(obj, jAudioFrameChannels, audioFrame.channels);
+  env->SetIntField(obj, jAudioFrameSamplesPerSec, audioFrame.samplesPerSec);
+  if (bufferType != BUFFER_TYPE_BYTE_ARRAY) {
+    env->SetObjectField(obj, jAudioFrameByteBuffer, slot.jBuffer);
+  } else {
+    env->SetObjectField(obj, jAudioFrameBuffer, slot.jBuffer);
+  }
+  env->SetLongField(obj, jAudioFrameRenderTimeMs, audioFrame.renderTimeMs);
+  env->SetIntField(obj, jAudioFrameAvsyncType, audioFrame.avsync_type);
+  return obj;
 }
 
-bool AudioFrameObserver::onEarMonitoringAudioFrame(
-    media::IAudioFrameObserverBase::AudioFrame &audioFrame) {
-  return false;
+bool AudioFrameObserver::onEarMonitoringAudioFrame(AudioFrame &audioFrame) {
+  if (!IsObserved(AUDIO_FRAME_POSITION_EAR_MONITORING)) {
+    return true;
+  }
+  return OnAudioFrame(POSITION_INDEX_EAR_MONITORING, 0, audioFrame);
 }
 
-int AudioFrameObserver::getObservedAudioFramePosition() { return 0; }
+int AudioFrameObserver::getObservedAudioFramePosition() {
+  return observedPosition.load();
+}
 
 media::IAudioFrameObserverBase::AudioParams
 AudioFrameObserver::getPlaybackAudioParams() {
-  return media::IAudioFrameObserverBase::AudioParams();
+  return GetAudioParams(POSITION_INDEX_PLAYBACK);
 }
 
 media::IAudioFrameObserverBase::AudioParams
 AudioFrameObserver::getRecordAudioParams() {
-  return media::IAudioFrameObserverBase::AudioParams();
+  return GetAudioParams(POSITION_INDEX_RECORD);
 }
 
 media::IAudioFrameObserverBase::AudioParams
 AudioFrameObserver::getMixedAudioParams() {
-  return media::IAudioFrameObserverBase::AudioParams();
+  return GetAudioParams(POSITION_INDEX_MIXED);
 }
 
 media::IAudioFrameObserverBase::AudioParams
 AudioFrameObserver::getEarMonitoringAudioParams() {
-  return media::IAudioFrameObserverBase::AudioParams();
+  return GetAudioParams(POSITION_INDEX_EAR_MONITORING);
 }
 } // namespace agora
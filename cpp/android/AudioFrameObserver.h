@@ -3,14 +3,136 @@
 #include "include/IAgoraMediaEngine.h"
 #include "include/IAgoraRtcEngine.h"
 
+#include "AsyncAudioDelivery.h"
+#include "AudioFileRecorder.h"
+#include "AudioLevelMeter.h"
+#include "CallbackTiming.h"
+#include "AudioProcessor.h"
+#include "JavaBufferPool.h"
+#include "PolyphaseResampler.h"
+#include "UidFilter.h"
+#include "VoiceActivityDetector.h"
+
+#include <atomic>
 #include <jni.h>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace agora {
 class AudioFrameObserver : public media::IAudioFrameObserver {
 public:
-  AudioFrameObserver(JNIEnv *env, jobject jCaller, long long engineHandle);
+  // Must match IAudioFrameObserver.BUFFER_TYPE_* on the Java side.
+  enum BUFFER_TYPE {
+    // PCM is copied into a byte[] and copied back after the Java call.
+    BUFFER_TYPE_BYTE_ARRAY = 0,
+    // PCM is wrapped by a direct ByteBuffer, Java reads and writes in place.
+    BUFFER_TYPE_DIRECT_BYTE_BUFFER = 1,
+    // PCM16 is converted to float32 in [-1, 1), one plane per channel, into a
+    // pooled buffer wrapped by a direct ByteBuffer. Read-only. Batches stay
+    // PCM16 in a direct ByteBuffer.
+    BUFFER_TYPE_FLOAT_PLANAR = 2,
+  };
+
+  // Must match IAudioFrameObserver.DELIVERY_MODE_* on the Java side.
+  enum DELIVERY_MODE {
+    // The Java observer runs on the SDK thread and may edit the frame.
+    DELIVERY_MODE_SYNC = 0,
+    // The SDK thread only copies the frame into a ring, a consumer thread
+    // calls the Java observer later. Read-only, Java return values are ignored.
+    DELIVERY_MODE_ASYNC = 1,
+    // Consecutive frames are collected natively and passed to Java in one
+    // onAudioFrameBatch call on the SDK thread. Read-only.
+    DELIVERY_MODE_BATCH = 2,
+    // Frames never reach Java, only the native processors and level meter.
+    DELIVERY_MODE_NONE = 3,
+  };
+
+  // Index of each AUDIO_FRAME_POSITION bit, for per-position state.
+  enum POSITION_INDEX {
+    POSITION_INDEX_PLAYBACK = 0,
+    POSITION_INDEX_RECORD = 1,
+    POSITION_INDEX_MIXED = 2,
+    POSITION_INDEX_BEFORE_MIXING = 3,
+    POSITION_INDEX_EAR_MONITORING = 4,
+    POSITION_INDEX_COUNT = 5,
+  };
+
+public:
+  // `audioParams` holds POSITION_INDEX_COUNT entries, or is null to let the
+  // SDK choose the format of every position. `jCaller` may be null, in which
+  // case frames only go through the native processor chains. For
+  // DELIVERY_MODE_ASYNC, `deliveryFrames` is the ring capacity per position,
+  // for DELIVERY_MODE_BATCH the number of frames per batch. 0 picks a default.
+  AudioFrameObserver(JNIEnv *env, jobject jCaller, long long engineHandle,
+                     int bufferType, int observedPosition,
+                     const AudioParams *audioParams, int deliveryMode,
+                     int deliveryFrames);
   virtual ~AudioFrameObserver();
 
+  // Returns the POSITION_INDEX of a single AUDIO_FRAME_POSITION bit, or -1.
+  static int PositionIndex(int position);
+
+  // Changes the AUDIO_FRAME_POSITION bitmask at runtime. Unobserved positions
+  // return before touching JNI, and the SDK is asked to re-query the mask.
+  void setObservedAudioFramePosition(int position);
+
+  // Sets the format the SDK delivers at one AUDIO_FRAME_POSITION, so no
+  // conversion is needed downstream. Only playback, record, mixed and ear
+  // monitoring can be negotiated.
+  void setAudioParams(int position, const AudioParams &params);
+
+  // Attaches native stages to one AUDIO_FRAME_POSITION. They run in order on
+  // audioFrame.buffer inside the callback, before the Java observer if there
+  // is one. Edits only reach the SDK in RAW_AUDIO_FRAME_OP_MODE_READ_WRITE.
+  void addAudioProcessor(int position,
+                         std::shared_ptr<IAudioProcessor> processor);
+  void removeAudioProcessor(int position,
+                            const std::shared_ptr<IAudioProcessor> &processor);
+  void clearAudioProcessors(int position);
+
+  // Records one AUDIO_FRAME_POSITION to disk through an AudioFileRecorder at
+  // the end of its processor chain. Returns an id for the calls below, or -1
+  // if the position is invalid or the first file cannot be created.
+  int startAudioRecording(int position,
+                          const AudioFileRecorder::Config &config);
+  void stopAudioRecording(int id);
+  bool getAudioRecordingStats(int id, AudioFileRecorder::Stats &stats);
+
+  // Runs a VoiceActivityDetector per uid at the AUDIO_FRAME_POSITION bits in
+  // `positions`, meant for record and before-mixing, and calls the Java
+  // onVoiceActivity on speech start and end. With `gating`, frames that are
+  // not speech are not passed to Java. 0 positions turns detection off.
+  void setVoiceActivityDetection(int positions, bool gating);
+
+  // Restricts which remote uids reach the before-mixing position, see
+  // UidFilter::set. Filtered frames return before any processing or JNI work.
+  void setBeforeMixingUidFilter(const rtc::uid_t *allow, int allowCount,
+                                const rtc::uid_t *deny, int denyCount);
+
+  // Resamples before-mixing frames to `sampleRate` with a PolyphaseResampler
+  // per uid before they are passed to Java, since the SDK delivers each
+  // remote stream at its own rate. The processors, meter and detector still
+  // see the original frame, and Java edits of a resampled frame do not reach
+  // the SDK. 0 turns resampling off. Builds the filters for the common input
+  // rates on the calling thread.
+  void setBeforeMixingSampleRate(int sampleRate);
+
+  // Meters the AUDIO_FRAME_POSITION bits in `positions` natively and calls
+  // the Java onAudioLevels every `intervalMs` with peak, RMS and dBFS, per uid
+  // before mixing. 0 positions turns metering off.
+  void setAudioLevelMetering(int positions, int intervalMs);
+
+  // Callback timing of one AUDIO_FRAME_POSITION, see CallbackTiming. Always
+  // recorded. Returns false if the position is invalid.
+  bool getCallbackTiming(int position, CallbackTiming::METRIC metric,
+                         LatencyHistogram::Snapshot &snapshot) const;
+  void resetCallbackTiming();
+
+  // Ring counters of one AUDIO_FRAME_POSITION. Returns false unless the
+  // observer delivers in DELIVERY_MODE_ASYNC.
+  bool getDeliveryStats(int position, AsyncAudioDelivery::Stats &stats) const;
+
 public:
   bool onRecordAudioFrame(const char *channelId,
                           AudioFrame &audioFrame) override;
@@ -28,9 +150,74 @@ public:
   AudioParams getEarMonitoringAudioParams() override;
 
 private:
-  jbyteArray NativeToJavaByteArray(JNIEnv *env, AudioFrame &audioFrame);
-  jobject NativeToJavaAudioFrame(JNIEnv *env, AudioFrame &audioFrame,
-                                 jbyteArray jByteArray);
+  // The Java frame object and buffers reused by one position. Each position
+  // is only ever called back from a single SDK thread.
+  struct JavaFrameSlot {
+    jobject jFrame = nullptr;
+    jobject jBuffer = nullptr;
+    JavaBufferPool bufferPool;
+    // BUFFER_TYPE_FLOAT_PLANAR only, grows with the frame size.
+    std::vector<float> planar;
+  };
+
+  // Frames of one position waiting for DELIVERY_MODE_BATCH. The PCM buffer and
+  // the Java objects are allocated once and reused for every batch.
+  struct FrameBatch {
+    jobject jBatch = nullptr;
+    jintArray jUids = nullptr;
+    jlongArray jRenderTimeMs = nullptr;
+    std::vector<unsigned char> pcm;
+    std::vector<jint> uids;
+    std::vector<jlong> renderTimeMs;
+    int count = 0;
+    int samplesPerChannel = 0;
+    int bytesPerSample = 0;
+    int channels = 0;
+    int samplesPerSec = 0;
+  };
+
+  bool IsObserved(AUDIO_FRAME_POSITION position) const {
+    return (observedPosition.load(std::memory_order_relaxed) & position) != 0;
+  }
+
+  void RegisterWithMediaEngine(media::IAudioFrameObserver *observer);
+
+  void InitJavaObserver(JNIEnv *env);
+  void ReleaseJavaObserver();
+  void InitJavaBatches(JNIEnv *env);
+  void ReleaseJavaBatches(JNIEnv *env);
+
+  AudioParams GetAudioParams(POSITION_INDEX position);
+
+  // Common tail of every callback once the position is known to be observed,
+  // timed around HandleAudioFrame.
+  bool OnAudioFrame(POSITION_INDEX position, rtc::uid_t uid,
+                    AudioFrame &audioFrame);
+  bool HandleAudioFrame(POSITION_INDEX position, rtc::uid_t uid,
+                        AudioFrame &audioFrame);
+  // Calls the Java method of `position`, on any attached thread that owns the
+  // position's JavaFrameSlot. With `writeBack`, copies Java's edits back into
+  // `audioFrame` afterwards.
+  jboolean CallJavaObserver(JNIEnv *env, POSITION_INDEX position,
+                            rtc::uid_t uid, AudioFrame &audioFrame,
+                            bool writeBack);
+  jboolean InvokeJavaObserver(JNIEnv *env, POSITION_INDEX position,
+                              rtc::uid_t uid, jobject jAudioFrame);
+  void MeterAudioFrame(POSITION_INDEX position, rtc::uid_t uid,
+                       const AudioFrame &audioFrame);
+  // Returns whether the uid is speaking after this frame.
+  bool DetectVoiceActivity(POSITION_INDEX position, rtc::uid_t uid,
+                           const AudioFrame &audioFrame);
+  void AppendToBatch(POSITION_INDEX position, rtc::uid_t uid,
+                     const AudioFrame &audioFrame);
+  void FlushBatch(JNIEnv *env, POSITION_INDEX position);
+
+  jobject NativeToJavaBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                             AudioFrame &audioFrame);
+  void JavaToNativeBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                          AudioFrame &audioFrame);
+  jobject NativeToJavaAudioFrame(JNIEnv *env, POSITION_INDEX position,
+                                 AudioFrame &audioFrame);
 
 private:
   JavaVM *jvm = nullptr;
@@ -40,9 +227,63 @@ private:
   jmethodID jOnPlaybackAudioFrame;
   jmethodID jOnMixedAudioFrame;
   jmethodID jOnPlaybackAudioFrameBeforeMixing;
+  jmethodID jOnEarMonitoringAudioFrame;
+  jmethodID jOnAudioLevels;
+  jmethodID jOnVoiceActivity;
 
   jclass jAudioFrameClass;
   jmethodID jAudioFrameInit;
+  jfieldID jAudioFrameType;
+  jfieldID jAudioFrameSamples;
+  jfieldID jAudioFrameBytesPerSample;
+  jfieldID jAudioFrameChannels;
+  jfieldID jAudioFrameSamplesPerSec;
+  jfieldID jAudioFrameBuffer;
+  jfieldID jAudioFrameByteBuffer;
+  jfieldID jAudioFrameRenderTimeMs;
+  jfieldID jAudioFrameAvsyncType;
+  jobject jAudioFrameTypePcm16;
+  jobject jAudioFrameTypeFloat32Planar;
+
+  jmethodID jOnAudioFrameBatch = nullptr;
+  jfieldID jBatchPosition;
+  jfieldID jBatchFrameCount;
+  jfieldID jBatchSamples;
+  jfieldID jBatchBytesPerSample;
+  jfieldID jBatchChannels;
+  jfieldID jBatchSamplesPerSec;
+  jfieldID jBatchBuffer;
+  jfieldID jBatchByteBuffer;
+
+  const int bufferType;
+  const int deliveryMode;
+  std::atomic<int> observedPosition;
+  std::mutex audioParamsMutex;
+  AudioParams audioParams[POSITION_INDEX_COUNT];
+  JavaFrameSlot slots[POSITION_INDEX_COUNT];
+  AudioProcessorChain processorChains[POSITION_INDEX_COUNT];
+  UidFilter beforeMixingUidFilter;
+  std::atomic<int> beforeMixingSampleRate{0};
+  // Only touched by the before-mixing callback thread.
+  UidResamplers beforeMixingResamplers;
+  std::unique_ptr<AsyncAudioDelivery> asyncDelivery;
+  // Frames per batch, 0 unless in DELIVERY_MODE_BATCH.
+  int batchFrames = 0;
+  FrameBatch batches[POSITION_INDEX_COUNT];
+  std::atomic<int> meteredPosition{0};
+  AudioLevelMeter levelMeter{POSITION_INDEX_COUNT};
+  std::vector<AudioLevelMeter::Reading> levelReadings[POSITION_INDEX_COUNT];
+  struct Recording {
+    int position;
+    std::shared_ptr<AudioFileRecorder> recorder;
+  };
+  std::mutex recordingsMutex;
+  std::map<int, Recording> recordings;
+  int nextRecordingId = 0;
+  CallbackTiming callbackTiming{POSITION_INDEX_COUNT};
+  std::atomic<int> vadPosition{0};
+  std::atomic<bool> vadGating{false};
+  VoiceActivityDetector voiceActivityDetectors[POSITION_INDEX_COUNT];
 
   long long engineHandle;
 };
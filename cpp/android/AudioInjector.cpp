@@ -0,0 +1,156 @@
+#include "AudioInjector.h"
+
+#include "Pacer.h"
+
+#include <string.h>
+
+namespace agora {
+AudioInjector::AudioInjector(long long engineHandle, const Config &config)
+    : AudioInjector(QueryMediaEngine(engineHandle), config) {}
+
+AudioInjector::AudioInjector(media::IMediaEngine *mediaEngine,
+                             const Config &config)
+    : mediaEngine(mediaEngine), config(config),
+      frameBytes(config.sampleRate * FRAME_MS / 1000 * config.channels *
+                 static_cast<int>(sizeof(int16_t))),
+      ring(config.capacityFrames > 0 ? config.capacityFrames : 1) {
+  if (frameBytes > 0) {
+    pcm.resize(static_cast<size_t>(ring.capacity()) * frameBytes);
+    silence.resize(frameBytes);
+  }
+  frame.type = media::IAudioFrameObserverBase::FRAME_TYPE_PCM16;
+  frame.samplesPerChannel = config.sampleRate * FRAME_MS / 1000;
+  frame.bytesPerSample = rtc::TWO_BYTES_PER_SAMPLE;
+  frame.channels = config.channels;
+  frame.samplesPerSec = config.sampleRate;
+}
+
+AudioInjector::~AudioInjector() { Stop(); }
+
+media::IMediaEngine *AudioInjector::QueryMediaEngine(long long engineHandle) {
+  auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
+  util::AutoPtr<media::IMediaEngine> mediaEngine;
+  if (rtcEngine) {
+    mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
+  }
+  return mediaEngine.release();
+}
+
+bool AudioInjector::Start() {
+  if (running.load() || !mediaEngine || frameBytes <= 0) {
+    return false;
+  }
+  priming = true;
+  running.store(true);
+  thread = std::thread(&AudioInjector::Run, this);
+  return true;
+}
+
+void AudioInjector::Stop() {
+  if (!running.exchange(false)) {
+    return;
+  }
+  // The thread notices within one frame period.
+  thread.join();
+}
+
+int AudioInjector::Write(const void *data, int length) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  int accepted = 0;
+  unsigned char *slot;
+  int chunk;
+  while (accepted < length && (chunk = BeginWrite(slot)) > 0) {
+    if (chunk > length - accepted) {
+      chunk = length - accepted;
+    }
+    memcpy(slot, bytes + accepted, chunk);
+    CommitWrite(chunk);
+    accepted += chunk;
+  }
+  if (accepted < length) {
+    Refuse(length - accepted);
+  }
+  return accepted;
+}
+
+int AudioInjector::BeginWrite(unsigned char *&data) {
+  if (frameBytes <= 0) {
+    return 0;
+  }
+  if (!writing) {
+    if (!ring.BeginWrite(writeIndex)) {
+      return 0;
+    }
+    writing = true;
+    writeFill = 0;
+  }
+  data = &pcm[static_cast<size_t>(writeIndex) * frameBytes + writeFill];
+  return frameBytes - writeFill;
+}
+
+void AudioInjector::CommitWrite(int length) {
+  if (!writing || length <= 0) {
+    return;
+  }
+  int room = frameBytes - writeFill;
+  writeFill += length < room ? length : room;
+  if (writeFill == frameBytes) {
+    ring.EndWrite();
+    writing = false;
+  }
+}
+
+AudioInjector::Stats AudioInjector::GetStats() const {
+  Stats stats;
+  stats.framesPushed = framesPushed.load(std::memory_order_relaxed);
+  stats.silentFrames = silentFrames.load(std::memory_order_relaxed);
+  stats.underruns = underruns.load(std::memory_order_relaxed);
+  stats.bytesRefused = bytesRefused.load(std::memory_order_relaxed);
+  stats.lateTicks = lateTicks.load(std::memory_order_relaxed);
+  stats.pushErrors = pushErrors.load(std::memory_order_relaxed);
+  stats.bufferedFrames = static_cast<int>(ring.size());
+  stats.capacityFrames = static_cast<int>(ring.capacity());
+  return stats;
+}
+
+void AudioInjector::Run() {
+  Pacer::RaiseToAudioPriority("AudioInjector");
+  Pacer pacer(FRAME_MS * 1000000LL);
+  while (running.load()) {
+    Tick();
+    if (!pacer.Wait()) {
+      lateTicks.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void AudioInjector::Tick() {
+  unsigned target = config.jitterFrames > 0 ? config.jitterFrames : 1;
+  if (target > ring.capacity()) {
+    target = ring.capacity();
+  }
+  if (priming && ring.size() >= target) {
+    priming = false;
+  }
+  unsigned index;
+  if (!priming && ring.BeginRead(index)) {
+    Push(&pcm[static_cast<size_t>(index) * frameBytes]);
+    ring.EndRead();
+    framesPushed.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (!priming) {
+    underruns.fetch_add(1, std::memory_order_relaxed);
+    priming = true;
+  }
+  Push(silence.data());
+  silentFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioInjector::Push(void *buffer) {
+  frame.buffer = buffer;
+  if (mediaEngine->pushAudioFrame(&frame, config.trackId) != 0) {
+    pushErrors.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+} // namespace agora
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "include/IAgoraMediaEngine.h"
+#include "include/IAgoraRtcEngine.h"
+
+#include "SpscRing.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace agora {
+// Injects app PCM into the SDK with IMediaEngine::pushAudioFrame. The producer
+// writes arbitrary byte counts into a preallocated lock-free ring of 10 ms
+// frames; a pacing thread pushes one frame every 10 ms against absolute
+// deadlines, so producer bursts and scheduling jitter do not reach the SDK.
+// Pushing starts once `jitterFrames` are buffered and, after the ring runs
+// dry, resumes only when it has refilled to that depth; silence is pushed
+// meanwhile so the track stays continuous.
+class AudioInjector {
+public:
+  struct Config {
+    int sampleRate = 48000;
+    int channels = 1;
+    // From IMediaEngine::createCustomAudioTrack, 0 for the default track.
+    unsigned trackId = 0;
+    // Frames buffered before pushing starts, the added latency.
+    int jitterFrames = 5;
+    // Frames the ring holds, rounded up to a power of two. Writes beyond it
+    // are refused.
+    int capacityFrames = 50;
+  };
+
+  struct Stats {
+    long long framesPushed;
+    // Frames of silence pushed while priming or after an underrun.
+    long long silentFrames;
+    // Times the ring ran dry while pushing.
+    long long underruns;
+    long long bytesRefused;
+    // Times the pacing thread was so late that it skipped ahead instead of
+    // catching up.
+    long long lateTicks;
+    long long pushErrors;
+    int bufferedFrames;
+    int capacityFrames;
+  };
+
+  enum { FRAME_MS = 10 };
+
+public:
+  AudioInjector(long long engineHandle, const Config &config);
+  // Takes over `mediaEngine`, which is released with the injector.
+  AudioInjector(media::IMediaEngine *mediaEngine, const Config &config);
+  ~AudioInjector();
+
+  // Starts the pacing thread. Returns false if the media engine is missing
+  // or the format is invalid.
+  bool Start();
+  void Stop();
+
+  // Producer side, one thread at a time. Returns the bytes accepted, fewer
+  // than `length` when the ring is full.
+  int Write(const void *data, int length);
+
+  // Producer side without an intermediate buffer, for callers that fill the
+  // ring in place such as Dart through FFI. Returns how many bytes may be
+  // written at `data`, the rest of the frame being filled, or 0 when the ring
+  // is full. Calling it again before CommitWrite() returns the same space.
+  int BeginWrite(unsigned char *&data);
+  // Publishes `length` bytes written at the pointer from BeginWrite(), at
+  // most what it returned.
+  void CommitWrite(int length);
+  // Counts `length` bytes a producer dropped because BeginWrite() found the
+  // ring full.
+  void Refuse(int length) {
+    bytesRefused.fetch_add(length, std::memory_order_relaxed);
+  }
+
+  Stats GetStats() const;
+
+private:
+  static media::IMediaEngine *QueryMediaEngine(long long engineHandle);
+
+  void Run();
+  void Tick();
+  void Push(void *buffer);
+
+private:
+  util::AutoPtr<media::IMediaEngine> mediaEngine;
+  const Config config;
+  const int frameBytes;
+
+  SpscRing ring;
+  std::vector<unsigned char> pcm;
+  std::vector<unsigned char> silence;
+
+  // Producer side, the slot being filled.
+  bool writing = false;
+  unsigned writeIndex = 0;
+  int writeFill = 0;
+
+  // Pacing thread side.
+  media::IAudioFrameObserverBase::AudioFrame frame;
+  bool priming = true;
+
+  std::atomic<bool> running{false};
+  std::thread thread;
+
+  std::atomic<long long> framesPushed{0};
+  std::atomic<long long> silentFrames{0};
+  std::atomic<long long> underruns{0};
+  std::atomic<long long> bytesRefused{0};
+  std::atomic<long long> lateTicks{0};
+  std::atomic<long long> pushErrors{0};
+};
+} // namespace agora
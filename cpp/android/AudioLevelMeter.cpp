@@ -0,0 +1,81 @@
+#include "AudioLevelMeter.h"
+
+#include "PcmKernels.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace agora {
+AudioLevelMeter::AudioLevelMeter(int positionCount)
+    : positions(positionCount), intervalMs(100) {
+  for (auto &position : positions) {
+    // Enough for a large room before the first summary reallocates.
+    position.accumulators.reserve(32);
+  }
+}
+
+void AudioLevelMeter::setInterval(int intervalMs) {
+  this->intervalMs.store(intervalMs > 0 ? intervalMs : 100,
+                         std::memory_order_relaxed);
+}
+
+bool AudioLevelMeter::Add(
+    int position, rtc::uid_t uid,
+    const media::IAudioFrameObserverBase::AudioFrame &frame) {
+  Position &p = positions[position];
+  int count = frame.samplesPerChannel * frame.channels;
+  if (frame.type == media::IAudioFrameObserverBase::FRAME_TYPE_PCM16 &&
+      frame.buffer && count > 0) {
+    Accumulator *accumulator = nullptr;
+    for (auto &a : p.accumulators) {
+      if (a.uid == uid) {
+        accumulator = &a;
+        break;
+      }
+    }
+    if (!accumulator) {
+      p.accumulators.push_back({uid, 0, 0.0, 0});
+      accumulator = &p.accumulators.back();
+    }
+    pcm::Level level =
+        pcm::Measure(static_cast<const int16_t *>(frame.buffer), count);
+    if (level.peak > accumulator->peak) {
+      accumulator->peak = level.peak;
+    }
+    accumulator->sumOfSquares += level.sumOfSquares;
+    accumulator->samples += count;
+  }
+
+  long long now = NowMs();
+  if (p.lastSummaryMs == 0) {
+    p.lastSummaryMs = now;
+  }
+  return now - p.lastSummaryMs >= intervalMs.load(std::memory_order_relaxed);
+}
+
+void AudioLevelMeter::Collect(int position, std::vector<Reading> &readings) {
+  Position &p = positions[position];
+  const float silence = static_cast<float>(SILENCE_DBFS);
+  readings.clear();
+  for (auto &a : p.accumulators) {
+    float rms = a.samples > 0
+                    ? static_cast<float>(std::sqrt(a.sumOfSquares / a.samples) /
+                                         32768.0)
+                    : 0.0f;
+    float dbfs = rms > 0.0f ? 20.0f * std::log10(rms) : silence;
+    if (dbfs < silence) {
+      dbfs = silence;
+    }
+    readings.push_back({a.uid, a.peak / 32768.0f, rms, dbfs});
+  }
+  // Uids that stop sending drop out of the next summary.
+  p.accumulators.clear();
+  p.lastSummaryMs = NowMs();
+}
+
+long long AudioLevelMeter::NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+} // namespace agora
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include <atomic>
+#include <vector>
+
+namespace agora {
+// Accumulates peak and energy of PCM16 frames per position, and per uid for
+// positions that carry several users, and says when a summary is due. Each
+// position must only be fed from one thread at a time, which is how the SDK
+// calls back.
+class AudioLevelMeter {
+public:
+  struct Reading {
+    rtc::uid_t uid;
+    // Linear, 0 to 1 of full scale.
+    float peak;
+    float rms;
+    // RMS in dB relative to full scale, SILENCE_DBFS for digital silence.
+    float dbfs;
+  };
+
+  enum { SILENCE_DBFS = -100 };
+
+public:
+  explicit AudioLevelMeter(int positionCount);
+
+  void setInterval(int intervalMs);
+
+  // Adds one frame. Returns true once `intervalMs` elapsed since the last
+  // summary of `position`, the caller should Collect() then.
+  bool Add(int position, rtc::uid_t uid,
+           const media::IAudioFrameObserverBase::AudioFrame &frame);
+
+  // Replaces `readings` with one entry per uid seen since the last summary and
+  // starts a new interval. Reuses the capacity of `readings`.
+  void Collect(int position, std::vector<Reading> &readings);
+
+private:
+  struct Accumulator {
+    rtc::uid_t uid;
+    int peak;
+    double sumOfSquares;
+    long long samples;
+  };
+
+  struct Position {
+    std::vector<Accumulator> accumulators;
+    long long lastSummaryMs = 0;
+  };
+
+  static long long NowMs();
+
+private:
+  std::vector<Position> positions;
+  std::atomic<int> intervalMs;
+};
+} // namespace agora
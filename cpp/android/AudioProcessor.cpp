@@ -0,0 +1,28 @@
+#include "AudioProcessor.h"
+
+#include "PcmKernels.h"
+
+#include <string.h>
+
+namespace agora {
+bool GainAudioProcessor::process(
+    media::IAudioFrameObserverBase::AudioFrame &audioFrame,
+    rtc::uid_t /* uid */) {
+  if (audioFrame.type != media::IAudioFrameObserverBase::FRAME_TYPE_PCM16 ||
+      !audioFrame.buffer) {
+    return true;
+  }
+  float value = gain.load(std::memory_order_relaxed);
+  if (value == 1.0f) {
+    return true;
+  }
+  int count = audioFrame.samplesPerChannel * audioFrame.channels;
+  int16_t *samples = static_cast<int16_t *>(audioFrame.buffer);
+  if (value == 0.0f) {
+    memset(samples, 0, count * sizeof(int16_t));
+    return true;
+  }
+  pcm::Gain(samples, count, value);
+  return true;
+}
+} // namespace agora
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include "ProcessorChain.h"
+
+#include <atomic>
+#include <memory>
+
+namespace agora {
+// A native processing stage run by AudioFrameObserver inside the SDK audio
+// callback, before anything crosses into Java.
+class IAudioProcessor {
+public:
+  virtual ~IAudioProcessor() {}
+
+  // Processes audioFrame.buffer in place. `uid` is the remote user for the
+  // before-mixing position and 0 otherwise. Returning false stops the chain
+  // and the observer callback returns false to the SDK.
+  //
+  // Runs on the SDK audio thread: do not block, allocate or take locks that
+  // other threads hold for long.
+  virtual bool process(media::IAudioFrameObserverBase::AudioFrame &audioFrame,
+                       rtc::uid_t uid) = 0;
+};
+
+// The IAudioProcessor stages run at one position.
+typedef ProcessorChain<IAudioProcessor> AudioProcessorChain;
+
+// Multiplies 16-bit PCM by a linear gain with saturation, 0 mutes.
+class GainAudioProcessor : public IAudioProcessor {
+public:
+  explicit GainAudioProcessor(float gain = 1.0f) : gain(gain) {}
+
+  void setGain(float value) { gain.store(value, std::memory_order_relaxed); }
+
+  bool process(media::IAudioFrameObserverBase::AudioFrame &audioFrame,
+               rtc::uid_t uid) override;
+
+private:
+  std::atomic<float> gain;
+};
+} // namespace agora
@@ -0,0 +1,115 @@
+#include "AudioRenderPump.h"
+
+#include "Pacer.h"
+#include "VMUtil.h"
+
+namespace agora {
+AudioRenderPump::AudioRenderPump(long long engineHandle, const Config &config)
+    : config(config),
+      frameLength(config.sampleRate * config.periodMs / 1000 *
+                  config.channels * static_cast<int>(sizeof(int16_t))),
+      ring(config.depthFrames > 0 ? config.depthFrames : 1),
+      format(Format(config)), frame(format) {
+  auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
+  if (rtcEngine) {
+    mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
+  }
+  if (frameLength > 0) {
+    pcm.resize(static_cast<size_t>(ring.capacity() + 1) * frameLength);
+  }
+}
+
+AudioRenderPump::AudioFrame AudioRenderPump::Format(const Config &config) {
+  AudioFrame format;
+  format.type = media::IAudioFrameObserverBase::FRAME_TYPE_PCM16;
+  format.samplesPerChannel = config.sampleRate * config.periodMs / 1000;
+  format.bytesPerSample = rtc::TWO_BYTES_PER_SAMPLE;
+  format.channels = config.channels;
+  format.samplesPerSec = config.sampleRate;
+  return format;
+}
+
+AudioRenderPump::~AudioRenderPump() { Stop(); }
+
+bool AudioRenderPump::Start(Consumer consumer) {
+  if (running.load() || !mediaEngine || frameLength <= 0 ||
+      config.periodMs % 10 != 0) {
+    return false;
+  }
+  int ret = mediaEngine->setExternalAudioSink(true, config.sampleRate,
+                                              config.channels);
+  if (ret != 0) {
+    LOGE("AudioRenderPump: setExternalAudioSink failed, %d", ret);
+    return false;
+  }
+  this->consumer = std::move(consumer);
+  running.store(true);
+  thread = std::thread(&AudioRenderPump::Run, this);
+  return true;
+}
+
+void AudioRenderPump::Stop() {
+  if (!running.exchange(false)) {
+    return;
+  }
+  // The thread notices within one period.
+  thread.join();
+  mediaEngine->setExternalAudioSink(false, config.sampleRate, config.channels);
+}
+
+bool AudioRenderPump::Acquire(AudioFrame &out) {
+  unsigned index;
+  if (!ring.BeginRead(index)) {
+    underruns.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  out = format;
+  out.buffer = &pcm[static_cast<size_t>(index) * frameLength];
+  return true;
+}
+
+void AudioRenderPump::Release() { ring.EndRead(); }
+
+AudioRenderPump::Stats AudioRenderPump::GetStats() const {
+  Stats stats;
+  stats.framesPulled = framesPulled.load(std::memory_order_relaxed);
+  stats.pullErrors = pullErrors.load(std::memory_order_relaxed);
+  stats.overruns = overruns.load(std::memory_order_relaxed);
+  stats.underruns = underruns.load(std::memory_order_relaxed);
+  stats.lateTicks = lateTicks.load(std::memory_order_relaxed);
+  stats.bufferedFrames = static_cast<int>(ring.size());
+  stats.depthFrames = static_cast<int>(ring.capacity());
+  return stats;
+}
+
+void AudioRenderPump::Run() {
+  Pacer::RaiseToAudioPriority("AudioRenderPump");
+  Pacer pacer(config.periodMs * 1000000LL);
+  while (running.load()) {
+    Pull();
+    if (!pacer.Wait()) {
+      lateTicks.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void AudioRenderPump::Pull() {
+  unsigned index = ring.capacity();
+  bool queued = !consumer && ring.BeginWrite(index);
+  if (!consumer && !queued) {
+    // Keep pulling so the SDK's cadence holds, the frame is dropped.
+    overruns.fetch_add(1, std::memory_order_relaxed);
+  }
+  frame.buffer = &pcm[static_cast<size_t>(index) * frameLength];
+  if (mediaEngine->pullAudioFrame(&frame) != 0) {
+    pullErrors.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  framesPulled.fetch_add(1, std::memory_order_relaxed);
+  if (consumer) {
+    consumer(frame);
+  } else if (queued) {
+    ring.EndWrite();
+  }
+}
+} // namespace agora
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "include/IAgoraMediaEngine.h"
+#include "include/IAgoraRtcEngine.h"
+
+#include "SpscRing.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace agora {
+// Pulls the mixed playback with IMediaEngine::pullAudioFrame at the app's own
+// cadence, for a custom audio sink. A pacing thread pulls `periodMs` of PCM16
+// every `periodMs` straight into a slot of a preallocated ring of
+// `depthFrames`; the consumer reads the slot in place and releases it, so the
+// PCM is never copied after the SDK wrote it. Alternatively a native Consumer
+// runs on the pacing thread for every pulled frame. Start() enables the
+// external audio sink, call it before joining the channel.
+class AudioRenderPump {
+public:
+  typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+  // Runs on the pacing thread, `frame` is only valid during the call.
+  typedef std::function<void(const AudioFrame &frame)> Consumer;
+
+  struct Config {
+    int sampleRate = 48000;
+    int channels = 2;
+    // Multiple of 10 ms.
+    int periodMs = 10;
+    // Pulled frames held for the consumer, rounded up to a power of two.
+    int depthFrames = 8;
+  };
+
+  struct Stats {
+    long long framesPulled;
+    long long pullErrors;
+    // Frames pulled while the ring was full, the consumer is too slow.
+    long long overruns;
+    // Acquire() calls that found the ring empty, the consumer is too fast.
+    long long underruns;
+    // Times the pacing thread was so late that it skipped ahead.
+    long long lateTicks;
+    int bufferedFrames;
+    int depthFrames;
+  };
+
+public:
+  AudioRenderPump(long long engineHandle, const Config &config);
+  ~AudioRenderPump();
+
+  // With a `consumer`, frames are handed to it and never queued. Returns
+  // false if the media engine is missing, the format is invalid or the SDK
+  // refuses the external sink.
+  bool Start(Consumer consumer = nullptr);
+  void Stop();
+
+  // Consumer side, one thread at a time. Points `frame` at the oldest pulled
+  // frame, which stays valid until Release(). Returns false when empty.
+  bool Acquire(AudioFrame &frame);
+  void Release();
+
+  // The ring storage, frame i of the ring starts at i * frameBytes(). Lets
+  // Java wrap it once in a direct ByteBuffer.
+  void *buffer() { return pcm.data(); }
+  int bufferBytes() const { return static_cast<int>(pcm.size()); }
+  int frameBytes() const { return frameLength; }
+
+  Stats GetStats() const;
+
+private:
+  static AudioFrame Format(const Config &config);
+
+  void Run();
+  void Pull();
+
+private:
+  util::AutoPtr<media::IMediaEngine> mediaEngine;
+  const Config config;
+  const int frameLength;
+
+  SpscRing ring;
+  // The ring slots and, after them, a scratch slot that is pulled into when
+  // the ring is full.
+  std::vector<unsigned char> pcm;
+  // Set once, Acquire() copies it. `frame` is only touched by the pacing
+  // thread and the SDK inside pullAudioFrame.
+  const AudioFrame format;
+  AudioFrame frame;
+  Consumer consumer;
+
+  std::atomic<bool> running{false};
+  std::thread thread;
+
+  std::atomic<long long> framesPulled{0};
+  std::atomic<long long> pullErrors{0};
+  std::atomic<long long> overruns{0};
+  std::atomic<long long> underruns{0};
+  std::atomic<long long> lateTicks{0};
+};
+} // namespace agora
@@ -0,0 +1,127 @@
+#include "CallbackTiming.h"
+
+#include <chrono>
+#include <limits>
+
+namespace agora {
+namespace {
+const long long NO_MIN = std::numeric_limits<long long>::max();
+
+int HighestBit(unsigned long long value) {
+  return 63 - __builtin_clzll(value);
+}
+} // namespace
+
+long long LatencyHistogram::Snapshot::Percentile(double fraction) const {
+  if (count <= 0) {
+    return 0;
+  }
+  long long target = static_cast<long long>(fraction * count);
+  long long seen = 0;
+  long long value = maxUs;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    seen += buckets[i];
+    if (seen > target) {
+      value = BucketLowerBound(i);
+      break;
+    }
+  }
+  if (value < minUs) {
+    value = minUs;
+  }
+  return value < maxUs ? value : maxUs;
+}
+
+void LatencyHistogram::Record(long long us) {
+  if (us < 0) {
+    us = 0;
+  }
+  buckets[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+  sumUs.fetch_add(us, std::memory_order_relaxed);
+  long long current = minUs.load(std::memory_order_relaxed);
+  while (us < current && !minUs.compare_exchange_weak(
+                             current, us, std::memory_order_relaxed)) {
+  }
+  current = maxUs.load(std::memory_order_relaxed);
+  while (us > current && !maxUs.compare_exchange_weak(
+                             current, us, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Read(Snapshot &snapshot) const {
+  snapshot.count = 0;
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    // Derived from the buckets so percentiles stay consistent with count.
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sumUs = sumUs.load(std::memory_order_relaxed);
+  snapshot.minUs = minUs.load(std::memory_order_relaxed);
+  snapshot.maxUs = maxUs.load(std::memory_order_relaxed);
+  if (snapshot.minUs == NO_MIN) {
+    snapshot.minUs = 0;
+  }
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &bucket : buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  sumUs.store(0, std::memory_order_relaxed);
+  minUs.store(NO_MIN, std::memory_order_relaxed);
+  maxUs.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::BucketIndex(long long us) {
+  if (us < LINEAR_BUCKETS) {
+    return static_cast<int>(us);
+  }
+  // LINEAR_BUCKETS is 2^4 and SUB_BUCKETS 2^3, the three bits below the
+  // highest one pick the sub-bucket.
+  int octave = HighestBit(static_cast<unsigned long long>(us));
+  int index = LINEAR_BUCKETS + (octave - 4) * SUB_BUCKETS +
+              static_cast<int>((us >> (octave - 3)) & (SUB_BUCKETS - 1));
+  return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+}
+
+long long LatencyHistogram::BucketLowerBound(int index) {
+  if (index < LINEAR_BUCKETS) {
+    return index;
+  }
+  int octave = (index - LINEAR_BUCKETS) / SUB_BUCKETS + 4;
+  int sub = (index - LINEAR_BUCKETS) % SUB_BUCKETS;
+  return static_cast<long long>(SUB_BUCKETS + sub) << (octave - 3);
+}
+
+CallbackTiming::CallbackTiming(int positionCount)
+    : positionCount(positionCount),
+      histograms(new LatencyHistogram[positionCount * METRIC_COUNT]),
+      lastArrivalUs(new std::atomic<long long>[positionCount]) {
+  for (int i = 0; i < positionCount; ++i) {
+    lastArrivalUs[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+long long CallbackTiming::NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CallbackTiming::Arrive(int position, long long nowUs) {
+  long long last =
+      lastArrivalUs[position].exchange(nowUs, std::memory_order_relaxed);
+  if (last != 0) {
+    Record(position, METRIC_INTERVAL, nowUs - last);
+  }
+}
+
+void CallbackTiming::Reset() {
+  for (int i = 0; i < positionCount; ++i) {
+    lastArrivalUs[i].store(0, std::memory_order_relaxed);
+  }
+  for (int i = 0; i < positionCount * METRIC_COUNT; ++i) {
+    histograms[i].Reset();
+  }
+}
+} // namespace agora
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace agora {
+// Histogram of microsecond durations with log-linear buckets: exact below 16
+// us, then 8 buckets per power of two, so every bucket is within 12.5% of its
+// values, up to ~16 s. Record() is wait-free apart from the min/max CAS and
+// may run concurrently with Read() and Reset(); a snapshot taken meanwhile can
+// be off by the samples in flight.
+class LatencyHistogram {
+public:
+  enum {
+    LINEAR_BUCKETS = 16,
+    SUB_BUCKETS = 8,
+    OCTAVES = 20,
+    BUCKET_COUNT = LINEAR_BUCKETS + SUB_BUCKETS * OCTAVES,
+  };
+
+  struct Snapshot {
+    long long count;
+    long long sumUs;
+    long long minUs;
+    long long maxUs;
+    long long buckets[BUCKET_COUNT];
+
+    // Lower bound of the bucket holding the given fraction of the samples,
+    // clamped to [minUs, maxUs].
+    long long Percentile(double fraction) const;
+  };
+
+public:
+  LatencyHistogram() { Reset(); }
+
+  void Record(long long us);
+  void Read(Snapshot &snapshot) const;
+  void Reset();
+
+  static int BucketIndex(long long us);
+  static long long BucketLowerBound(int index);
+
+private:
+  std::atomic<long long> sumUs;
+  std::atomic<long long> minUs;
+  std::atomic<long long> maxUs;
+  std::atomic<long long> buckets[BUCKET_COUNT];
+};
+
+// Per-position timing of SDK audio callbacks: the interval between arrivals,
+// the time spent in the whole callback, and the part of it spent in JNI
+// marshalling versus in the Java handler itself. Each position must only
+// arrive from one thread at a time, which is how the SDK calls back.
+class CallbackTiming {
+public:
+  // Must match IAudioFrameObserver.TIMING_* on the Java side.
+  enum METRIC {
+    METRIC_INTERVAL = 0,
+    METRIC_CALLBACK = 1,
+    METRIC_JNI = 2,
+    METRIC_HANDLER = 3,
+    METRIC_COUNT = 4,
+  };
+
+public:
+  explicit CallbackTiming(int positionCount);
+
+  // Monotonic clock in microseconds.
+  static long long NowUs();
+
+  // Records the interval since the previous arrival of `position`.
+  void Arrive(int position, long long nowUs);
+  void Record(int position, METRIC metric, long long us) {
+    histograms[position * METRIC_COUNT + metric].Record(us);
+  }
+
+  void Read(int position, METRIC metric,
+            LatencyHistogram::Snapshot &snapshot) const {
+    histograms[position * METRIC_COUNT + metric].Read(snapshot);
+  }
+  // Clears every histogram; the next arrival of each position starts a new
+  // interval.
+  void Reset();
+
+private:
+  const int positionCount;
+  std::unique_ptr<LatencyHistogram[]> histograms;
+  std::unique_ptr<std::atomic<long long>[]> lastArrivalUs;
+};
+} // namespace agora
@@ -0,0 +1,91 @@
+#include "JavaBufferPool.h"
+
+namespace agora {
+JavaBufferPool::JavaBufferPool(int capacity) : capacity(capacity) {
+  byteArrays.reserve(capacity);
+  byteBuffers.reserve(capacity);
+}
+
+JavaBufferPool::~JavaBufferPool() {}
+
+void JavaBufferPool::SetCapacity(int capacity) {
+  this->capacity = capacity;
+  byteArrays.reserve(capacity);
+  byteBuffers.reserve(capacity);
+}
+
+jbyteArray JavaBufferPool::ByteArray(JNIEnv *env, int length, int tag) {
+  Entry *entry = Find(byteArrays, nullptr, length, tag);
+  if (!entry) {
+    jbyteArray jByteArray = env->NewByteArray(length);
+    entry = Insert(env, byteArrays, jByteArray, nullptr, length, tag);
+    env->DeleteLocalRef(jByteArray);
+  }
+  return static_cast<jbyteArray>(entry->ref);
+}
+
+jobject JavaBufferPool::DirectByteBuffer(JNIEnv *env, void *address,
+                                         int length) {
+  Entry *entry = Find(byteBuffers, address, length, 0);
+  if (!entry) {
+    jobject jByteBuffer = env->NewDirectByteBuffer(address, length);
+    entry = Insert(env, byteBuffers, jByteBuffer, address, length, 0);
+    env->DeleteLocalRef(jByteBuffer);
+  } else {
+    if (!jBufferClear) {
+      jclass jBufferClass = env->FindClass("java/nio/Buffer");
+      jBufferClear =
+          env->GetMethodID(jBufferClass, "clear", "()Ljava/nio/Buffer;");
+      env->DeleteLocalRef(jBufferClass);
+    }
+    // The previous handler may have moved position/limit.
+    env->DeleteLocalRef(env->CallObjectMethod(entry->ref, jBufferClear));
+  }
+  return entry->ref;
+}
+
+void JavaBufferPool::Release(JNIEnv *env) {
+  for (auto &entry : byteArrays) {
+    env->DeleteGlobalRef(entry.ref);
+  }
+  for (auto &entry : byteBuffers) {
+    env->DeleteGlobalRef(entry.ref);
+  }
+  byteArrays.clear();
+  byteBuffers.clear();
+}
+
+JavaBufferPool::Entry *JavaBufferPool::Find(std::vector<Entry> &entries,
+                                            void *address, int length,
+                                            int tag) {
+  for (auto &entry : entries) {
+    if (entry.address == address && entry.length == length &&
+        entry.tag == tag) {
+      entry.lastUse = ++useCounter;
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+JavaBufferPool::Entry *JavaBufferPool::Insert(JNIEnv *env,
+                                              std::vector<Entry> &entries,
+                                              jobject ref, void *address,
+                                              int length, int tag) {
+  Entry entry = {env->NewGlobalRef(ref), address, length, tag, ++useCounter};
+  if (static_cast<int>(entries.size()) < capacity) {
+    entries.push_back(entry);
+    return &entries.back();
+  }
+  // Evict the least recently used entry.
+  Entry *victim = &entries[0];
+  for (auto &e : entries) {
+    if (e.lastUse < victim->lastUse) {
+      victim = &e;
+    }
+  }
+  env->DeleteGlobalRef(victim->ref);
+  *victim = entry;
+  return victim;
+}
+} // namespace agora
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <jni.h>
+#include <vector>
+
+namespace agora {
+// Recycles Java byte[]s and direct ByteBuffers across callbacks, so once the
+// frame sizes are stable the hot path no longer allocates on the Java heap.
+// Returned references are global references owned by the pool, callers must
+// not delete them. Not thread safe, use one pool per callback thread.
+class JavaBufferPool {
+public:
+  explicit JavaBufferPool(int capacity = 8);
+  ~JavaBufferPool();
+
+  // Changes how many buffers of each kind are kept. Only call before the pool
+  // hands out its first buffer.
+  void SetCapacity(int capacity);
+
+  // Returns a byte[] of exactly `length` bytes. Content is undefined. Arrays
+  // in use at the same time, such as the planes of one frame, need different
+  // `tag`s, or two of equal length would be the same array.
+  jbyteArray ByteArray(JNIEnv *env, int length, int tag = 0);
+
+  // Returns a direct ByteBuffer over [address, address + length), with its
+  // position and limit reset.
+  jobject DirectByteBuffer(JNIEnv *env, void *address, int length);
+
+  // Deletes every cached reference, must be called on an attached thread
+  // before the pool is destroyed.
+  void Release(JNIEnv *env);
+
+private:
+  struct Entry {
+    jobject ref;
+    void *address;
+    int length;
+    int tag;
+    unsigned long long lastUse;
+  };
+
+  Entry *Find(std::vector<Entry> &entries, void *address, int length,
+             int tag);
+  Entry *Insert(JNIEnv *env, std::vector<Entry> &entries, jobject ref,
+                void *address, int length, int tag);
+
+private:
+  int capacity;
+  unsigned long long useCounter = 0;
+  std::vector<Entry> byteArrays;
+  std::vector<Entry> byteBuffers;
+  jmethodID jBufferClear = nullptr;
+};
+} // namespace agora
@@ -0,0 +1,51 @@
+#include "Pacer.h"
+
+#include "VMUtil.h"
+
+#include <errno.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace agora {
+namespace {
+const long long NS_PER_SEC = 1000000000LL;
+// Android's THREAD_PRIORITY_AUDIO.
+const int AUDIO_NICE = -16;
+} // namespace
+
+Pacer::Pacer(long long periodNs, int maxCatchUpPeriods)
+    : periodNs(periodNs), maxCatchUpPeriods(maxCatchUpPeriods),
+      deadline(NowNs()) {}
+
+bool Pacer::Wait() {
+  deadline += periodNs;
+  long long now = NowNs();
+  if (now - deadline > maxCatchUpPeriods * periodNs) {
+    deadline = now;
+    return false;
+  }
+  if (deadline > now) {
+    timespec ts;
+    ts.tv_sec = deadline / NS_PER_SEC;
+    ts.tv_nsec = deadline % NS_PER_SEC;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+           EINTR) {
+    }
+  }
+  return true;
+}
+
+long long Pacer::NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+void Pacer::RaiseToAudioPriority(const char *owner) {
+  if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), AUDIO_NICE) != 0) {
+    LOGE("%s: cannot raise priority, errno %d", owner, errno);
+  }
+}
+} // namespace agora
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace agora {
+// Wakes a thread once per period against absolute CLOCK_MONOTONIC deadlines,
+// so the period does not drift with the work done in between. A thread that
+// falls behind catches up without sleeping, unless it is more than
+// `maxCatchUpPeriods` late, in which case it skips ahead.
+class Pacer {
+public:
+  explicit Pacer(long long periodNs, int maxCatchUpPeriods = 5);
+
+  // Sleeps until the next deadline. Returns false if it skipped ahead.
+  bool Wait();
+
+  static long long NowNs();
+
+  // Moves the calling thread to Android's THREAD_PRIORITY_AUDIO, which app
+  // threads may take without a permission. Logs on failure.
+  static void RaiseToAudioPriority(const char *owner);
+
+private:
+  const long long periodNs;
+  const int maxCatchUpPeriods;
+  long long deadline;
+};
+} // namespace agora
@@ -0,0 +1,443 @@
+#include "PcmKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PCM_KERNELS_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define PCM_KERNELS_SSE2 1
+#include <immintrin.h>
+#endif
+
+namespace agora {
+namespace pcm {
+namespace {
+inline int16_t SaturateToInt16(float value) {
+  if (value > 32767.0f) {
+    return 32767;
+  }
+  if (value < -32768.0f) {
+    return -32768;
+  }
+  return static_cast<int16_t>(value);
+}
+
+inline int16_t SaturateToInt16(int value) {
+  if (value > 32767) {
+    return 32767;
+  }
+  if (value < -32768) {
+    return -32768;
+  }
+  return static_cast<int16_t>(value);
+}
+
+inline int Abs(int value) { return value < 0 ? -value : value; }
+
+#if PCM_KERNELS_NEON
+inline float32x4_t ScaledFloat(int16x4_t v, float scale) {
+  return vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(v)), scale);
+}
+#endif
+
+#if PCM_KERNELS_SSE2
+bool HasAvx2() {
+  static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+  return hasAvx2;
+}
+
+// Sign-extends the low and high four int16 lanes to float.
+inline __m128 LowToFloat(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline __m128 HighToFloat(__m128i v) {
+  return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+// Clamps before converting, so cvttps never sees values outside int32.
+inline __m128i FloatToInt32(__m128 v) {
+  v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-32768.0f)),
+                 _mm_set1_ps(32767.0f));
+  return _mm_cvttps_epi32(v);
+}
+
+__attribute__((target("avx2"))) int GainAvx2(int16_t *samples, int count,
+                                              float gain) {
+  const __m256 g = _mm256_set1_ps(gain);
+  const __m256 lo = _mm256_set1_ps(-32768.0f);
+  const __m256 hi = _mm256_set1_ps(32767.0f);
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples + i));
+    __m256 a = _mm256_cvtepi32_ps(
+        _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+    __m256 b = _mm256_cvtepi32_ps(
+        _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+    a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(a, g), lo), hi);
+    b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(b, g), lo), hi);
+    // packs works per 128-bit lane, restore the order afterwards.
+    __m256i packed =
+        _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+    packed = _mm256_permute4x64_epi64(packed, 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(samples + i), packed);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) int MixAddAvx2(int16_t *dst,
+                                                const int16_t *src,
+                                                int count) {
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_adds_epi16(a, b));
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) int Int16ToFloatAvx2(const int16_t *in,
+                                                      float *out, int count) {
+  const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v));
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(f, scale));
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) int FloatToInt16Avx2(const float *in,
+                                                      int16_t *out,
+                                                      int count) {
+  const __m256 scale = _mm256_set1_ps(32768.0f);
+  const __m256 lo = _mm256_set1_ps(-32768.0f);
+  const __m256 hi = _mm256_set1_ps(32767.0f);
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256 a = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+    __m256 b = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale);
+    a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+    b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+    __m256i packed =
+        _mm256_packs_epi32(_mm256_cvttps_epi32(a), _mm256_cvttps_epi32(b));
+    packed = _mm256_permute4x64_epi64(packed, 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+  }
+  return i;
+}
+
+// No FMA: some x86 emulators expose AVX2 without it, and HasAvx2() is all
+// that is checked.
+__attribute__((target("avx2"))) float DotAvx2(const float *a, const float *b,
+                                              int count, int &i) {
+  __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+  for (; i + 16 <= count; i += 16) {
+    sum0 = _mm256_add_ps(
+        sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),
+                                             _mm256_loadu_ps(b + i + 8)));
+  }
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum0),
+                          _mm256_extractf128_ps(sum0, 1));
+  float lanes[4];
+  _mm_storeu_ps(lanes, sum);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+} // namespace
+
+void Gain(int16_t *samples, int count, float gain) {
+  int i = 0;
+#if PCM_KERNELS_NEON
+  const float32x4_t g = vdupq_n_f32(gain);
+  const float32x4_t lo = vdupq_n_f32(-32768.0f);
+  const float32x4_t hi = vdupq_n_f32(32767.0f);
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t v = vld1q_s16(samples + i);
+    float32x4_t a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    float32x4_t b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+    a = vminq_f32(vmaxq_f32(vmulq_f32(a, g), lo), hi);
+    b = vminq_f32(vmaxq_f32(vmulq_f32(b, g), lo), hi);
+    vst1q_s16(samples + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)),
+                                        vqmovn_s32(vcvtq_s32_f32(b))));
+  }
+#elif PCM_KERNELS_SSE2
+  if (HasAvx2()) {
+    i = GainAvx2(samples, count, gain);
+  }
+  const __m128 g = _mm_set1_ps(gain);
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+    __m128i a = FloatToInt32(_mm_mul_ps(LowToFloat(v), g));
+    __m128i b = FloatToInt32(_mm_mul_ps(HighToFloat(v), g));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i),
+                     _mm_packs_epi32(a, b));
+  }
+#endif
+  for (; i < count; ++i) {
+    samples[i] = SaturateToInt16(samples[i] * gain);
+  }
+}
+
+void MixAdd(int16_t *dst, const int16_t *src, int count) {
+  int i = 0;
+#if PCM_KERNELS_NEON
+  for (; i + 8 <= count; i += 8) {
+    vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+  }
+#elif PCM_KERNELS_SSE2
+  if (HasAvx2()) {
+    i = MixAddAvx2(dst, src, count);
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_adds_epi16(a, b));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] = SaturateToInt16(dst[i] + src[i]);
+  }
+}
+
+void DownmixStereoToMono(const int16_t *stereo, int16_t *mono, int frames) {
+  int i = 0;
+#if PCM_KERNELS_NEON
+  for (; i + 8 <= frames; i += 8) {
+    int16x8x2_t v = vld2q_s16(stereo + i * 2);
+    vst1q_s16(mono + i, vhaddq_s16(v.val[0], v.val[1]));
+  }
+#elif PCM_KERNELS_SSE2
+  const __m128i ones = _mm_set1_epi16(1);
+  for (; i + 8 <= frames; i += 8) {
+    __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(stereo + i * 2));
+    __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(stereo + i * 2 + 8));
+    // madd with ones sums each left/right pair into an int32.
+    a = _mm_srai_epi32(_mm_madd_epi16(a, ones), 1);
+    b = _mm_srai_epi32(_mm_madd_epi16(b, ones), 1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(mono + i),
+                     _mm_packs_epi32(a, b));
+  }
+#endif
+  for (; i < frames; ++i) {
+    mono[i] = static_cast<int16_t>((stereo[i * 2] + stereo[i * 2 + 1]) >> 1);
+  }
+}
+
+void UpmixMonoToStereo(const int16_t *mono, int16_t *stereo, int frames) {
+  int i = 0;
+#if PCM_KERNELS_NEON
+  for (; i + 8 <= frames; i += 8) {
+    int16x8x2_t v;
+    v.val[0] = v.val[1] = vld1q_s16(mono + i);
+    vst2q_s16(stereo + i * 2, v);
+  }
+#elif PCM_KERNELS_SSE2
+  for (; i + 8 <= frames; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mono + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(stereo + i * 2),
+                     _mm_unpacklo_epi16(v, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(stereo + i * 2 + 8),
+                     _mm_unpackhi_epi16(v, v));
+  }
+#endif
+  for (; i < frames; ++i) {
+    stereo[i * 2] = stereo[i * 2 + 1] = mono[i];
+  }
+}
+
+void Int16ToFloat(const int16_t *in, float *out, int count) {
+  const float scale = 1.0f / 32768.0f;
+  int i = 0;
+#if PCM_KERNELS_NEON
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t v = vld1q_s16(in + i);
+    vst1q_f32(out + i,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+    vst1q_f32(out + i + 4,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+  }
+#elif PCM_KERNELS_SSE2
+  if (HasAvx2()) {
+    i = Int16ToFloatAvx2(in, out, count);
+  }
+  const __m128 s = _mm_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    _mm_storeu_ps(out + i, _mm_mul_ps(LowToFloat(v), s));
+    _mm_storeu_ps(out + i + 4, _mm_mul_ps(HighToFloat(v), s));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = in[i] * scale;
+  }
+}
+
+void Int16ToFloatPlanar(const int16_t *interleaved, float *planar, int frames,
+                        int channels) {
+  if (channels == 1) {
+    Int16ToFloat(interleaved, planar, frames);
+    return;
+  }
+  const float scale = 1.0f / 32768.0f;
+  int i = 0;
+  if (channels == 2) {
+    float *left = planar;
+    float *right = planar + frames;
+#if PCM_KERNELS_NEON
+    for (; i + 8 <= frames; i += 8) {
+      int16x8x2_t v = vld2q_s16(interleaved + i * 2);
+      vst1q_f32(left + i, ScaledFloat(vget_low_s16(v.val[0]), scale));
+      vst1q_f32(left + i + 4, ScaledFloat(vget_high_s16(v.val[0]), scale));
+      vst1q_f32(right + i, ScaledFloat(vget_low_s16(v.val[1]), scale));
+      vst1q_f32(right + i + 4, ScaledFloat(vget_high_s16(v.val[1]), scale));
+    }
+#elif PCM_KERNELS_SSE2
+    const __m128 s = _mm_set1_ps(scale);
+    for (; i + 4 <= frames; i += 4) {
+      // Each 32-bit lane holds one frame, left in the low half.
+      __m128i v = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(interleaved + i * 2));
+      __m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+      __m128i r = _mm_srai_epi32(v, 16);
+      _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(l), s));
+      _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), s));
+    }
+#endif
+  }
+  for (; i < frames; ++i) {
+    for (int c = 0; c < channels; ++c) {
+      planar[c * frames + i] = interleaved[i * channels + c] * scale;
+    }
+  }
+}
+
+void FloatToInt16(const float *in, int16_t *out, int count) {
+  int i = 0;
+#if PCM_KERNELS_NEON
+  const float32x4_t lo = vdupq_n_f32(-32768.0f);
+  const float32x4_t hi = vdupq_n_f32(32767.0f);
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t a = vmulq_n_f32(vld1q_f32(in + i), 32768.0f);
+    float32x4_t b = vmulq_n_f32(vld1q_f32(in + i + 4), 32768.0f);
+    a = vminq_f32(vmaxq_f32(a, lo), hi);
+    b = vminq_f32(vmaxq_f32(b, lo), hi);
+    vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)),
+                                    vqmovn_s32(vcvtq_s32_f32(b))));
+  }
+#elif PCM_KERNELS_SSE2
+  if (HasAvx2()) {
+    i = FloatToInt16Avx2(in, out, count);
+  }
+  const __m128 scale = _mm_set1_ps(32768.0f);
+  for (; i + 8 <= count; i += 8) {
+    __m128i a = FloatToInt32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+    __m128i b = FloatToInt32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packs_epi32(a, b));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = SaturateToInt16(in[i] * 32768.0f);
+  }
+}
+
+float Dot(const float *a, const float *b, int count) {
+  float result = 0.0f;
+  int i = 0;
+#if PCM_KERNELS_NEON
+  float32x4_t sum0 = vdupq_n_f32(0.0f), sum1 = vdupq_n_f32(0.0f);
+  for (; i + 8 <= count; i += 8) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  float lanes[4];
+  vst1q_f32(lanes, vaddq_f32(sum0, sum1));
+  result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif PCM_KERNELS_SSE2
+  if (HasAvx2()) {
+    result = DotAvx2(a, b, count, i);
+  }
+  __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+  for (; i + 8 <= count; i += 8) {
+    sum0 = _mm_add_ps(sum0,
+                      _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    sum1 = _mm_add_ps(
+        sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+  result += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+  for (; i < count; ++i) {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+Level Measure(const int16_t *samples, int count) {
+  Level level = {0, 0.0};
+  int maxValue = 0, minValue = 0;
+  int i = 0;
+#if PCM_KERNELS_NEON
+  int16x8_t maxV = vdupq_n_s16(0), minV = vdupq_n_s16(0);
+  float32x4_t sumV = vdupq_n_f32(0.0f);
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t v = vld1q_s16(samples + i);
+    maxV = vmaxq_s16(maxV, v);
+    minV = vminq_s16(minV, v);
+    float32x4_t a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    float32x4_t b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+    sumV = vmlaq_f32(vmlaq_f32(sumV, a, a), b, b);
+  }
+  int16_t maxLanes[8], minLanes[8];
+  float sumLanes[4];
+  vst1q_s16(maxLanes, maxV);
+  vst1q_s16(minLanes, minV);
+  vst1q_f32(sumLanes, sumV);
+#elif PCM_KERNELS_SSE2
+  __m128i maxV = _mm_setzero_si128(), minV = _mm_setzero_si128();
+  __m128 sumV = _mm_setzero_ps();
+  for (; i + 8 <= count; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+    maxV = _mm_max_epi16(maxV, v);
+    minV = _mm_min_epi16(minV, v);
+    // Squares in float, madd_epi16 overflows for two -32768 samples.
+    __m128 a = LowToFloat(v);
+    __m128 b = HighToFloat(v);
+    sumV = _mm_add_ps(sumV, _mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)));
+  }
+  int16_t maxLanes[8], minLanes[8];
+  float sumLanes[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(maxLanes), maxV);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(minLanes), minV);
+  _mm_storeu_ps(sumLanes, sumV);
+#endif
+#if PCM_KERNELS_NEON || PCM_KERNELS_SSE2
+  for (int lane = 0; lane < 8; ++lane) {
+    maxValue = maxLanes[lane] > maxValue ? maxLanes[lane] : maxValue;
+    minValue = minLanes[lane] < minValue ? minLanes[lane] : minValue;
+  }
+  for (int lane = 0; lane < 4; ++lane) {
+    level.sumOfSquares += sumLanes[lane];
+  }
+#endif
+  for (; i < count; ++i) {
+    int sample = samples[i];
+    maxValue = sample > maxValue ? sample : maxValue;
+    minValue = sample < minValue ? sample : minValue;
+    level.sumOfSquares += static_cast<double>(sample) * sample;
+  }
+  level.peak = Abs(minValue) > maxValue ? Abs(minValue) : maxValue;
+  return level;
+}
+} // namespace pcm
+} // namespace agora
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace agora {
+// Vectorized loops over interleaved FRAME_TYPE_PCM16 samples. Each kernel has
+// a NEON, SSE2 and AVX2 path where the target has them, picked at compile time
+// or, for AVX2, once at runtime, and a scalar fallback with identical results
+// except for float rounding in Dot and Measure. `count` is in samples, `frames`
+// in samples per channel. Unless noted, input and output must not overlap.
+// cpp/test checks every path against scalar reference loops.
+namespace pcm {
+// samples *= gain, rounded toward zero and saturated to int16.
+void Gain(int16_t *samples, int count, float gain);
+
+// dst = saturate(dst + src).
+void MixAdd(int16_t *dst, const int16_t *src, int count);
+
+// mono[i] = (left + right) >> 1. `mono` may be `stereo`, the mono samples are
+// written to its first half.
+void DownmixStereoToMono(const int16_t *stereo, int16_t *mono, int frames);
+
+// Duplicates each sample into both channels.
+void UpmixMonoToStereo(const int16_t *mono, int16_t *stereo, int frames);
+
+// Scales to [-1, 1).
+void Int16ToFloat(const int16_t *in, float *out, int count);
+
+// Int16ToFloat into planar output: channel c of frame i goes to
+// planar[c * frames + i].
+void Int16ToFloatPlanar(const int16_t *interleaved, float *planar, int frames,
+                        int channels);
+
+// Scales by 32768, rounded toward zero and saturated to int16.
+void FloatToInt16(const float *in, int16_t *out, int count);
+
+// Sum of a[i] * b[i], the inner loop of FIR filters. The summation order
+// differs between paths, so results may differ in the last bits.
+float Dot(const float *a, const float *b, int count);
+
+struct Level {
+  // Largest absolute sample value, 0 to 32768.
+  int peak;
+  double sumOfSquares;
+};
+
+// Peak and sum of squares in one pass, for RMS and dBFS.
+Level Measure(const int16_t *samples, int count);
+} // namespace pcm
+} // namespace agora
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+namespace agora {
+// How the planes of each VIDEO_PIXEL_FORMAT sit in memory, so that plane
+// sizes come from one table instead of a switch per call site. Everything is
+// constexpr and usable in static_asserts as well as per frame.
+namespace pixel {
+enum { MAX_PLANES = 3, FORMAT_COUNT = media::base::VIDEO_PIXEL_I010 + 1 };
+
+struct PlaneLayout {
+  // Planes in VideoFrame::yBuffer, uBuffer, vBuffer order, 0 for texture,
+  // iOS-only and unknown formats, which have no CPU planes to marshal.
+  int planeCount;
+  // Plane i holds ceil(height / heightDivisor[i]) rows of
+  // ceil(width / widthDivisor[i]) samples of bytesPerPixel[i] bytes each.
+  int heightDivisor[MAX_PLANES];
+  int widthDivisor[MAX_PLANES];
+  int bytesPerPixel[MAX_PLANES];
+};
+
+// Indexed by VIDEO_PIXEL_FORMAT. NV12 and NV21 carry the interleaved chroma in
+// uBuffer; I010 stores each 10-bit sample in 16 bits.
+constexpr PlaneLayout kPlaneLayouts[FORMAT_COUNT] = {
+    /* 0 DEFAULT */ {0, {}, {}, {}},
+    /* 1 I420 */ {3, {1, 2, 2}, {1, 2, 2}, {1, 1, 1}},
+    /* 2 BGRA */ {1, {1}, {1}, {4}},
+    /* 3 NV21 */ {2, {1, 2}, {1, 2}, {1, 2}},
+    /* 4 RGBA */ {1, {1}, {1}, {4}},
+    /* 5 */ {0, {}, {}, {}},
+    /* 6 */ {0, {}, {}, {}},
+    /* 7 */ {0, {}, {}, {}},
+    /* 8 NV12 */ {2, {1, 2}, {1, 2}, {1, 2}},
+    /* 9 */ {0, {}, {}, {}},
+    /* 10 TEXTURE_2D */ {0, {}, {}, {}},
+    /* 11 TEXTURE_OES */ {0, {}, {}, {}},
+    /* 12 CVPIXEL_NV12 */ {0, {}, {}, {}},
+    /* 13 CVPIXEL_I420 */ {0, {}, {}, {}},
+    /* 14 CVPIXEL_BGRA */ {0, {}, {}, {}},
+    /* 15 CVPIXEL_P010 */ {0, {}, {}, {}},
+    /* 16 I422 */ {3, {1, 1, 1}, {1, 2, 2}, {1, 1, 1}},
+    /* 17 TEXTURE_ID3D11TEXTURE2D */ {0, {}, {}, {}},
+    /* 18 I010 */ {3, {1, 2, 2}, {1, 2, 2}, {2, 2, 2}},
+};
+
+// The layout of `format`, with no planes if it is out of range.
+constexpr PlaneLayout GetPlaneLayout(int format) {
+  return format >= 0 && format < FORMAT_COUNT ? kPlaneLayouts[format]
+                                              : kPlaneLayouts[0];
+}
+
+constexpr int PlaneRows(const PlaneLayout &layout, int plane, int height) {
+  return plane < layout.planeCount
+             ? (height + layout.heightDivisor[plane] - 1) /
+                   layout.heightDivisor[plane]
+             : 0;
+}
+
+// Bytes of one tightly packed row.
+constexpr int PlaneRowBytes(const PlaneLayout &layout, int plane, int width) {
+  return plane < layout.planeCount
+             ? (width + layout.widthDivisor[plane] - 1) /
+                   layout.widthDivisor[plane] * layout.bytesPerPixel[plane]
+             : 0;
+}
+
+// Bytes of plane `plane` as the SDK lays it out. Packed RGB frames may report
+// their stride in pixels rather than bytes, so the larger of the stride and the
+// packed row is taken as the row pitch.
+constexpr int PlaneBytes(const PlaneLayout &layout, int plane, int width,
+                         int height, int stride) {
+  return PlaneRows(layout, plane, height) *
+         (stride > PlaneRowBytes(layout, plane, width)
+              ? stride
+              : PlaneRowBytes(layout, plane, width));
+}
+
+static_assert(GetPlaneLayout(media::base::VIDEO_PIXEL_NV12).planeCount == 2,
+              "NV12 is Y plus interleaved UV");
+static_assert(PlaneBytes(GetPlaneLayout(media::base::VIDEO_PIXEL_I420), 1, 641,
+                         361, 0) == 321 * 181,
+              "odd I420 sizes round chroma up");
+static_assert(PlaneBytes(GetPlaneLayout(media::base::VIDEO_PIXEL_RGBA), 0, 640,
+                         360, 640) == 640 * 4 * 360,
+              "RGBA stride in pixels");
+} // namespace pixel
+} // namespace agora
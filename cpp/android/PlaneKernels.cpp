@@ -0,0 +1,22 @@
+#include "PlaneKernels.h"
+
+#include <string.h>
+
+namespace agora {
+namespace pixel {
+void CopyPlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride,
+               int rowBytes, int rows) {
+  if (rowBytes <= 0 || rows <= 0) {
+    return;
+  }
+  if (srcStride == rowBytes && dstStride == rowBytes) {
+    memcpy(dst, src, static_cast<size_t>(rowBytes) * rows);
+    return;
+  }
+  for (int y = 0; y < rows; ++y) {
+    memcpy(dst + static_cast<size_t>(y) * dstStride,
+           src + static_cast<size_t>(y) * srcStride, rowBytes);
+  }
+}
+} // namespace pixel
+} // namespace agora
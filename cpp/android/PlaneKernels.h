@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace agora {
+// Row copies between video planes of different strides, one memcpy per row.
+// Bionic's memcpy is already vectorized for every Android ABI, so the rows are
+// left to it.
+namespace pixel {
+// Copies `rows` rows of `rowBytes` bytes from `src`, whose rows are
+// `srcStride` apart, to `dst`, whose rows are `dstStride` apart. Padding
+// beyond `rowBytes` is neither read nor written, except that planes with both
+// strides equal to `rowBytes` are copied in one go. `src` and `dst` must not
+// overlap.
+void CopyPlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride,
+               int rowBytes, int rows);
+} // namespace pixel
+} // namespace agora
@@ -0,0 +1,254 @@
+#include "PolyphaseResampler.h"
+
+#include "PcmKernels.h"
+
+#include <cmath>
+#include <mutex>
+#include <string.h>
+
+namespace agora {
+namespace {
+// ~80 dB stopband attenuation.
+const double KAISER_BETA = 8.0;
+// Fraction of the lower Nyquist frequency kept, the rest is transition band.
+const double PASSBAND = 0.94;
+
+int Gcd(int a, int b) {
+  while (b != 0) {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Zeroth order modified Bessel function of the first kind, for the window.
+double BesselI0(double x) {
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 50; ++k) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+  return sum;
+}
+
+// Preallocated room for the uids and output of UidResamplers: 17 remote
+// streams, 20 ms of 48 kHz stereo.
+const size_t EXPECTED_UIDS = 17;
+const size_t EXPECTED_OUTPUT_SAMPLES = 960 * 2 + 4;
+// How often UidResamplers looks for idle uids.
+const long long SWEEP_MS = 1000;
+} // namespace
+
+PolyphaseFilter::PolyphaseFilter(int inputRate, int outputRate,
+                                 int tapsPerPhase)
+    : inRate(inputRate), outRate(outputRate), tapsPerPhase(tapsPerPhase) {
+  const double pi = 3.14159265358979323846;
+  int gcd = Gcd(inputRate, outputRate);
+  if (gcd > 0) {
+    up = outputRate / gcd;
+    down = inputRate / gcd;
+  }
+  taps = tapsPerPhase;
+  if (down > up) {
+    taps = (tapsPerPhase * down + up - 1) / up;
+  }
+
+  int length = up * taps;
+  // Cutoff in cycles per sample at the upsampled rate.
+  double cutoff = PASSBAND * 0.5 / (up > down ? up : down);
+  double center = (length - 1) / 2.0;
+  double i0Beta = BesselI0(KAISER_BETA);
+
+  std::vector<double> prototype(length);
+  double sum = 0.0;
+  for (int n = 0; n < length; ++n) {
+    double x = n - center;
+    double sinc =
+        x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * x) / (pi * x);
+    double r = length > 1 ? 2.0 * n / (length - 1) - 1.0 : 0.0;
+    double window = BesselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) / i0Beta;
+    prototype[n] = sinc * window;
+    sum += prototype[n];
+  }
+
+  // Unity DC gain per branch on average, so the level is kept after the
+  // implicit zero stuffing.
+  double gain = sum != 0.0 ? up / sum : 0.0;
+  coefficients.resize(length);
+  for (int p = 0; p < up; ++p) {
+    for (int k = 0; k < taps; ++k) {
+      coefficients[p * taps + (taps - 1 - k)] =
+          static_cast<float>(prototype[k * up + p] * gain);
+    }
+  }
+}
+
+std::shared_ptr<const PolyphaseFilter>
+PolyphaseFilter::Get(int inputRate, int outputRate, int tapsPerPhase) {
+  // A handful of rate pairs ever occur, the cache is never trimmed.
+  static std::mutex mutex;
+  static std::vector<std::shared_ptr<const PolyphaseFilter>> cache;
+  auto find = [&]() -> std::shared_ptr<const PolyphaseFilter> {
+    for (auto &filter : cache) {
+      if (filter->inRate == inputRate && filter->outRate == outputRate &&
+          filter->tapsPerPhase == tapsPerPhase) {
+        return filter;
+      }
+    }
+    return nullptr;
+  };
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto filter = find()) {
+      return filter;
+    }
+  }
+  // Built outside the lock, so other rate pairs are not held up.
+  auto built = std::make_shared<const PolyphaseFilter>(inputRate, outputRate,
+                                                        tapsPerPhase);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto filter = find()) {
+    return filter;
+  }
+  cache.push_back(built);
+  return built;
+}
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate,
+                                       int channels, int tapsPerPhase)
+    : filter(PolyphaseFilter::Get(inputRate, outputRate, tapsPerPhase)),
+      channelCount(channels > 0 ? channels : 1) {
+  lines.resize(channelCount);
+  Reset();
+}
+
+int PolyphaseResampler::MaxOutputFrames(int inputFrames) const {
+  return static_cast<int>(static_cast<long long>(inputFrames) * filter->up /
+                          filter->down) +
+         2;
+}
+
+int PolyphaseResampler::Process(const int16_t *input, int frames,
+                                int16_t *output) {
+  const int up = filter->up;
+  const int down = filter->down;
+  const int taps = filter->taps;
+  int history = taps - 1;
+  for (int c = 0; c < channelCount; ++c) {
+    std::vector<float> &line = lines[c];
+    // Grows only when the frame size does, the history stays in front.
+    line.resize(history + frames);
+    if (channelCount == 1) {
+      pcm::Int16ToFloat(input, line.data() + history, frames);
+    } else {
+      float *out = line.data() + history;
+      for (int i = 0; i < frames; ++i) {
+        out[i] = input[i * channelCount + c] * (1.0f / 32768.0f);
+      }
+    }
+  }
+  scratch.resize(static_cast<size_t>(MaxOutputFrames(frames)) * channelCount);
+
+  int count = 0;
+  while (position < frames) {
+    const float *branch = filter->coefficients.data() + phase * taps;
+    for (int c = 0; c < channelCount; ++c) {
+      scratch[count * channelCount + c] =
+          pcm::Dot(branch, lines[c].data() + position, taps);
+    }
+    ++count;
+    phase += down;
+    position += phase / up;
+    phase %= up;
+  }
+  position -= frames;
+
+  for (int c = 0; c < channelCount; ++c) {
+    memmove(lines[c].data(), lines[c].data() + frames,
+            history * sizeof(float));
+  }
+  pcm::FloatToInt16(scratch.data(), output, count * channelCount);
+  return count;
+}
+
+void PolyphaseResampler::Reset() {
+  for (auto &line : lines) {
+    line.assign(filter->taps - 1, 0.0f);
+  }
+  phase = 0;
+  position = 0;
+}
+
+UidResamplers::UidResamplers() {
+  resamplers.reserve(EXPECTED_UIDS);
+  output.reserve(EXPECTED_OUTPUT_SAMPLES);
+}
+
+bool UidResamplers::Process(
+    rtc::uid_t uid, int outputRate,
+    const media::IAudioFrameObserverBase::AudioFrame &frame,
+    media::IAudioFrameObserverBase::AudioFrame &resampled, long long nowMs) {
+  if (frame.type != media::IAudioFrameObserverBase::FRAME_TYPE_PCM16 ||
+      !frame.buffer || frame.samplesPerChannel <= 0 || frame.channels <= 0 ||
+      frame.samplesPerSec <= 0 || outputRate <= 0 ||
+      frame.samplesPerSec == outputRate) {
+    return false;
+  }
+  if (nowMs - lastSweepMs >= SWEEP_MS) {
+    DropIdle(nowMs);
+  }
+
+  Entry *entry = nullptr;
+  for (auto &candidate : resamplers) {
+    if (candidate.uid == uid) {
+      entry = &candidate;
+      break;
+    }
+  }
+  if (!entry) {
+    resamplers.push_back({uid, nowMs, nullptr});
+    entry = &resamplers.back();
+  }
+  entry->lastSeenMs = nowMs;
+  PolyphaseResampler *resampler = entry->resampler.get();
+  if (!resampler || resampler->inputRate() != frame.samplesPerSec ||
+      resampler->outputRate() != outputRate ||
+      resampler->channels() != frame.channels) {
+    resampler = new PolyphaseResampler(frame.samplesPerSec, outputRate,
+                                       frame.channels);
+    entry->resampler.reset(resampler);
+  }
+
+  size_t samples =
+      static_cast<size_t>(resampler->MaxOutputFrames(frame.samplesPerChannel)) *
+      frame.channels;
+  if (output.size() < samples) {
+    output.resize(samples);
+  }
+  int frames = resampler->Process(static_cast<const int16_t *>(frame.buffer),
+                                  frame.samplesPerChannel, output.data());
+
+  resampled = frame;
+  resampled.buffer = output.data();
+  resampled.samplesPerChannel = frames;
+  resampled.samplesPerSec = outputRate;
+  return true;
+}
+
+void UidResamplers::DropIdle(long long nowMs) {
+  lastSweepMs = nowMs;
+  for (size_t i = 0; i < resamplers.size();) {
+    if (nowMs - resamplers[i].lastSeenMs > IDLE_MS) {
+      // Order does not matter, move the last entry into the gap.
+      resamplers[i] = std::move(resamplers.back());
+      resamplers.pop_back();
+    } else {
+      ++i;
+    }
+  }
+}
+} // namespace agora
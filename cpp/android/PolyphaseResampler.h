@@ -0,0 +1,111 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include <memory>
+#include <vector>
+
+namespace agora {
+// The Kaiser-windowed sinc of one rate pair, split into polyphase branches.
+// Immutable once built, so resamplers of every uid at the same rates share
+// one. Building takes thousands of BesselI0 evaluations for ratios like
+// 44.1 kHz to 16 kHz, which Get() does once per rate pair.
+class PolyphaseFilter {
+public:
+  PolyphaseFilter(int inputRate, int outputRate, int tapsPerPhase);
+
+  // The cached filter of a rate pair, built on first use. Call it ahead of
+  // time from a control thread to keep the build off the audio thread. Takes
+  // a lock, briefly unless the filter is built. Thread safe.
+  static std::shared_ptr<const PolyphaseFilter>
+  Get(int inputRate, int outputRate, int tapsPerPhase = 32);
+
+  const int inRate;
+  const int outRate;
+  const int tapsPerPhase;
+  int up = 1;
+  int down = 1;
+  int taps = 0;
+  // Branch p holds its taps reversed, so one contiguous dot product with the
+  // newest `taps` input samples yields an output sample.
+  std::vector<float> coefficients;
+};
+
+// Converts interleaved PCM16 between two sample rates with a Kaiser-windowed
+// sinc, split into one polyphase branch per output phase so only the taps
+// that contribute are evaluated. The ratio is reduced to up/down integers
+// L/M; the filter has `tapsPerPhase` taps per branch when upsampling, scaled
+// by M/L when downsampling so the anti-aliasing cutoff keeps its sharpness.
+// Keeps the filter history between calls, so consecutive frames join without
+// clicks. The delay is half the filter length. Not thread safe.
+class PolyphaseResampler {
+public:
+  PolyphaseResampler(int inputRate, int outputRate, int channels,
+                     int tapsPerPhase = 32);
+
+  int inputRate() const { return filter->inRate; }
+  int outputRate() const { return filter->outRate; }
+  int channels() const { return channelCount; }
+
+  // Upper bound of the frames Process() returns for `inputFrames`.
+  int MaxOutputFrames(int inputFrames) const;
+
+  // Resamples `frames` samples per channel from `input` into `output`, which
+  // must hold MaxOutputFrames(frames) * channels() samples. Returns the number
+  // of samples per channel written.
+  int Process(const int16_t *input, int frames, int16_t *output);
+
+  // Forgets the history, for a stream that restarts after a gap.
+  void Reset();
+
+private:
+  const std::shared_ptr<const PolyphaseFilter> filter;
+  const int channelCount;
+  // Per channel, `taps - 1` samples of history followed by the input frame.
+  std::vector<std::vector<float>> lines;
+  std::vector<float> scratch;
+  // Phase of the next output sample and its newest input sample, relative
+  // to the start of the current frame.
+  int phase = 0;
+  int position = 0;
+};
+
+// One resampler per remote uid, for the before-mixing position where the SDK
+// does not negotiate a rate. A resampler is replaced when the rate or channel
+// count of the uid's stream changes; the filters come from
+// PolyphaseFilter::Get, so only the per-uid history is allocated. Uids not
+// seen for IDLE_MS are dropped. Not thread safe.
+class UidResamplers {
+public:
+  enum { IDLE_MS = 5000 };
+
+  UidResamplers();
+
+  // Resamples `frame` of `uid` to `outputRate` into an internal buffer and
+  // points `resampled` at it, with the other fields copied from `frame`. The
+  // buffer stays valid until the next call. Returns false if `frame` is not
+  // PCM16 or already at `outputRate`, in which case `resampled` is untouched.
+  // `nowMs` is a monotonic clock, for dropping idle uids.
+  bool Process(rtc::uid_t uid, int outputRate,
+               const media::IAudioFrameObserverBase::AudioFrame &frame,
+               media::IAudioFrameObserverBase::AudioFrame &resampled,
+               long long nowMs);
+
+  void Clear() { resamplers.clear(); }
+  int size() const { return static_cast<int>(resamplers.size()); }
+
+private:
+  struct Entry {
+    rtc::uid_t uid;
+    long long lastSeenMs;
+    std::unique_ptr<PolyphaseResampler> resampler;
+  };
+
+  void DropIdle(long long nowMs);
+
+private:
+  std::vector<Entry> resamplers;
+  std::vector<int16_t> output;
+  long long lastSweepMs = 0;
+};
+} // namespace agora
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "include/AgoraBase.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace agora {
+// An ordered list of processing stages, each a Processor with a
+// `bool process(Frame &frame, rtc::uid_t uid)` method. Stages can be added and
+// removed from any thread while the SDK thread runs the chain. The SDK thread
+// never takes the writers' mutex, but it is not lock-free: std::atomic_load
+// and std::atomic_store of a shared_ptr go through a small pool of library
+// spinlocks, so a read can spin for the few instructions a concurrent publish
+// or an unrelated shared_ptr sharing its lock holds one. An empty chain skips
+// even that.
+template <typename Processor> class ProcessorChain {
+public:
+  ProcessorChain() : stages(std::make_shared<const Stages>()), size(0) {}
+
+  void add(std::shared_ptr<Processor> processor) {
+    if (!processor) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<Stages>(*std::atomic_load(&stages));
+    next->push_back(std::move(processor));
+    Publish(next);
+  }
+
+  void remove(const std::shared_ptr<Processor> &processor) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<Stages>();
+    for (auto &stage : *std::atomic_load(&stages)) {
+      if (stage != processor) {
+        next->push_back(stage);
+      }
+    }
+    Publish(next);
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Publish(std::make_shared<const Stages>());
+  }
+
+  bool empty() const { return size.load(std::memory_order_acquire) == 0; }
+
+  // Runs every stage in order, returns false as soon as one stage does.
+  template <typename Frame> bool process(Frame &frame, rtc::uid_t uid) {
+    if (empty()) {
+      return true;
+    }
+    // Holding the snapshot keeps removed stages alive until this call
+    // returns.
+    std::shared_ptr<const Stages> snapshot = std::atomic_load(&stages);
+    for (auto &stage : *snapshot) {
+      if (!stage->process(frame, uid)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  typedef std::vector<std::shared_ptr<Processor>> Stages;
+
+  void Publish(std::shared_ptr<const Stages> next) {
+    size.store(static_cast<int>(next->size()), std::memory_order_release);
+    std::atomic_store(&stages, std::move(next));
+  }
+
+private:
+  // Copy-on-write, read with std::atomic_load and replaced as a whole.
+  std::shared_ptr<const Stages> stages;
+  std::atomic<int> size;
+  std::mutex writeMutex;
+};
+} // namespace agora
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+
+namespace agora {
+// Index bookkeeping for a lock-free single-producer/single-consumer ring. The
+// storage lives with the caller, the ring only hands out slot indices. Exactly
+// one thread may call the producer side and one thread the consumer side.
+class SpscRing {
+public:
+  // `capacity` is rounded up to a power of two.
+  explicit SpscRing(unsigned capacity) : mask(RoundUp(capacity) - 1) {}
+
+  unsigned capacity() const { return mask + 1; }
+
+  unsigned size() const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+
+  // Producer. Returns false when the ring is full, otherwise `index` is the
+  // slot to fill before calling EndWrite().
+  bool BeginWrite(unsigned &index) const {
+    unsigned h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+      return false;
+    }
+    index = h & mask;
+    return true;
+  }
+
+  // Publishes the slot returned by BeginWrite(), returns the new size.
+  unsigned EndWrite() {
+    unsigned h = head.load(std::memory_order_relaxed) + 1;
+    head.store(h, std::memory_order_release);
+    return h - tail.load(std::memory_order_relaxed);
+  }
+
+  // Consumer. Returns false when the ring is empty, otherwise `index` is the
+  // oldest slot, which stays valid until EndRead().
+  bool BeginRead(unsigned &index) const {
+    unsigned t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    index = t & mask;
+    return true;
+  }
+
+  void EndRead() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+  }
+
+private:
+  static unsigned RoundUp(unsigned value) {
+    unsigned result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+private:
+  const unsigned mask;
+  // Kept on separate cache lines, head is written by the producer only and
+  // tail by the consumer only.
+  std::atomic<unsigned> head{0};
+  char padding[64 - sizeof(std::atomic<unsigned>)];
+  std::atomic<unsigned> tail{0};
+};
+} // namespace agora
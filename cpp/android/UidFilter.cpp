@@ -0,0 +1,87 @@
+#include "UidFilter.h"
+
+namespace agora {
+FlatUidSet::FlatUidSet(const rtc::uid_t *uids, int count) {
+  unsigned capacity = 2;
+  while (capacity < static_cast<unsigned>(count) * 2) {
+    capacity <<= 1;
+  }
+  slots.assign(capacity, 0);
+  mask = capacity - 1;
+  for (int i = 0; i < count; ++i) {
+    rtc::uid_t uid = uids[i];
+    if (uid == 0) {
+      this->count += hasZero ? 0 : 1;
+      hasZero = true;
+      continue;
+    }
+    unsigned index = Hash(uid) & mask;
+    while (slots[index] != 0 && slots[index] != uid) {
+      index = (index + 1) & mask;
+    }
+    if (slots[index] == 0) {
+      slots[index] = uid;
+      ++this->count;
+    }
+  }
+}
+
+bool FlatUidSet::contains(rtc::uid_t uid) const {
+  if (uid == 0) {
+    return hasZero;
+  }
+  if (slots.empty()) {
+    return false;
+  }
+  unsigned index = Hash(uid) & mask;
+  while (slots[index] != 0) {
+    if (slots[index] == uid) {
+      return true;
+    }
+    index = (index + 1) & mask;
+  }
+  return false;
+}
+
+unsigned FlatUidSet::Hash(rtc::uid_t uid) {
+  // Uids are often small and sequential, mix the bits before masking.
+  unsigned h = uid;
+  h ^= h >> 16;
+  h *= 0x45d9f3bu;
+  h ^= h >> 16;
+  return h;
+}
+
+UidFilter::UidFilter() : lists(std::make_shared<const Lists>()), active(false) {}
+
+void UidFilter::set(const rtc::uid_t *allow, int allowCount,
+                    const rtc::uid_t *deny, int denyCount) {
+  auto next = std::make_shared<Lists>();
+  next->hasAllow = allowCount >= 0;
+  if (allowCount > 0) {
+    next->allow = FlatUidSet(allow, allowCount);
+  }
+  if (denyCount > 0) {
+    next->deny = FlatUidSet(deny, denyCount);
+  }
+  bool isActive = next->hasAllow || !next->deny.empty();
+  std::atomic_store(&lists, std::shared_ptr<const Lists>(std::move(next)));
+  active.store(isActive, std::memory_order_release);
+}
+
+void UidFilter::clear() {
+  active.store(false, std::memory_order_release);
+  std::atomic_store(&lists, std::make_shared<const Lists>());
+}
+
+bool UidFilter::accepts(rtc::uid_t uid) const {
+  if (!active.load(std::memory_order_acquire)) {
+    return true;
+  }
+  std::shared_ptr<const Lists> snapshot = std::atomic_load(&lists);
+  if (snapshot->hasAllow && !snapshot->allow.contains(uid)) {
+    return false;
+  }
+  return !snapshot->deny.contains(uid);
+}
+} // namespace agora
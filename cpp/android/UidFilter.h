@@ -0,0 +1,60 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace agora {
+// An immutable open-addressing hash set of uids, sized to a power of two at
+// least twice the element count so probes stay short.
+class FlatUidSet {
+public:
+  FlatUidSet() {}
+  FlatUidSet(const rtc::uid_t *uids, int count);
+
+  bool empty() const { return count == 0; }
+  bool contains(rtc::uid_t uid) const;
+
+private:
+  static unsigned Hash(rtc::uid_t uid);
+
+private:
+  // 0 marks a free slot, a uid of 0 is tracked by `hasZero` instead.
+  std::vector<rtc::uid_t> slots;
+  unsigned mask = 0;
+  int count = 0;
+  bool hasZero = false;
+};
+
+// Decides which remote uids reach the before-mixing callback. With an
+// allow-list only listed uids pass, uids on the deny-list never pass. Both
+// lists are replaced together from any thread. The SDK thread only loads the
+// lists and does a hash lookup, or nothing while no list is set; the
+// std::atomic_load of the shared_ptr may spin briefly on a library lock.
+class UidFilter {
+public:
+  UidFilter();
+
+  // A negative `allowCount` means there is no allow-list, every uid that is
+  // not denied passes. An empty allow-list lets nothing pass.
+  void set(const rtc::uid_t *allow, int allowCount, const rtc::uid_t *deny,
+           int denyCount);
+  void clear();
+
+  bool accepts(rtc::uid_t uid) const;
+
+private:
+  struct Lists {
+    bool hasAllow = false;
+    FlatUidSet allow;
+    FlatUidSet deny;
+  };
+
+private:
+  // Copy-on-write, read with std::atomic_load and replaced as a whole.
+  std::shared_ptr<const Lists> lists;
+  std::atomic<bool> active;
+};
+} // namespace agora
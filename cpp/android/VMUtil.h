@@ -6,6 +6,7 @@
 #include <assert.h>
 
 #include <android/log.h>
+#include <atomic>
 #include <pthread.h>
 
 #define LOGD(...)                                                              \
@@ -25,30 +26,56 @@
     return rValue;                                                             \
   }
 
-class AttachThreadScoped {
+// Number of times a native thread was attached to / detached from the Java VM
+// by AttachCurrentThreadOnce. In steady state both stay flat.
+inline std::atomic<long long> &AttachThreadCount() {
+  static std::atomic<long long> count(0);
+  return count;
+}
+
+inline std::atomic<long long> &DetachThreadCount() {
+  static std::atomic<long long> count(0);
+  return count;
+}
+
+inline void DetachThreadOnExit(void *value) {
+  JavaVM *jvm = static_cast<JavaVM *>(value);
+  if (jvm && jvm->DetachCurrentThread() >= 0) {
+    ++DetachThreadCount();
+  }
+}
+
+inline pthread_key_t AttachThreadKey() {
+  static pthread_key_t key;
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once, [] { pthread_key_create(&key, DetachThreadOnExit); });
+  return key;
+}
+
+// Attaches the calling thread to the Java VM the first time it is needed and
+// keeps it attached until the thread exits, where the pthread key destructor
+// detaches it. SDK callback threads therefore pay the attach cost only once.
+// Nothing is detached when an instance goes out of scope.
+class AttachCurrentThreadOnce {
 public:
-  explicit AttachThreadScoped(JavaVM *jvm)
-      : attached_(false), jvm_(jvm), env_(nullptr) {
+  explicit AttachCurrentThreadOnce(JavaVM *jvm) : jvm_(jvm), env_(nullptr) {
     jint ret_val =
         jvm->GetEnv(reinterpret_cast<void **>(&env_), JNI_VERSION_1_6);
     if (ret_val == JNI_EDETACHED) {
       // Attach the thread to the Java VM.
       ret_val = jvm_->AttachCurrentThread(&env_, nullptr);
-      attached_ = ret_val >= 0;
-      assert(attached_);
-    }
-  }
-
-  ~AttachThreadScoped() {
-    if (attached_ && (jvm_->DetachCurrentThread() < 0)) {
-      assert(false);
+      bool attached = ret_val >= 0;
+      assert(attached);
+      if (attached) {
+        ++AttachThreadCount();
+        pthread_setspecific(AttachThreadKey(), jvm_);
+      }
     }
   }
 
   JNIEnv *env() { return env_; }
 
 private:
-  bool attached_;
   JavaVM *jvm_;
   JNIEnv *env_;
 };
@@ -1,11 +1,23 @@
 #include "VideoFrameObserver.h"
 
+#include "PlaneKernels.h"
 #include "VMUtil.h"
 
+#include <string.h>
+#include <string>
+
 namespace agora {
 VideoFrameObserver::VideoFrameObserver(JNIEnv *env, jobject jCaller,
-                                       long long engineHandle)
-    : jCallerRef(env->NewGlobalRef(jCaller)), engineHandle(engineHandle) {
+                                       long long engineHandle, int bufferType,
+                                       int planeMode,
+                                       const Preferences &preferences)
+    : jCallerRef(env->NewGlobalRef(jCaller)), bufferType(bufferType),
+      planeMode(planeMode),
+      formatPreference(preferences.formatPreference),
+      rotationApplied(preferences.rotationApplied),
+      mirrorApplied(preferences.mirrorApplied),
+      observedFramePosition(preferences.observedFramePosition),
+      engineHandle(engineHandle) {
   jclass jCallerClass = env->GetObjectClass(jCallerRef);
   jOnCaptureVideoFrame =
       env->GetMethodID(jCallerClass, "onCaptureVideoFrame",
@@ -16,14 +28,6 @@ VideoFrameObserver::VideoFrameObserver(JNIEnv *env, jobject jCaller,
   jOnPreEncodeVideoFrame =
       env->GetMethodID(jCallerClass, "onPreEncodeVideoFrame",
                        "(ILio/agora/rtc/rawdata/base/VideoFrame;)Z");
-  jGetVideoFormatPreference = env->GetMethodID(
-      jCallerClass, "getVideoFormatPreference",
-      "()Lio/agora/rtc/rawdata/base/VideoFrame$VideoFrameType;");
-  jGetRotationApplied =
-      env->GetMethodID(jCallerClass, "getRotationApplied", "()Z");
-  jGetMirrorApplied = env->GetMethodID(jCallerClass, "getMirrorApplied", "()Z");
-  jGetObservedFramePosition =
-      env->GetMethodID(jCallerClass, "getObservedFramePosition", "()I");
 
   env->DeleteLocalRef(jCallerClass);
 
@@ -31,6 +35,32 @@ VideoFrameObserver::VideoFrameObserver(JNIEnv *env, jobject jCaller,
   jVideoFrameClass = (jclass)env->NewGlobalRef(jVideoFrame);
   jVideoFrameInit =
       env->GetMethodID(jVideoFrameClass, "<init>", "(IIIIII[B[B[BIJI)V");
+  jVideoFrameType =
+      env->GetFieldID(jVideoFrameClass, "type",
+                      "Lio/agora/rtc/rawdata/base/VideoFrame$VideoFrameType;");
+  jVideoFrameWidth = env->GetFieldID(jVideoFrameClass, "width", "I");
+  jVideoFrameHeight = env->GetFieldID(jVideoFrameClass, "height", "I");
+  const char *planeNames[PLANE_COUNT] = {"y", "u", "v"};
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    std::string name(planeNames[i]);
+    jVideoFrameStride[i] =
+        env->GetFieldID(jVideoFrameClass, (name + "Stride").c_str(), "I");
+    jVideoFrameBuffer[i] =
+        env->GetFieldID(jVideoFrameClass, (name + "Buffer").c_str(), "[B");
+    jVideoFrameByteBuffer[i] =
+        env->GetFieldID(jVideoFrameClass, (name + "ByteBuffer").c_str(),
+                        "Ljava/nio/ByteBuffer;");
+    jVideoFrameOffset[i] =
+        env->GetFieldID(jVideoFrameClass, (name + "Offset").c_str(), "I");
+    jVideoFrameLength[i] =
+        env->GetFieldID(jVideoFrameClass, (name + "Length").c_str(), "I");
+  }
+  jVideoFrameContiguousBuffer = env->GetFieldID(
+      jVideoFrameClass, "contiguousBuffer", "Ljava/nio/ByteBuffer;");
+  jVideoFrameRotation = env->GetFieldID(jVideoFrameClass, "rotation", "I");
+  jVideoFrameRenderTimeMs =
+      env->GetFieldID(jVideoFrameClass, "renderTimeMs", "J");
+  jVideoFrameAvsyncType = env->GetFieldID(jVideoFrameClass, "avsync_type", "I");
   env->DeleteLocalRef(jVideoFrame);
 
   jclass videoFrameType =
@@ -39,217 +69,423 @@ VideoFrameObserver::VideoFrameObserver(JNIEnv *env, jobject jCaller,
   jGetValue = env->GetMethodID(jVideoFrameTypeClass, "getValue", "()I");
   env->DeleteLocalRef(videoFrameType);
 
+  // Map every VideoFrameType constant to its VIDEO_PIXEL_FORMAT value once, so
+  // the type field can be set without calling into Java per frame.
+  jmethodID jValues = env->GetStaticMethodID(
+      jVideoFrameTypeClass, "values",
+      "()[Lio/agora/rtc/rawdata/base/VideoFrame$VideoFrameType;");
+  jobjectArray jTypes = static_cast<jobjectArray>(
+      env->CallStaticObjectMethod(jVideoFrameTypeClass, jValues));
+  for (int i = 0; i < env->GetArrayLength(jTypes); ++i) {
+    jobject jType = env->GetObjectArrayElement(jTypes, i);
+    jint value = env->CallIntMethod(jType, jGetValue);
+    if (value >= 0 && value < pixel::FORMAT_COUNT) {
+      jVideoFrameTypes[value] = env->NewGlobalRef(jType);
+    }
+    env->DeleteLocalRef(jType);
+  }
+  env->DeleteLocalRef(jTypes);
+
   env->GetJavaVM(&jvm);
 
-  auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
-  if (rtcEngine) {
-    util::AutoPtr<media::IMediaEngine> mediaEngine;
-    mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
-    if (mediaEngine) {
-      mediaEngine->registerVideoFrameObserver(this);
+  RegisterWithMediaEngine(this);
+}
+
+VideoFrameObserver::~VideoFrameObserver() {
+  RegisterWithMediaEngine(nullptr);
+
+  AttachCurrentThreadOnce attach(jvm);
+
+  attach.env()->DeleteGlobalRef(jCallerRef);
+  jOnCaptureVideoFrame = nullptr;
+  jOnRenderVideoFrame = nullptr;
+  jOnPreEncodeVideoFrame = nullptr;
+
+  for (auto &entry : slots) {
+    ReleaseSlot(attach.env(), *entry.second);
+  }
+  slots.clear();
+
+  attach.env()->DeleteGlobalRef(jVideoFrameClass);
+  jVideoFrameInit = nullptr;
+
+  for (auto &jType : jVideoFrameTypes) {
+    if (jType) {
+      attach.env()->DeleteGlobalRef(jType);
+      jType = nullptr;
     }
   }
+  attach.env()->DeleteGlobalRef(jVideoFrameTypeClass);
+  jGetValue = nullptr;
+}
+
+void VideoFrameObserver::setPreferences(const Preferences &preferences) {
+  // Every field is exchanged, a short-circuit would skip the later ones.
+  bool changed = false;
+  changed |= formatPreference.exchange(preferences.formatPreference) !=
+             preferences.formatPreference;
+  changed |= rotationApplied.exchange(preferences.rotationApplied) !=
+             preferences.rotationApplied;
+  changed |= mirrorApplied.exchange(preferences.mirrorApplied) !=
+             preferences.mirrorApplied;
+  changed |= observedFramePosition.exchange(
+                 preferences.observedFramePosition) !=
+             preferences.observedFramePosition;
+  if (changed) {
+    // Registering again makes the SDK query the preferences.
+    RegisterWithMediaEngine(this);
+  }
 }
 
-VideoFrameObserver::~VideoFrameObserver() {
+void VideoFrameObserver::RegisterWithMediaEngine(
+    media::IVideoFrameObserver *observer) {
   auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
   if (rtcEngine) {
     util::AutoPtr<media::IMediaEngine> mediaEngine;
     mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
     if (mediaEngine) {
-      mediaEngine->registerVideoFrameObserver(nullptr);
+      mediaEngine->registerVideoFrameObserver(observer);
     }
   }
+}
 
-  AttachThreadScoped ats(jvm);
+int VideoFrameObserver::PositionIndex(int position) {
+  if (position <= 0 || (position & (position - 1)) != 0) {
+    return -1;
+  }
+  int index = __builtin_ctz(position);
+  return index < POSITION_INDEX_COUNT ? index : -1;
+}
 
-  ats.env()->DeleteGlobalRef(jCallerRef);
-  jOnCaptureVideoFrame = nullptr;
-  jOnRenderVideoFrame = nullptr;
-  jOnPreEncodeVideoFrame = nullptr;
-  jGetVideoFormatPreference = nullptr;
-  jGetRotationApplied = nullptr;
-  jGetMirrorApplied = nullptr;
-  jGetObservedFramePosition = nullptr;
+void VideoFrameObserver::addVideoProcessor(
+    int position, std::shared_ptr<IVideoProcessor> processor) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].add(std::move(processor));
+  }
+}
 
-  ats.env()->DeleteGlobalRef(jVideoFrameClass);
-  jVideoFrameInit = nullptr;
+void VideoFrameObserver::removeVideoProcessor(
+    int position, const std::shared_ptr<IVideoProcessor> &processor) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].remove(processor);
+  }
+}
 
-  ats.env()->DeleteGlobalRef(jVideoFrameTypeClass);
-  jGetValue = nullptr;
+void VideoFrameObserver::clearVideoProcessors(int position) {
+  int index = PositionIndex(position);
+  if (index >= 0) {
+    processorChains[index].clear();
+  }
 }
 
-bool VideoFrameObserver::onCaptureVideoFrame(agora::rtc::VIDEO_SOURCE_TYPE type,
-                                             VideoFrame &videoFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  std::vector<jbyteArray> arr = NativeToJavaByteArray(env, videoFrame);
-  jobject obj = NativeToJavaVideoFrame(env, videoFrame, arr);
-  jboolean ret =
-      env->CallBooleanMethod(jCallerRef, jOnCaptureVideoFrame, type, obj);
-  for (int i = 0; i < arr.size(); ++i) {
-    jbyteArray jByteArray = arr[i];
-    void *buffer = nullptr;
-    if (i == 0) {
-      buffer = videoFrame.yBuffer;
-    } else if (i == 1) {
-      buffer = videoFrame.uBuffer;
-    } else if (i == 2) {
-      buffer = videoFrame.vBuffer;
+bool VideoFrameObserver::ProcessNatively(POSITION_INDEX position,
+                                         rtc::uid_t uid,
+                                         VideoFrame &videoFrame,
+                                         bool &toJava) {
+  toJava = false;
+  if (!processorChains[position].process(videoFrame, uid)) {
+    return false;
+  }
+  toJava = (nativeOnlyPositions.load(std::memory_order_relaxed) &
+            (1 << position)) == 0;
+  return true;
+}
+
+VideoFrameObserver::ScopedSlot::ScopedSlot(VideoFrameObserver &observer,
+                                           JNIEnv *env,
+                                           POSITION_INDEX position,
+                                           rtc::uid_t uid)
+    : observer(observer) {
+  {
+    std::lock_guard<std::mutex> lock(observer.slotsMutex);
+    std::unique_ptr<JavaFrameSlot> &entry =
+        observer.slots[SlotKey(position, uid)];
+    if (!entry) {
+      entry.reset(new JavaFrameSlot());
+      // Fields are updated in place for every frame of the stream.
+      jobject jFrame = env->NewObject(
+          observer.jVideoFrameClass, observer.jVideoFrameInit,
+          (int)media::base::VIDEO_PIXEL_I420, 0, 0, 0, 0, 0, nullptr, nullptr,
+          nullptr, 0, (jlong)0, 0);
+      entry->jFrame = env->NewGlobalRef(jFrame);
+      env->DeleteLocalRef(jFrame);
+    }
+    slot = entry.get();
+    ++slot->users;
+    slot->lastUse = ++observer.slotUseCounter;
+
+    // Drop the least recently used idle slots, from uids that left.
+    while (observer.slots.size() > MAX_SLOTS) {
+      auto victim = observer.slots.end();
+      for (auto it = observer.slots.begin(); it != observer.slots.end();
+           ++it) {
+        if (it->second->users == 0 &&
+            (victim == observer.slots.end() ||
+             it->second->lastUse < victim->second->lastUse)) {
+          victim = it;
+        }
+      }
+      if (victim == observer.slots.end()) {
+        break;
+      }
+      observer.ReleaseSlot(env, *victim->second);
+      observer.slots.erase(victim);
     }
-    env->GetByteArrayRegion(jByteArray, 0, env->GetArrayLength(jByteArray),
-                            static_cast<jbyte *>(buffer));
-    env->DeleteLocalRef(jByteArray);
   }
-  env->DeleteLocalRef(obj);
+  slot->mutex.lock();
+}
+
+VideoFrameObserver::ScopedSlot::~ScopedSlot() {
+  slot->mutex.unlock();
+  std::lock_guard<std::mutex> lock(observer.slotsMutex);
+  --slot->users;
+}
+
+void VideoFrameObserver::ReleaseSlot(JNIEnv *env, JavaFrameSlot &slot) {
+  env->DeleteGlobalRef(slot.jFrame);
+  slot.jFrame = nullptr;
+  slot.bufferPool.Release(env);
+}
+
+bool VideoFrameObserver::CallJavaObserver(POSITION_INDEX position,
+                                          rtc::uid_t uid, jmethodID method,
+                                          jint arg, VideoFrame &videoFrame) {
+  AttachCurrentThreadOnce attach(jvm);
+  JNIEnv *env = attach.env();
+  ScopedSlot scopedSlot(*this, env, position, uid);
+  JavaFrameSlot &slot = scopedSlot.get();
+  jobject obj = NativeToJavaVideoFrame(env, slot, videoFrame);
+  if (!obj) {
+    return true;
+  }
+  jboolean ret = env->CallBooleanMethod(jCallerRef, method, arg, obj);
+  JavaToNativeBuffer(env, slot, videoFrame);
   return ret;
 }
 
+bool VideoFrameObserver::onCaptureVideoFrame(agora::rtc::VIDEO_SOURCE_TYPE type,
+                                             VideoFrame &videoFrame) {
+  bool toJava;
+  if (!ProcessNatively(POSITION_INDEX_POST_CAPTURER, 0, videoFrame, toJava)) {
+    return false;
+  }
+  if (!toJava) {
+    return true;
+  }
+  return CallJavaObserver(POSITION_INDEX_POST_CAPTURER, 0,
+                          jOnCaptureVideoFrame, type, videoFrame);
+}
+
 bool VideoFrameObserver::onRenderVideoFrame(const char *channelId,
                                             rtc::uid_t remoteUid,
                                             VideoFrame &videoFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  std::vector<jbyteArray> arr = NativeToJavaByteArray(env, videoFrame);
-  jobject obj = NativeToJavaVideoFrame(env, videoFrame, arr);
-  jboolean ret =
-      env->CallBooleanMethod(jCallerRef, jOnRenderVideoFrame, remoteUid, obj);
-  for (int i = 0; i < arr.size(); ++i) {
-    jbyteArray jByteArray = arr[i];
-    void *buffer = nullptr;
-    if (i == 0) {
-      buffer = videoFrame.yBuffer;
-    } else if (i == 1) {
-      buffer = videoFrame.uBuffer;
-    } else if (i == 2) {
-      buffer = videoFrame.vBuffer;
-    }
-    env->GetByteArrayRegion(jByteArray, 0, env->GetArrayLength(jByteArray),
-                            static_cast<jbyte *>(buffer));
-    env->DeleteLocalRef(jByteArray);
+  bool toJava;
+  if (!ProcessNatively(POSITION_INDEX_PRE_RENDERER, remoteUid, videoFrame,
+                       toJava)) {
+    return false;
   }
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!toJava) {
+    return true;
+  }
+  return CallJavaObserver(POSITION_INDEX_PRE_RENDERER, remoteUid,
+                          jOnRenderVideoFrame, remoteUid, videoFrame);
 }
 
 bool VideoFrameObserver::onPreEncodeVideoFrame(
     agora::rtc::VIDEO_SOURCE_TYPE type, VideoFrame &videoFrame) {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  std::vector<jbyteArray> arr = NativeToJavaByteArray(env, videoFrame);
-  jobject obj = NativeToJavaVideoFrame(env, videoFrame, arr);
-  jboolean ret =
-      env->CallBooleanMethod(jCallerRef, jOnPreEncodeVideoFrame, type, obj);
-  for (int i = 0; i < arr.size(); ++i) {
-    jbyteArray jByteArray = arr[i];
-    void *buffer = nullptr;
-    if (i == 0) {
-      buffer = videoFrame.yBuffer;
-    } else if (i == 1) {
-      buffer = videoFrame.uBuffer;
-    } else if (i == 2) {
-      buffer = videoFrame.vBuffer;
-    }
-    env->GetByteArrayRegion(jByteArray, 0, env->GetArrayLength(jByteArray),
-                            static_cast<jbyte *>(buffer));
-    env->DeleteLocalRef(jByteArray);
+  bool toJava;
+  if (!ProcessNatively(POSITION_INDEX_PRE_ENCODER, 0, videoFrame, toJava)) {
+    return false;
   }
-  env->DeleteLocalRef(obj);
-  return ret;
+  if (!toJava) {
+    return true;
+  }
+  return CallJavaObserver(POSITION_INDEX_PRE_ENCODER, 0,
+                          jOnPreEncodeVideoFrame, type, videoFrame);
 }
 
 media::base::VIDEO_PIXEL_FORMAT VideoFrameObserver::getVideoFormatPreference() {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jobject obj = env->CallObjectMethod(jCallerRef, jGetVideoFormatPreference);
-  jint ret = env->CallIntMethod(obj, jGetValue);
-  env->DeleteLocalRef(obj);
-  return (media::base::VIDEO_PIXEL_FORMAT)ret;
+  return static_cast<media::base::VIDEO_PIXEL_FORMAT>(
+      formatPreference.load(std::memory_order_relaxed));
 }
 
 bool VideoFrameObserver::getRotationApplied() {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jboolean ret = env->CallBooleanMethod(jCallerRef, jGetRotationApplied);
-  return ret;
+  return rotationApplied.load(std::memory_order_relaxed);
 }
 
 bool VideoFrameObserver::getMirrorApplied() {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jboolean ret = env->CallBooleanMethod(jCallerRef, jGetMirrorApplied);
-  return ret;
+  return mirrorApplied.load(std::memory_order_relaxed);
 }
 
 uint32_t VideoFrameObserver::getObservedFramePosition() {
-  AttachThreadScoped ats(jvm);
-  JNIEnv *env = ats.env();
-  jint ret = env->CallIntMethod(jCallerRef, jGetObservedFramePosition);
-  return ret;
+  return observedFramePosition.load(std::memory_order_relaxed);
 }
 
-std::vector<jbyteArray>
-VideoFrameObserver::NativeToJavaByteArray(JNIEnv *env, VideoFrame &videoFrame) {
-  int yLength, uLength, vLength;
-  switch (videoFrame.type) {
-  case agora::media::base::VIDEO_PIXEL_FORMAT::VIDEO_PIXEL_I420: {
-    yLength = videoFrame.yStride * videoFrame.height;
-    uLength = videoFrame.uStride * videoFrame.height / 2;
-    vLength = videoFrame.vStride * videoFrame.height / 2;
-    break;
-  }
-  case agora::media::base::VIDEO_PIXEL_FORMAT::VIDEO_PIXEL_I422: {
-    yLength = videoFrame.yStride * videoFrame.height;
-    uLength = videoFrame.uStride * videoFrame.height;
-    vLength = videoFrame.vStride * videoFrame.height;
-    break;
-  }
-  case agora::media::base::VIDEO_PIXEL_FORMAT::VIDEO_PIXEL_RGBA: {
-    yLength = videoFrame.width * videoFrame.height * 4;
-    uLength = 0;
-    vLength = 0;
-    break;
+void VideoFrameObserver::GetPlaneCopies(VideoFrame &videoFrame,
+                                        PlaneCopy (&copies)[PLANE_COUNT]) {
+  const pixel::PlaneLayout layout = pixel::GetPlaneLayout(videoFrame.type);
+  uint8_t *planes[PLANE_COUNT] = {videoFrame.yBuffer, videoFrame.uBuffer,
+                                  videoFrame.vBuffer};
+  int strides[PLANE_COUNT] = {videoFrame.yStride, videoFrame.uStride,
+                              videoFrame.vStride};
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    PlaneCopy &copy = copies[i];
+    int rowBytes = pixel::PlaneRowBytes(layout, i, videoFrame.width);
+    copy.sdk = planes[i];
+    copy.sdkPitch = strides[i] > rowBytes ? strides[i] : rowBytes;
+    copy.rows = planes[i] && rowBytes > 0
+                    ? pixel::PlaneRows(layout, i, videoFrame.height)
+                    : 0;
+    // Strided copies take the padding along, so rows stay where the SDK
+    // stride says.
+    copy.rowBytes = planeMode == PLANE_MODE_PACKED ? rowBytes : copy.sdkPitch;
+    copy.pitch = copy.rowBytes;
   }
+}
+
+void VideoFrameObserver::NativeToJavaBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                                            VideoFrame &videoFrame) {
+  GetPlaneCopies(videoFrame, slot.copies);
+
+  if (bufferType == BUFFER_TYPE_CONTIGUOUS) {
+    int total = 0;
+    for (int i = 0; i < PLANE_COUNT; ++i) {
+      slot.jBuffer[i] = nullptr;
+      int length = slot.copies[i].length();
+      slot.offsets[i] = length > 0 ? total : -1;
+      total = AlignedBufferPool::Align(total + length);
+    }
+    slot.block = slot.blockPool.Acquire(total);
+    if (!slot.block.data) {
+      LOGE("VideoFrameObserver: failed to allocate %d bytes", total);
+      return;
+    }
+    for (int i = 0; i < PLANE_COUNT; ++i) {
+      const PlaneCopy &copy = slot.copies[i];
+      // Absent planes have offset -1, not even a pointer may be formed.
+      if (copy.rows == 0 || slot.offsets[i] < 0) {
+        continue;
+      }
+      pixel::CopyPlane(copy.sdk, copy.sdkPitch,
+                       slot.block.data + slot.offsets[i], copy.pitch,
+                       copy.rowBytes, copy.rows);
+    }
+    // Keyed by block address and capacity, so a recycled block reuses its
+    // ByteBuffer.
+    slot.jBuffer[0] = slot.bufferPool.DirectByteBuffer(env, slot.block.data,
+                                                       slot.block.capacity);
+    return;
   }
 
-  std::vector<jbyteArray> vector;
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    slot.jBuffer[i] = nullptr;
+    const PlaneCopy &copy = slot.copies[i];
+    if (copy.length() <= 0) {
+      continue;
+    }
+    if (bufferType == BUFFER_TYPE_DIRECT_BYTE_BUFFER) {
+      // Aliases the SDK plane, always with its stride.
+      slot.jBuffer[i] = slot.bufferPool.DirectByteBuffer(
+          env, copy.sdk, copy.rows * copy.sdkPitch);
+    } else {
+      // Tagged by plane, U and V often have the same length.
+      jbyteArray jByteArray =
+          slot.bufferPool.ByteArray(env, copy.length(), i);
+      void *array = env->GetPrimitiveArrayCritical(jByteArray, nullptr);
+      pixel::CopyPlane(copy.sdk, copy.sdkPitch, static_cast<uint8_t *>(array),
+                       copy.pitch, copy.rowBytes, copy.rows);
+      env->ReleasePrimitiveArrayCritical(jByteArray, array, 0);
+      slot.jBuffer[i] = jByteArray;
+    }
+  }
+}
 
-  if (videoFrame.yBuffer && yLength > 0) {
-    jbyteArray jYArray = env->NewByteArray(yLength);
-    env->SetByteArrayRegion(
-        jYArray, 0, yLength,
-        reinterpret_cast<const jbyte *>(videoFrame.yBuffer));
-    vector.push_back(jYArray);
+void VideoFrameObserver::JavaToNativeBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                                            VideoFrame &videoFrame) {
+  // The direct buffers alias the SDK planes, Java already wrote in place.
+  if (bufferType == BUFFER_TYPE_DIRECT_BYTE_BUFFER) {
+    return;
   }
-  if (videoFrame.uBuffer && uLength > 0) {
-    jbyteArray jUArray = env->NewByteArray(uLength);
-    env->SetByteArrayRegion(
-        jUArray, 0, uLength,
-        reinterpret_cast<const jbyte *>(videoFrame.uBuffer));
-    vector.push_back(jUArray);
+  if (bufferType == BUFFER_TYPE_CONTIGUOUS) {
+    if (!slot.block.data) {
+      return;
+    }
+    for (int i = 0; i < PLANE_COUNT; ++i) {
+      const PlaneCopy &copy = slot.copies[i];
+      if (copy.rows == 0 || slot.offsets[i] < 0) {
+        continue;
+      }
+      pixel::CopyPlane(slot.block.data + slot.offsets[i], copy.pitch,
+                       copy.sdk, copy.sdkPitch, copy.rowBytes, copy.rows);
+    }
+    slot.blockPool.Recycle(slot.block);
+    slot.block = {nullptr, 0};
+    return;
   }
-  if (videoFrame.vBuffer && vLength > 0) {
-    jbyteArray jVArray = env->NewByteArray(vLength);
-    env->SetByteArrayRegion(
-        jVArray, 0, vLength,
-        reinterpret_cast<const jbyte *>(videoFrame.vBuffer));
-    vector.push_back(jVArray);
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    if (!slot.jBuffer[i]) {
+      continue;
+    }
+    const PlaneCopy &copy = slot.copies[i];
+    jbyteArray jByteArray = static_cast<jbyteArray>(slot.jBuffer[i]);
+    void *array = env->GetPrimitiveArrayCritical(jByteArray, nullptr);
+    pixel::CopyPlane(static_cast<const uint8_t *>(array), copy.pitch,
+                     copy.sdk, copy.sdkPitch, copy.rowBytes, copy.rows);
+    // Only read, nothing to commit back to the array.
+    env->ReleasePrimitiveArrayCritical(jByteArray, array, JNI_ABORT);
   }
-
-  return vector;
 }
 
 jobject VideoFrameObserver::NativeToJavaVideoFrame(
-    JNIEnv *env, media::IVideoFrameObserver::VideoFrame &videoFrame,
-    std::vector<jbyteArray> jByteArray) {
-  jbyteArray jYArray = jByteArray[0];
-  jbyteArray jUArray = jByteArray[1];
-  jbyteArray jVArray = jByteArray[2];
-  return env->NewObject(jVideoFrameClass, jVideoFrameInit, (int)videoFrame.type,
-                        videoFrame.width, videoFrame.height, videoFrame.yStride,
-                        videoFrame.uStride, videoFrame.vStride, jYArray,
-                        jUArray, jVArray, videoFrame.rotation,
-                        videoFrame.renderTimeMs, videoFrame.avsync_type);
+    JNIEnv *env, JavaFrameSlot &slot,
+    media::IVideoFrameObserver::VideoFrame &videoFrame) {
+  if (pixel::GetPlaneLayout(videoFrame.type).planeCount == 0 ||
+      !jVideoFrameTypes[videoFrame.type]) {
+    LOGE("VideoFrameObserver: unsupported video pixel format %d",
+         videoFrame.type);
+    return nullptr;
+  }
+
+  NativeToJavaBuffer(env, slot, videoFrame);
+  if (bufferType == BUFFER_TYPE_CONTIGUOUS && !slot.block.data) {
+    return nullptr;
+  }
+
+  jobject obj = slot.jFrame;
+  // Planes the format does not have are null with a zero stride, whatever the
+  // SDK left in the unused fields.
+  const int planeCount = pixel::GetPlaneLayout(videoFrame.type).planeCount;
+  int strides[PLANE_COUNT] = {videoFrame.yStride, videoFrame.uStride,
+                              videoFrame.vStride};
+  jfieldID *jBufferFields = bufferType == BUFFER_TYPE_DIRECT_BYTE_BUFFER
+                                ? jVideoFrameByteBuffer
+                                : jVideoFrameBuffer;
+  env->SetObjectField(obj, jVideoFrameType, jVideoFrameTypes[videoFrame.type]);
+  env->SetIntField(obj, jVideoFrameWidth, videoFrame.width);
+  env->SetIntField(obj, jVideoFrameHeight, videoFrame.height);
+  const bool contiguous = bufferType == BUFFER_TYPE_CONTIGUOUS;
+  // Packed planes report their row size as the stride.
+  const bool packed = planeMode == PLANE_MODE_PACKED &&
+                      bufferType != BUFFER_TYPE_DIRECT_BYTE_BUFFER;
+  if (contiguous) {
+    env->SetObjectField(obj, jVideoFrameContiguousBuffer, slot.jBuffer[0]);
+  }
+  for (int i = 0; i < PLANE_COUNT; ++i) {
+    int stride = packed ? slot.copies[i].pitch : strides[i];
+    env->SetIntField(obj, jVideoFrameStride[i], i < planeCount ? stride : 0);
+    if (contiguous) {
+      env->SetIntField(obj, jVideoFrameOffset[i], slot.offsets[i]);
+      env->SetIntField(obj, jVideoFrameLength[i], slot.copies[i].length());
+    } else {
+      env->SetObjectField(obj, jBufferFields[i], slot.jBuffer[i]);
+    }
+  }
+  env->SetIntField(obj, jVideoFrameRotation, videoFrame.rotation);
+  env->SetLongField(obj, jVideoFrameRenderTimeMs, videoFrame.renderTimeMs);
+  env->SetIntField(obj, jVideoFrameAvsyncType, videoFrame.avsync_type);
+  return obj;
 }
 
 bool VideoFrameObserver::onMediaPlayerVideoFrame(
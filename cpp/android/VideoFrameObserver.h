@@ -4,16 +4,91 @@
 #include "include/IAgoraMediaEngine.h"
 #include "include/IAgoraRtcEngine.h"
 
+#include "AlignedBufferPool.h"
+#include "JavaBufferPool.h"
+#include "PixelFormatLayout.h"
+#include "VideoProcessor.h"
+
 #include <jni.h>
-#include <vector>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace agora {
 class VideoFrameObserver : public media::IVideoFrameObserver {
 public:
-  VideoFrameObserver(JNIEnv *env, jobject jCaller, long long EngineHandle);
+  // Must match IVideoFrameObserver.BUFFER_TYPE_* on the Java side.
+  enum BUFFER_TYPE {
+    // Planes are copied into byte[]s and copied back after the Java call.
+    BUFFER_TYPE_BYTE_ARRAY = 0,
+    // Planes are wrapped by direct ByteBuffers, valid only for the callback.
+    BUFFER_TYPE_DIRECT_BYTE_BUFFER = 1,
+    // Planes are copied into one pooled 64-byte-aligned native block, each
+    // plane starting on a 64-byte boundary, wrapped by one direct ByteBuffer
+    // and copied back after the Java call.
+    BUFFER_TYPE_CONTIGUOUS = 2,
+  };
+
+  // Must match IVideoFrameObserver.PLANE_MODE_* on the Java side. Ignored with
+  // BUFFER_TYPE_DIRECT_BYTE_BUFFER, which always aliases the SDK planes.
+  enum PLANE_MODE {
+    // Rows are copied with the SDK stride, padding included, so a plane can
+    // be copied back in one go.
+    PLANE_MODE_STRIDED = 0,
+    // Rows are packed to their visible width, the reported stride is the row
+    // size. Padding is never copied.
+    PLANE_MODE_PACKED = 1,
+  };
+
+  // Index of each VIDEO_MODULE_POSITION bit, for per-position state.
+  enum POSITION_INDEX {
+    POSITION_INDEX_POST_CAPTURER = 0,
+    POSITION_INDEX_PRE_RENDERER = 1,
+    POSITION_INDEX_PRE_ENCODER = 2,
+    POSITION_INDEX_COUNT = 3,
+  };
+
+  enum { PLANE_COUNT = pixel::MAX_PLANES };
+
+  // What the SDK queries through the get* overrides below. Held natively so
+  // those queries never attach to the JVM or call into Java.
+  struct Preferences {
+    media::base::VIDEO_PIXEL_FORMAT formatPreference =
+        media::base::VIDEO_PIXEL_I420;
+    bool rotationApplied = false;
+    bool mirrorApplied = false;
+    // VIDEO_MODULE_POSITION bits.
+    uint32_t observedFramePosition = media::base::POSITION_POST_CAPTURER |
+                                     media::base::POSITION_PRE_RENDERER;
+  };
+
+public:
+  VideoFrameObserver(JNIEnv *env, jobject jCaller, long long EngineHandle,
+                     int bufferType, int planeMode,
+                     const Preferences &preferences);
 
   virtual ~VideoFrameObserver();
 
+  // Registers again if anything changed, so the SDK queries the new values.
+  void setPreferences(const Preferences &preferences);
+
+  // Attaches native stages to one VIDEO_MODULE_POSITION. They run in order on
+  // the SDK planes inside the callback, before the Java observer if there is
+  // one.
+  void addVideoProcessor(int position,
+                         std::shared_ptr<IVideoProcessor> processor);
+  void removeVideoProcessor(int position,
+                            const std::shared_ptr<IVideoProcessor> &processor);
+  void clearVideoProcessors(int position);
+
+  // VIDEO_MODULE_POSITION bits whose frames only go through the native
+  // processors and never reach Java.
+  void setNativeOnlyPositions(int positions) {
+    nativeOnlyPositions.store(positions, std::memory_order_relaxed);
+  }
+
 public:
   bool onCaptureVideoFrame(agora::rtc::VIDEO_SOURCE_TYPE type,
                            VideoFrame &videoFrame) override;
@@ -40,11 +115,90 @@ public:
   uint32_t getObservedFramePosition() override;
 
 private:
-  std::vector<jbyteArray> NativeToJavaByteArray(JNIEnv *env,
-                                                VideoFrame &videoFrame);
-
-  jobject NativeToJavaVideoFrame(JNIEnv *env, VideoFrame &videoFrame,
-                                 std::vector<jbyteArray> jByteArray);
+  // How one plane travels between the SDK and Java.
+  struct PlaneCopy {
+    uint8_t *sdk = nullptr;
+    // Bytes between SDK rows and between the rows handed to Java.
+    int sdkPitch = 0;
+    int pitch = 0;
+    int rowBytes = 0;
+    int rows = 0;
+
+    int length() const { return pitch * rows; }
+  };
+
+  // The Java frame object and plane buffers reused by one stream: a position,
+  // and for the pre-renderer one remote uid, since the SDK makes no promise
+  // about which thread calls back for which uid. Held through ScopedSlot.
+  struct JavaFrameSlot {
+    std::mutex mutex;
+    // Callbacks holding or waiting for the slot, guarded by slotsMutex. Only
+    // unused slots are evicted.
+    int users = 0;
+    unsigned long long lastUse = 0;
+    jobject jFrame = nullptr;
+    jobject jBuffer[PLANE_COUNT] = {nullptr, nullptr, nullptr};
+    // Room for a resolution change times three planes, or the few SDK
+    // buffers a direct stream rotates through.
+    JavaBufferPool bufferPool{12};
+    // BUFFER_TYPE_CONTIGUOUS only, the block of the frame in flight and where
+    // each plane sits in it.
+    AlignedBufferPool blockPool;
+    AlignedBufferPool::Block block = {nullptr, 0};
+    int offsets[PLANE_COUNT] = {0, 0, 0};
+    // The planes of the frame in flight.
+    PlaneCopy copies[PLANE_COUNT];
+  };
+
+  // Finds or creates the slot of a stream and locks it for one callback.
+  class ScopedSlot {
+  public:
+    ScopedSlot(VideoFrameObserver &observer, JNIEnv *env,
+               POSITION_INDEX position, rtc::uid_t uid);
+    ~ScopedSlot();
+
+    JavaFrameSlot &get() { return *slot; }
+
+  private:
+    VideoFrameObserver &observer;
+    JavaFrameSlot *slot;
+  };
+
+  // Slots kept at most. Beyond that the least recently used idle ones go, so
+  // remote uids that left do not hold Java buffers forever.
+  enum { MAX_SLOTS = 16 };
+
+  static unsigned long long SlotKey(POSITION_INDEX position, rtc::uid_t uid) {
+    return static_cast<unsigned long long>(position) << 32 | uid;
+  }
+
+  void ReleaseSlot(JNIEnv *env, JavaFrameSlot &slot);
+
+  // Hands `videoFrame` to `method` of the Java observer with `arg` as its
+  // first argument, then copies the planes back.
+  bool CallJavaObserver(POSITION_INDEX position, rtc::uid_t uid,
+                        jmethodID method, jint arg, VideoFrame &videoFrame);
+
+  void GetPlaneCopies(VideoFrame &videoFrame,
+                      PlaneCopy (&copies)[PLANE_COUNT]);
+
+  void NativeToJavaBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                          VideoFrame &videoFrame);
+
+  void JavaToNativeBuffer(JNIEnv *env, JavaFrameSlot &slot,
+                          VideoFrame &videoFrame);
+
+  jobject NativeToJavaVideoFrame(JNIEnv *env, JavaFrameSlot &slot,
+                                 VideoFrame &videoFrame);
+
+  void RegisterWithMediaEngine(media::IVideoFrameObserver *observer);
+
+  static int PositionIndex(int position);
+
+  // Runs the native chain of `position`. Sets `toJava` when the frame should
+  // still be handed to the Java observer.
+  bool ProcessNatively(POSITION_INDEX position, rtc::uid_t uid,
+                       VideoFrame &videoFrame, bool &toJava);
 
 private:
   JavaVM *jvm = nullptr;
@@ -53,16 +207,42 @@ private:
   jmethodID jOnCaptureVideoFrame;
   jmethodID jOnRenderVideoFrame;
   jmethodID jOnPreEncodeVideoFrame;
-  jmethodID jGetVideoFormatPreference;
-  jmethodID jGetRotationApplied;
-  jmethodID jGetMirrorApplied;
-  jmethodID jGetObservedFramePosition;
 
   jclass jVideoFrameClass;
   jmethodID jVideoFrameInit;
+  jfieldID jVideoFrameType;
+  jfieldID jVideoFrameWidth;
+  jfieldID jVideoFrameHeight;
+  jfieldID jVideoFrameStride[PLANE_COUNT];
+  jfieldID jVideoFrameBuffer[PLANE_COUNT];
+  jfieldID jVideoFrameByteBuffer[PLANE_COUNT];
+  jfieldID jVideoFrameOffset[PLANE_COUNT];
+  jfieldID jVideoFrameLength[PLANE_COUNT];
+  jfieldID jVideoFrameContiguousBuffer;
+  jfieldID jVideoFrameRotation;
+  jfieldID jVideoFrameRenderTimeMs;
+  jfieldID jVideoFrameAvsyncType;
 
   jclass jVideoFrameTypeClass;
   jmethodID jGetValue;
+  // VideoFrameType constants indexed by VIDEO_PIXEL_FORMAT, null when Java has
+  // no matching constant.
+  jobject jVideoFrameTypes[pixel::FORMAT_COUNT] = {};
+
+  const int bufferType;
+  const int planeMode;
+  std::mutex slotsMutex;
+  // Keyed by SlotKey().
+  std::unordered_map<unsigned long long, std::unique_ptr<JavaFrameSlot>> slots;
+  unsigned long long slotUseCounter = 0;
+
+  std::atomic<int> formatPreference;
+  std::atomic<bool> rotationApplied;
+  std::atomic<bool> mirrorApplied;
+  std::atomic<uint32_t> observedFramePosition;
+
+  VideoProcessorChain processorChains[POSITION_INDEX_COUNT];
+  std::atomic<int> nativeOnlyPositions{0};
 
   long long engineHandle;
 };
@@ -0,0 +1,138 @@
+#include "VideoProcessor.h"
+
+#include "PixelFormatLayout.h"
+
+#include <string.h>
+
+namespace agora {
+namespace {
+inline int Clamp(int value, int low, int high) {
+  return value < low ? low : value > high ? high : value;
+}
+
+inline int Pitch(int stride, int rowBytes) {
+  return stride > rowBytes ? stride : rowBytes;
+}
+
+double Param(const std::map<std::string, double> &params, const char *key,
+             double fallback) {
+  auto it = params.find(key);
+  return it != params.end() ? it->second : fallback;
+}
+
+void FillPlane8(uint8_t *plane, int stride, int rowBytes, int rows,
+                uint8_t value) {
+  for (int y = 0; y < rows; ++y) {
+    memset(plane + static_cast<size_t>(y) * stride, value, rowBytes);
+  }
+}
+
+void FillPlane16(uint8_t *plane, int stride, int samples, int rows,
+                 uint16_t value) {
+  for (int y = 0; y < rows; ++y) {
+    uint16_t *row =
+        reinterpret_cast<uint16_t *>(plane + static_cast<size_t>(y) * stride);
+    for (int x = 0; x < samples; ++x) {
+      row[x] = value;
+    }
+  }
+}
+} // namespace
+
+bool FillChromaVideoProcessor::process(media::base::VideoFrame &videoFrame,
+                                       rtc::uid_t /* uid */) {
+  const pixel::PlaneLayout layout = pixel::GetPlaneLayout(videoFrame.type);
+  const int uValue = Clamp(u.load(std::memory_order_relaxed), 0, 255);
+  const int vValue = Clamp(v.load(std::memory_order_relaxed), 0, 255);
+  const int rows = pixel::PlaneRows(layout, 1, videoFrame.height);
+  const int rowBytes = pixel::PlaneRowBytes(layout, 1, videoFrame.width);
+
+  switch (videoFrame.type) {
+  case media::base::VIDEO_PIXEL_I420:
+  case media::base::VIDEO_PIXEL_I422:
+    if (videoFrame.uBuffer && videoFrame.vBuffer) {
+      FillPlane8(videoFrame.uBuffer, Pitch(videoFrame.uStride, rowBytes),
+                 rowBytes, rows, static_cast<uint8_t>(uValue));
+      FillPlane8(videoFrame.vBuffer, Pitch(videoFrame.vStride, rowBytes),
+                 rowBytes, rows, static_cast<uint8_t>(vValue));
+    }
+    break;
+  case media::base::VIDEO_PIXEL_I010:
+    if (videoFrame.uBuffer && videoFrame.vBuffer) {
+      FillPlane16(videoFrame.uBuffer, Pitch(videoFrame.uStride, rowBytes),
+                  rowBytes / 2, rows, static_cast<uint16_t>(uValue << 2));
+      FillPlane16(videoFrame.vBuffer, Pitch(videoFrame.vStride, rowBytes),
+                  rowBytes / 2, rows, static_cast<uint16_t>(vValue << 2));
+    }
+    break;
+  case media::base::VIDEO_PIXEL_NV12:
+  case media::base::VIDEO_PIXEL_NV21:
+    if (videoFrame.uBuffer) {
+      // One interleaved plane, V first for NV21. Filling it as 16-bit pairs
+      // relies on the little-endian byte order of every Android ABI.
+      uint8_t first = static_cast<uint8_t>(
+          videoFrame.type == media::base::VIDEO_PIXEL_NV12 ? uValue : vValue);
+      uint8_t second = static_cast<uint8_t>(
+          videoFrame.type == media::base::VIDEO_PIXEL_NV12 ? vValue : uValue);
+      FillPlane16(videoFrame.uBuffer, Pitch(videoFrame.uStride, rowBytes),
+                  rowBytes / 2, rows,
+                  static_cast<uint16_t>(first | second << 8));
+    }
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+bool LumaOffsetVideoProcessor::process(media::base::VideoFrame &videoFrame,
+                                       rtc::uid_t /* uid */) {
+  const int value = offset.load(std::memory_order_relaxed);
+  const pixel::PlaneLayout layout = pixel::GetPlaneLayout(videoFrame.type);
+  if (value == 0 || layout.planeCount < 2 || !videoFrame.yBuffer) {
+    return true;
+  }
+  const int rows = pixel::PlaneRows(layout, 0, videoFrame.height);
+  const int rowBytes = pixel::PlaneRowBytes(layout, 0, videoFrame.width);
+  const int pitch = Pitch(videoFrame.yStride, rowBytes);
+
+  if (layout.bytesPerPixel[0] == 2) {
+    const int scaled = value << 2;
+    for (int y = 0; y < rows; ++y) {
+      uint16_t *row = reinterpret_cast<uint16_t *>(
+          videoFrame.yBuffer + static_cast<size_t>(y) * pitch);
+      for (int x = 0; x < rowBytes / 2; ++x) {
+        row[x] = static_cast<uint16_t>(Clamp(row[x] + scaled, 0, 1023));
+      }
+    }
+    return true;
+  }
+  // A lookup table keeps the inner loop branch-free.
+  uint8_t table[256];
+  for (int i = 0; i < 256; ++i) {
+    table[i] = static_cast<uint8_t>(Clamp(i + value, 0, 255));
+  }
+  for (int y = 0; y < rows; ++y) {
+    uint8_t *row = videoFrame.yBuffer + static_cast<size_t>(y) * pitch;
+    for (int x = 0; x < rowBytes; ++x) {
+      row[x] = table[row[x]];
+    }
+  }
+  return true;
+}
+
+std::shared_ptr<IVideoProcessor>
+CreateVideoProcessor(const std::string &name,
+                     const std::map<std::string, double> &params) {
+  if (name == "fillChroma") {
+    return std::make_shared<FillChromaVideoProcessor>(
+        static_cast<int>(Param(params, "u", 128)),
+        static_cast<int>(Param(params, "v", 128)));
+  }
+  if (name == "lumaOffset") {
+    return std::make_shared<LumaOffsetVideoProcessor>(
+        static_cast<int>(Param(params, "offset", 0)));
+  }
+  return nullptr;
+}
+} // namespace agora
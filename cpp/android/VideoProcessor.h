@@ -0,0 +1,72 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include "ProcessorChain.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace agora {
+// A native processing stage run by VideoFrameObserver inside the SDK video
+// callback, before anything crosses into Java.
+class IVideoProcessor {
+public:
+  virtual ~IVideoProcessor() {}
+
+  // Edits the planes of videoFrame in place. `uid` is the remote user for the
+  // pre-renderer position and 0 otherwise. Returning false stops the chain
+  // and the observer callback returns false to the SDK.
+  //
+  // Runs on the SDK video thread: do not block, allocate or take locks that
+  // other threads hold for long.
+  virtual bool process(media::base::VideoFrame &videoFrame,
+                       rtc::uid_t uid) = 0;
+};
+
+// The IVideoProcessor stages run at one position.
+typedef ProcessorChain<IVideoProcessor> VideoProcessorChain;
+
+// Sets every chroma sample to (u, v), 128 for both turns the frame gray.
+// Handles I420, I422, NV12, NV21 and I010, other formats pass unchanged.
+class FillChromaVideoProcessor : public IVideoProcessor {
+public:
+  FillChromaVideoProcessor(int u = 128, int v = 128) : u(u), v(v) {}
+
+  void setChroma(int uValue, int vValue) {
+    u.store(uValue, std::memory_order_relaxed);
+    v.store(vValue, std::memory_order_relaxed);
+  }
+
+  bool process(media::base::VideoFrame &videoFrame, rtc::uid_t uid) override;
+
+private:
+  std::atomic<int> u;
+  std::atomic<int> v;
+};
+
+// Adds `offset` to every luma sample with saturation, a cheap brightness
+// control. Handles I420, I422, NV12, NV21 and I010.
+class LumaOffsetVideoProcessor : public IVideoProcessor {
+public:
+  explicit LumaOffsetVideoProcessor(int offset = 0) : offset(offset) {}
+
+  void setOffset(int value) { offset.store(value, std::memory_order_relaxed); }
+
+  bool process(media::base::VideoFrame &videoFrame, rtc::uid_t uid) override;
+
+private:
+  std::atomic<int> offset;
+};
+
+// Creates a built-in stage from its name and parameters, so the chain can be
+// configured from Dart. Values are in 8-bit units, I010 scales them.
+//   "fillChroma": u, v (default 128)
+//   "lumaOffset": offset (default 0)
+// Returns null for unknown names.
+std::shared_ptr<IVideoProcessor>
+CreateVideoProcessor(const std::string &name,
+                     const std::map<std::string, double> &params);
+} // namespace agora
@@ -0,0 +1,157 @@
+#include "VoiceActivityDetector.h"
+
+#include "PcmKernels.h"
+
+#include <cmath>
+
+namespace agora {
+VoiceActivityDetector::VoiceActivityDetector()
+    : VoiceActivityDetector(Config()) {}
+
+VoiceActivityDetector::VoiceActivityDetector(const Config &config)
+    : config(config) {
+  states.reserve(32);
+}
+
+VoiceActivityDetector::EVENT VoiceActivityDetector::Process(
+    rtc::uid_t uid, const media::IAudioFrameObserverBase::AudioFrame &frame,
+    bool &speaking) {
+  State &state = StateOf(uid);
+  Features features = Analyze(frame);
+  bool speech = features.dbfs > config.energyThresholdDbfs &&
+                features.flatness < config.flatnessThreshold &&
+                features.zeroCrossingRate < config.zeroCrossingMax;
+
+  EVENT event = EVENT_NONE;
+  if (speech == state.speaking) {
+    state.run = 0;
+  } else if (++state.run >=
+             (state.speaking ? config.hangoverFrames : config.startFrames)) {
+    state.speaking = speech;
+    state.run = 0;
+    event = speech ? EVENT_SPEECH_START : EVENT_SPEECH_END;
+  }
+  speaking = state.speaking;
+  return event;
+}
+
+VoiceActivityDetector::Features VoiceActivityDetector::Analyze(
+    const media::IAudioFrameObserverBase::AudioFrame &frame) {
+  Features features = {-100.0f, 0.0f, 1.0f};
+  int channels = frame.channels > 0 ? frame.channels : 1;
+  int count = frame.samplesPerChannel;
+  if (frame.type != media::IAudioFrameObserverBase::FRAME_TYPE_PCM16 ||
+      !frame.buffer || count <= 1) {
+    return features;
+  }
+  const int16_t *samples = static_cast<const int16_t *>(frame.buffer);
+
+  pcm::Level level = pcm::Measure(samples, count * channels);
+  double rms = std::sqrt(level.sumOfSquares / (count * channels)) / 32768.0;
+  if (rms > 0.0) {
+    features.dbfs = static_cast<float>(20.0 * std::log10(rms));
+  }
+
+  int crossings = 0;
+  for (int i = 1; i < count; ++i) {
+    crossings +=
+        (samples[i * channels] >= 0) != (samples[(i - 1) * channels] >= 0);
+  }
+  features.zeroCrossingRate = static_cast<float>(crossings) / (count - 1);
+
+  // Only worth the FFT when the cheaper features have not decided already.
+  if (features.dbfs > config.energyThresholdDbfs) {
+    int size = 1;
+    while (size * 2 <= count && size * 2 <= MAX_FFT_SIZE) {
+      size *= 2;
+    }
+    if (size >= 64) {
+      features.flatness = SpectralFlatness(samples, channels, size);
+    }
+  }
+  return features;
+}
+
+VoiceActivityDetector::State &VoiceActivityDetector::StateOf(rtc::uid_t uid) {
+  for (auto &state : states) {
+    if (state.uid == uid) {
+      return state;
+    }
+  }
+  states.push_back({uid, false, 0});
+  return states.back();
+}
+
+float VoiceActivityDetector::SpectralFlatness(const int16_t *samples,
+                                              int stride, int size) {
+  PrepareFft(size);
+  for (int i = 0; i < size; ++i) {
+    re[bitReverse[i]] = samples[i * stride] * window[i];
+    im[bitReverse[i]] = 0.0f;
+  }
+  // Iterative radix-2 FFT, twiddles indexed by the stride into the table.
+  for (int length = 2; length <= size; length <<= 1) {
+    int half = length / 2;
+    int step = size / length;
+    for (int start = 0; start < size; start += length) {
+      for (int k = 0; k < half; ++k) {
+        float c = cosTable[k * step];
+        float s = sinTable[k * step];
+        int a = start + k;
+        int b = a + half;
+        float tr = re[b] * c + im[b] * s;
+        float ti = im[b] * c - re[b] * s;
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+      }
+    }
+  }
+
+  // Geometric over arithmetic mean of the power spectrum, DC excluded.
+  const double floor = 1e-3;
+  double logSum = 0.0, sum = 0.0;
+  int bins = size / 2;
+  for (int k = 1; k <= bins; ++k) {
+    double power = static_cast<double>(re[k]) * re[k] +
+                   static_cast<double>(im[k]) * im[k] + floor;
+    logSum += std::log(power);
+    sum += power;
+  }
+  return static_cast<float>(std::exp(logSum / bins) / (sum / bins));
+}
+
+void VoiceActivityDetector::PrepareFft(int size) {
+  if (size == fftSize) {
+    return;
+  }
+  fftSize = size;
+  window.resize(size);
+  cosTable.resize(size / 2);
+  sinTable.resize(size / 2);
+  bitReverse.resize(size);
+  re.resize(size);
+  im.resize(size);
+
+  const double pi = 3.14159265358979323846;
+  for (int i = 0; i < size; ++i) {
+    window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / size));
+  }
+  for (int k = 0; k < size / 2; ++k) {
+    cosTable[k] = static_cast<float>(std::cos(2.0 * pi * k / size));
+    sinTable[k] = static_cast<float>(std::sin(2.0 * pi * k / size));
+  }
+  int bits = 0;
+  while ((1 << bits) < size) {
+    ++bits;
+  }
+  for (int i = 0; i < size; ++i) {
+    int reversed = 0;
+    for (int b = 0; b < bits; ++b) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    bitReverse[i] = reversed;
+  }
+}
+} // namespace agora
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "include/AgoraMediaBase.h"
+
+#include <vector>
+
+namespace agora {
+// Classifies PCM16 frames as speech or not from three cheap features: energy,
+// zero-crossing rate and spectral flatness. A state change needs
+// `startFrames` speech frames in a row to begin and `hangoverFrames`
+// non-speech frames to end, so short pauses do not split an utterance. Keeps
+// one state per uid. Not thread safe, use one detector per SDK thread.
+class VoiceActivityDetector {
+public:
+  struct Config {
+    // Frames quieter than this are never speech.
+    float energyThresholdDbfs = -45.0f;
+    // Voiced speech has a peaky spectrum, noise is close to 1.
+    float flatnessThreshold = 0.45f;
+    // Fraction of adjacent samples changing sign, fricatives stay below it,
+    // hiss does not.
+    float zeroCrossingMax = 0.4f;
+    int startFrames = 3;
+    int hangoverFrames = 30;
+  };
+
+  struct Features {
+    float dbfs;
+    float zeroCrossingRate;
+    float flatness;
+  };
+
+  enum EVENT {
+    EVENT_NONE = 0,
+    EVENT_SPEECH_START = 1,
+    EVENT_SPEECH_END = 2,
+  };
+
+public:
+  VoiceActivityDetector();
+  explicit VoiceActivityDetector(const Config &config);
+
+  // Feeds one frame of `uid`. `speaking` receives the state after the frame,
+  // the return value says whether it just changed.
+  EVENT Process(rtc::uid_t uid,
+                const media::IAudioFrameObserverBase::AudioFrame &frame,
+                bool &speaking);
+
+  // The features of the first channel of `frame`, exposed for tuning.
+  Features Analyze(const media::IAudioFrameObserverBase::AudioFrame &frame);
+
+private:
+  struct State {
+    rtc::uid_t uid;
+    bool speaking;
+    // Consecutive frames disagreeing with `speaking`.
+    int run;
+  };
+
+  // Largest FFT used for the flatness, 512 points is ~10 ms at 48 kHz.
+  enum { MAX_FFT_SIZE = 512 };
+
+  State &StateOf(rtc::uid_t uid);
+  float SpectralFlatness(const int16_t *samples, int stride, int size);
+  void PrepareFft(int size);
+
+private:
+  const Config config;
+  std::vector<State> states;
+
+  // Scratch for SpectralFlatness, rebuilt when the frame size changes.
+  int fftSize = 0;
+  std::vector<float> window;
+  std::vector<float> cosTable;
+  std::vector<float> sinTable;
+  std::vector<int> bitReverse;
+  std::vector<float> re;
+  std::vector<float> im;
+};
+} // namespace agora
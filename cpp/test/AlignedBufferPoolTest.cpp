@@ -0,0 +1,122 @@
+#include "AlignedBufferPool.h"
+
+#include "TestUtil.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const int FRAMES = 10000;
+
+// Bytes of an I420 frame laid out as BUFFER_TYPE_CONTIGUOUS does, each plane
+// starting on an ALIGNMENT boundary.
+int ContiguousI420(int width, int height) {
+  int y = width * height;
+  int uv = (width + 1) / 2 * ((height + 1) / 2);
+  return AlignedBufferPool::Align(
+      AlignedBufferPool::Align(AlignedBufferPool::Align(y) + uv) + uv);
+}
+
+void TestAlign() {
+  CHECK_EQ(0, AlignedBufferPool::Align(0));
+  CHECK_EQ(64, AlignedBufferPool::Align(1));
+  CHECK_EQ(64, AlignedBufferPool::Align(64));
+  CHECK_EQ(128, AlignedBufferPool::Align(65));
+}
+
+void TestSizeClasses() {
+  CHECK_EQ(0, AlignedBufferPool::SizeClass(1));
+  CHECK_EQ(0, AlignedBufferPool::SizeClass(AlignedBufferPool::MIN_BLOCK));
+  CHECK_EQ(AlignedBufferPool::MIN_BLOCK, AlignedBufferPool::ClassCapacity(0));
+  // Four classes per doubling: 5, 6, 7 and 8 KiB above 4 KiB.
+  CHECK_EQ(5120, AlignedBufferPool::ClassCapacity(
+                     AlignedBufferPool::SizeClass(4097)));
+  CHECK_EQ(5120, AlignedBufferPool::ClassCapacity(
+                     AlignedBufferPool::SizeClass(5120)));
+  CHECK_EQ(6144, AlignedBufferPool::ClassCapacity(
+                     AlignedBufferPool::SizeClass(5121)));
+  CHECK_EQ(8192, AlignedBufferPool::ClassCapacity(
+                     AlignedBufferPool::SizeClass(8192)));
+
+  int previous = 0;
+  for (int size = 1; size <= 8 << 20; size += 997) {
+    int capacity =
+        AlignedBufferPool::ClassCapacity(AlignedBufferPool::SizeClass(size));
+    CHECK(capacity >= size);
+    CHECK(capacity >= previous);
+    // At most a quarter of a block is slack.
+    CHECK(size <= AlignedBufferPool::MIN_BLOCK ||
+          capacity - size < capacity / 4);
+    previous = capacity;
+  }
+}
+
+void TestAcquireIsAligned() {
+  AlignedBufferPool pool;
+  const int sizes[] = {1, 100, 4096, 4097, 1 << 20, ContiguousI420(641, 361)};
+  for (int size : sizes) {
+    AlignedBufferPool::Block block = pool.Acquire(size);
+    CHECK(block.data != nullptr);
+    CHECK(block.capacity >= size);
+    CHECK(reinterpret_cast<uintptr_t>(block.data) %
+              AlignedBufferPool::ALIGNMENT ==
+          0);
+    // Every byte up to the capacity is usable.
+    block.data[block.capacity - 1] = 1;
+    pool.Recycle(block);
+  }
+  // A null block from a failed Acquire() is ignored.
+  pool.Recycle(AlignedBufferPool::Block{nullptr, 0});
+}
+
+void TestMixedFramesStayFlat() {
+  AlignedBufferPool pool;
+  // Remote streams at three resolutions, plus a 720p one whose odd height
+  // makes it a few bytes larger but keeps it in the same size class.
+  const int sizes[] = {ContiguousI420(640, 360), ContiguousI420(1280, 720),
+                       ContiguousI420(1920, 1080), ContiguousI420(1280, 721)};
+  for (int i = 0; i < FRAMES; ++i) {
+    AlignedBufferPool::Block block = pool.Acquire(sizes[i % 4]);
+    CHECK(block.capacity >= sizes[i % 4]);
+    pool.Recycle(block);
+  }
+  CHECK_EQ(3, pool.allocations());
+
+  // Blocks held across callbacks are distinct.
+  AlignedBufferPool::Block a = pool.Acquire(sizes[1]);
+  AlignedBufferPool::Block b = pool.Acquire(sizes[1]);
+  CHECK(a.data != b.data);
+  CHECK_EQ(4, pool.allocations());
+  pool.Recycle(a);
+  pool.Recycle(b);
+}
+
+void TestEvictsLeastRecentlyUsed() {
+  AlignedBufferPool pool(2);
+  AlignedBufferPool::Block small = pool.Acquire(4096);
+  AlignedBufferPool::Block medium = pool.Acquire(8192);
+  AlignedBufferPool::Block large = pool.Acquire(16384);
+  pool.Recycle(small);
+  pool.Recycle(medium);
+  // The pool is full, the small block was recycled longest ago and goes.
+  pool.Recycle(large);
+  CHECK_EQ(3, pool.allocations());
+  pool.Recycle(pool.Acquire(8192));
+  pool.Recycle(pool.Acquire(16384));
+  CHECK_EQ(3, pool.allocations());
+  pool.Recycle(pool.Acquire(4096));
+  CHECK_EQ(4, pool.allocations());
+}
+} // namespace
+
+int main() {
+  TestAlign();
+  TestSizeClasses();
+  TestAcquireIsAligned();
+  TestMixedFramesStayFlat();
+  TestEvictsLeastRecentlyUsed();
+  return test::Result("AlignedBufferPoolTest");
+}
@@ -0,0 +1,162 @@
+#include "AsyncAudioDelivery.h"
+
+#include "TestUtil.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef AsyncAudioDelivery::AudioFrame AudioFrame;
+
+struct Delivered {
+  int ring;
+  rtc::uid_t uid;
+  int samplesPerChannel;
+  std::vector<int16_t> pcm;
+};
+
+// Collects what the consumer thread hands over. While `paused`, the consumer
+// blocks on its first frame so the rings can be filled up.
+class Collector {
+public:
+  AsyncAudioDelivery::Consumer consumer() {
+    return [this](int ring, rtc::uid_t uid, AudioFrame &frame) {
+      std::unique_lock<std::mutex> lock(mutex);
+      resumed.wait(lock, [this] { return !paused; });
+      const int16_t *pcm = static_cast<const int16_t *>(frame.buffer);
+      Delivered delivered = {
+          ring, uid, frame.samplesPerChannel,
+          std::vector<int16_t>(pcm, pcm + frame.samplesPerChannel *
+                                              frame.channels)};
+      frames.push_back(std::move(delivered));
+      arrived.notify_all();
+    };
+  }
+
+  void Pause() {
+    std::lock_guard<std::mutex> lock(mutex);
+    paused = true;
+  }
+
+  void Resume() {
+    std::lock_guard<std::mutex> lock(mutex);
+    paused = false;
+    resumed.notify_all();
+  }
+
+  std::vector<Delivered> WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    arrived.wait(lock, [&] { return frames.size() >= count; });
+    return frames;
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable arrived;
+  std::condition_variable resumed;
+  bool paused = false;
+  std::vector<Delivered> frames;
+};
+
+// `samples` per channel of stereo PCM16, sample i of the frame is seed + i.
+struct Frame {
+  Frame(int samples, int seed) : pcm(samples * 2) {
+    for (size_t i = 0; i < pcm.size(); ++i) {
+      pcm[i] = static_cast<int16_t>(seed + i);
+    }
+    frame.samplesPerChannel = samples;
+    frame.channels = 2;
+    frame.samplesPerSec = 48000;
+    frame.buffer = pcm.data();
+  }
+
+  std::vector<int16_t> pcm;
+  AudioFrame frame;
+};
+
+void TestDeliversInOrder() {
+  Collector collector;
+  AsyncAudioDelivery delivery(2, 8, nullptr, collector.consumer());
+  CHECK_EQ(8, delivery.capacity());
+  for (int i = 0; i < 100; ++i) {
+    Frame frame(480, i);
+    // Waits for every frame, so the ring never fills up.
+    CHECK(delivery.Push(i % 2, 1000 + i, frame.frame));
+    std::vector<Delivered> frames = collector.WaitFor(i + 1);
+    CHECK_EQ(i % 2, frames[i].ring);
+    CHECK(frames[i].uid == static_cast<rtc::uid_t>(1000 + i));
+    CHECK(frames[i].pcm == frame.pcm);
+  }
+  CHECK_EQ(50, delivery.GetStats(0).delivered);
+  CHECK_EQ(0, delivery.GetStats(1).dropped);
+}
+
+void TestLargeFrames() {
+  Collector collector;
+  // Ring 1 is sized for 1024-sample stereo frames up front, ring 0 takes the
+  // default of 20 ms at 48 kHz.
+  const int frameBytes[2] = {0, 1024 * 2 * 2};
+  AsyncAudioDelivery delivery(2, 4, frameBytes, collector.consumer());
+
+  // 4096 bytes, beyond the default slot size: the slot grows.
+  Frame large(1024, 7);
+  CHECK(delivery.Push(0, 1, large.frame));
+  CHECK(delivery.Push(1, 1, large.frame));
+  // 40 ms at 48 kHz stereo, twice the default slot size.
+  Frame larger(1920, 11);
+  CHECK(delivery.Push(0, 2, larger.frame));
+  Frame small(480, 13);
+  CHECK(delivery.Push(0, 3, small.frame));
+
+  std::vector<Delivered> frames = collector.WaitFor(4);
+  int checked = 0;
+  for (const Delivered &delivered : frames) {
+    const Frame &expected = delivered.uid == 1   ? large
+                            : delivered.uid == 2 ? larger
+                                                 : small;
+    CHECK_EQ(expected.frame.samplesPerChannel, delivered.samplesPerChannel);
+    CHECK(delivered.pcm == expected.pcm);
+    ++checked;
+  }
+  CHECK_EQ(4, checked);
+  CHECK_EQ(0, delivery.GetStats(0).dropped);
+  CHECK_EQ(0, delivery.GetStats(1).dropped);
+}
+
+void TestOverflow() {
+  Collector collector;
+  AsyncAudioDelivery delivery(1, 4, nullptr, collector.consumer());
+  collector.Pause();
+  Frame frame(480, 0);
+  int pushed = 0;
+  // The slot the stalled consumer reads is only freed after the callback,
+  // so four frames fit.
+  for (int i = 0; i < 20; ++i) {
+    pushed += delivery.Push(0, i, frame.frame);
+  }
+  CHECK_EQ(4, pushed);
+  AsyncAudioDelivery::Stats stats = delivery.GetStats(0);
+  CHECK_EQ(16, stats.overflow);
+  CHECK_EQ(16, stats.dropped);
+  CHECK_EQ(4, stats.highWaterMark);
+
+  collector.Resume();
+  collector.WaitFor(4);
+
+  // Frames without PCM are dropped without taking a slot.
+  AudioFrame empty;
+  CHECK(!delivery.Push(0, 0, empty));
+  CHECK_EQ(17, delivery.GetStats(0).dropped);
+  CHECK_EQ(16, delivery.GetStats(0).overflow);
+}
+} // namespace
+
+int main() {
+  TestDeliversInOrder();
+  TestLargeFrames();
+  TestOverflow();
+  return test::Result("AsyncAudioDeliveryTest");
+}
@@ -0,0 +1,245 @@
+#include "AudioFrameObserver.h"
+
+#include "TestUtil.h"
+
+#include <string.h>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+
+const int FRAMES = 10000;
+
+// 10 ms of 48 kHz stereo PCM16.
+const int SAMPLES = 480;
+const int CHANNELS = 2;
+
+const int RECORD = media::IAudioFrameObserverBase::AUDIO_FRAME_POSITION_RECORD;
+const int BEFORE_MIXING =
+    media::IAudioFrameObserverBase::AUDIO_FRAME_POSITION_BEFORE_MIXING;
+
+// A frame as the SDK hands it over, over its own PCM.
+struct SdkFrame {
+  SdkFrame() : pcm(SAMPLES * CHANNELS) {
+    frame.samplesPerChannel = SAMPLES;
+    frame.channels = CHANNELS;
+    frame.samplesPerSec = 48000;
+    frame.buffer = pcm.data();
+  }
+
+  void Fill(int seed) {
+    for (size_t i = 0; i < pcm.size(); ++i) {
+      pcm[i] = static_cast<int16_t>((seed * 131 + i * 17) % 20000 - 10000);
+    }
+  }
+
+  AudioFrame frame;
+  std::vector<int16_t> pcm;
+};
+
+// What the Java observer was called with, the object behind the reference.
+fake::Object *JavaFrame(jobject ref) {
+  return static_cast<fake::Object *>(JNIEnv::Target(ref));
+}
+
+// The Java side of a caller, only its reference matters.
+jobject NewCaller(JNIEnv &env) {
+  jobject caller = env.NewObject(nullptr, nullptr);
+  env.newObjects = 0;
+  return caller;
+}
+
+// Java halves every sample it is given through the direct ByteBuffer, the
+// edit has to land in the SDK's own buffer.
+void TestDirectBufferAliasesSdkFrame() {
+  JNIEnv env;
+  jobject caller = NewCaller(env);
+  long long globalRefs;
+  {
+    AudioFrameObserver observer(
+        &env, caller, 0, AudioFrameObserver::BUFFER_TYPE_DIRECT_BYTE_BUFFER,
+        RECORD | BEFORE_MIXING, nullptr,
+        AudioFrameObserver::DELIVERY_MODE_SYNC, 0);
+    // One preallocated AudioFrame per position, nothing else.
+    CHECK_EQ(AudioFrameObserver::POSITION_INDEX_COUNT, env.newObjects);
+
+    SdkFrame record, remotes[2];
+    void *expected = nullptr;
+    int calls = 0, aliased = 0;
+    env.onCall = [&](const std::string &method, jobject frame) {
+      ++calls;
+      fake::Object *jFrame = JavaFrame(frame);
+      CHECK(jFrame->objects["buffer"] == nullptr);
+      auto *buffer =
+          static_cast<fake::ByteBuffer *>(jFrame->objects["byteBuffer"]);
+      aliased += buffer->address == expected &&
+                 buffer->capacity == SAMPLES * CHANNELS * 2 &&
+                 buffer->position == 0 && buffer->limit == buffer->capacity;
+      CHECK_EQ(SAMPLES, jFrame->values["samples"]);
+      CHECK_EQ(CHANNELS, jFrame->values["channels"]);
+      int16_t *pcm = static_cast<int16_t *>(buffer->address);
+      for (int i = 0; i < SAMPLES * CHANNELS; ++i) {
+        pcm[i] /= 2;
+      }
+      return method == "onRecordAudioFrame" ||
+                     method == "onPlaybackAudioFrameBeforeMixing"
+                 ? JNI_TRUE
+                 : JNI_FALSE;
+    };
+
+    long long byteBuffers = 0, newObjects = 0, localRefs = 0;
+    int wrong = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+      // One record frame and two remote uids, each with its own buffer.
+      SdkFrame *frames[3] = {&record, &remotes[0], &remotes[1]};
+      for (int f = 0; f < 3; ++f) {
+        SdkFrame &sdk = *frames[f];
+        sdk.Fill(i + f);
+        std::vector<int16_t> original = sdk.pcm;
+        expected = sdk.pcm.data();
+        bool ret = f == 0 ? observer.onRecordAudioFrame("", sdk.frame)
+                          : observer.onPlaybackAudioFrameBeforeMixing(
+                                "", 1000 + f, sdk.frame);
+        CHECK(ret);
+        for (size_t s = 0; s < original.size(); ++s) {
+          wrong += sdk.pcm[s] != original[s] / 2;
+        }
+      }
+      if (i == 0) {
+        byteBuffers = env.byteBuffers;
+        newObjects = env.newObjects;
+        localRefs = env.localRefs;
+      }
+    }
+    CHECK_EQ(0, wrong);
+    CHECK_EQ(3 * FRAMES, calls);
+    CHECK_EQ(3 * FRAMES, aliased);
+
+    // One direct ByteBuffer per SDK buffer, made on the first frame.
+    CHECK_EQ(3, byteBuffers);
+    CHECK_EQ(byteBuffers, env.byteBuffers);
+    CHECK_EQ(newObjects, env.newObjects);
+    CHECK_EQ(localRefs, env.localRefs);
+    CHECK_EQ(0, env.byteArrays);
+    CHECK_EQ(0, env.primitiveArrays);
+    globalRefs = env.globalRefs;
+  }
+  // The observer drops every reference it took.
+  CHECK(globalRefs > 0);
+  CHECK_EQ(0, env.globalRefs);
+  env.DeleteLocalRef(caller);
+}
+
+// Java overwrites the first sample of every byte[] frame and checks the first
+// float of every planar one. Once every stream has seen a frame, marshalling
+// allocates nothing more on the Java heap.
+void CheckMarshallingStaysFlat(int bufferType) {
+  const bool planar =
+      bufferType == AudioFrameObserver::BUFFER_TYPE_FLOAT_PLANAR;
+  JNIEnv env;
+  jobject caller = NewCaller(env);
+  {
+    AudioFrameObserver observer(&env, caller, 0, bufferType,
+                                RECORD | BEFORE_MIXING, nullptr,
+                                AudioFrameObserver::DELIVERY_MODE_SYNC, 0);
+    CHECK_EQ(AudioFrameObserver::POSITION_INDEX_COUNT, env.newObjects);
+
+    SdkFrame record, remotes[2];
+    SdkFrame *frames[3] = {&record, &remotes[0], &remotes[1]};
+    SdkFrame *current = nullptr;
+    int16_t mark = 0;
+    int converted = 0;
+    env.onCall = [&](const std::string &, jobject frame) {
+      fake::Object *jFrame = JavaFrame(frame);
+      if (planar) {
+        auto *buffer =
+            static_cast<fake::ByteBuffer *>(jFrame->objects["byteBuffer"]);
+        float first = *static_cast<float *>(buffer->address);
+        converted += first == current->pcm[0] / 32768.0f;
+      } else {
+        auto *array =
+            static_cast<fake::ByteArray *>(jFrame->objects["buffer"]);
+        CHECK_EQ(SAMPLES * CHANNELS * 2,
+                 static_cast<int>(array->data.size()));
+        memcpy(array->data.data(), &mark, sizeof(mark));
+      }
+      return JNI_TRUE;
+    };
+
+    long long newObjects = 0, byteArrays = 0, byteBuffers = 0, localRefs = 0;
+    int wrong = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+      for (int f = 0; f < 3; ++f) {
+        current = frames[f];
+        current->Fill(i + f);
+        int16_t original = current->pcm[0];
+        mark = static_cast<int16_t>(i * 3 + f);
+        bool ret = f == 0 ? observer.onRecordAudioFrame("", current->frame)
+                          : observer.onPlaybackAudioFrameBeforeMixing(
+                                "", 1000 + f, current->frame);
+        CHECK(ret);
+        // Planar frames are read-only, byte[] edits are copied back.
+        wrong += current->pcm[0] != (planar ? original : mark);
+      }
+      if (i == 0) {
+        newObjects = env.newObjects;
+        byteArrays = env.byteArrays;
+        byteBuffers = env.byteBuffers;
+        localRefs = env.localRefs;
+      }
+    }
+    CHECK_EQ(0, wrong);
+    CHECK_EQ(planar ? 3 * FRAMES : 0, converted);
+
+    // One byte[] or one planar ByteBuffer per position.
+    CHECK_EQ(planar ? 0 : 2, byteArrays);
+    CHECK_EQ(planar ? 2 : 0, byteBuffers);
+    CHECK_EQ(newObjects, env.newObjects);
+    CHECK_EQ(byteArrays, env.byteArrays);
+    CHECK_EQ(byteBuffers, env.byteBuffers);
+    CHECK_EQ(localRefs, env.localRefs);
+    CHECK_EQ(0, env.primitiveArrays);
+  }
+  CHECK_EQ(0, env.globalRefs);
+  env.DeleteLocalRef(caller);
+}
+
+void TestByteArraysStayFlat() {
+  CheckMarshallingStaysFlat(AudioFrameObserver::BUFFER_TYPE_BYTE_ARRAY);
+}
+
+void TestFloatPlanarStaysFlat() {
+  CheckMarshallingStaysFlat(AudioFrameObserver::BUFFER_TYPE_FLOAT_PLANAR);
+}
+
+// Unobserved positions never reach Java.
+void TestUnobservedPositionSkipped() {
+  JNIEnv env;
+  jobject caller = NewCaller(env);
+  {
+    AudioFrameObserver observer(
+        &env, caller, 0, AudioFrameObserver::BUFFER_TYPE_DIRECT_BYTE_BUFFER,
+        RECORD, nullptr, AudioFrameObserver::DELIVERY_MODE_SYNC, 0);
+    SdkFrame sdk;
+    sdk.Fill(1);
+    std::vector<int16_t> original = sdk.pcm;
+    long long upcalls = env.upcalls;
+    CHECK(observer.onPlaybackAudioFrame("", sdk.frame));
+    CHECK(observer.onPlaybackAudioFrameBeforeMixing("", 1, sdk.frame));
+    CHECK_EQ(upcalls, env.upcalls);
+    CHECK_EQ(0, env.byteBuffers);
+    CHECK(sdk.pcm == original);
+  }
+  env.DeleteLocalRef(caller);
+}
+} // namespace
+
+int main() {
+  TestDirectBufferAliasesSdkFrame();
+  TestByteArraysStayFlat();
+  TestFloatPlanarStaysFlat();
+  TestUnobservedPositionSkipped();
+  return test::Result("AudioFrameObserverTest");
+}
@@ -0,0 +1,316 @@
+#include "AudioInjector.h"
+
+#include "Pacer.h"
+#include "TestUtil.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+
+// One pushAudioFrame() call as the fake engine saw it.
+struct Pushed {
+  long long timeNs;
+  rtc::track_id_t trackId;
+  int samplesPerChannel;
+  int channels;
+  int samplesPerSec;
+  std::vector<int16_t> pcm;
+};
+
+// Records what is pushed and when, everything else fails.
+class FakeMediaEngine : public media::IMediaEngine {
+public:
+  int pushAudioFrame(AudioFrame *frame, rtc::track_id_t trackId) override {
+    const int16_t *pcm = static_cast<const int16_t *>(frame->buffer);
+    Pushed pushed = {Pacer::NowNs(),
+                     trackId,
+                     frame->samplesPerChannel,
+                     frame->channels,
+                     frame->samplesPerSec,
+                     std::vector<int16_t>(pcm, pcm + frame->samplesPerChannel *
+                                                         frame->channels)};
+    std::lock_guard<std::mutex> lock(mutex);
+    frames.push_back(std::move(pushed));
+    return result;
+  }
+
+  std::vector<Pushed> Frames() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames;
+  }
+
+  void release() override { ++released; }
+
+  int registerAudioFrameObserver(media::IAudioFrameObserver *) override {
+    return -1;
+  }
+  int registerVideoFrameObserver(media::IVideoFrameObserver *) override {
+    return -1;
+  }
+  int registerVideoEncodedFrameObserver(
+      media::IVideoEncodedFrameObserver *) override {
+    return -1;
+  }
+  int registerFaceInfoObserver(media::IFaceInfoObserver *) override {
+    return -1;
+  }
+  int pullAudioFrame(AudioFrame *) override { return -1; }
+  int setExternalVideoSource(bool, bool, media::EXTERNAL_VIDEO_SOURCE_TYPE,
+                             rtc::SenderOptions) override {
+    return -1;
+  }
+  int setExternalAudioSource(bool, int, int, bool, bool) override {
+    return -1;
+  }
+  rtc::track_id_t
+  createCustomAudioTrack(rtc::AUDIO_TRACK_TYPE,
+                         const rtc::AudioTrackConfig &) override {
+    return 0;
+  }
+  int destroyCustomAudioTrack(rtc::track_id_t) override { return -1; }
+  int setExternalAudioSink(bool, int, int) override { return -1; }
+  int enableCustomAudioLocalPlayback(rtc::track_id_t, bool) override {
+    return -1;
+  }
+  int pushVideoFrame(media::base::ExternalVideoFrame *,
+                     unsigned int) override {
+    return -1;
+  }
+  int pushEncodedVideoImage(const unsigned char *, size_t,
+                            const rtc::EncodedVideoFrameInfo &,
+                            unsigned int) override {
+    return -1;
+  }
+  int addVideoFrameRenderer(media::IVideoFrameObserver *) override {
+    return -1;
+  }
+  int removeVideoFrameRenderer(media::IVideoFrameObserver *) override {
+    return -1;
+  }
+
+  int result = 0;
+  int released = 0;
+
+private:
+  std::mutex mutex;
+  std::vector<Pushed> frames;
+};
+
+// 10 ms of 48 kHz mono.
+const int FRAME_SAMPLES = 480;
+const int FRAME_BYTES = FRAME_SAMPLES * 2;
+
+// Frame `k` of the test signal, every sample set to k + 1 so silence stands
+// out.
+std::vector<int16_t> Frame(int k) {
+  return std::vector<int16_t>(FRAME_SAMPLES, static_cast<int16_t>(k + 1));
+}
+
+template <typename Condition> bool WaitUntil(Condition condition) {
+  for (int i = 0; i < 400; ++i) {
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return false;
+}
+
+bool IsSilent(const Pushed &pushed) {
+  for (int16_t sample : pushed.pcm) {
+    if (sample != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The non-silent frames pushed so far, by the value of their samples.
+std::vector<int> Voiced(FakeMediaEngine &engine) {
+  std::vector<int> voiced;
+  for (const Pushed &pushed : engine.Frames()) {
+    if (!IsSilent(pushed)) {
+      voiced.push_back(pushed.pcm.front() - 1);
+    }
+  }
+  return voiced;
+}
+
+void TestPrimesThenPushesInOrder() {
+  FakeMediaEngine engine;
+  {
+    AudioInjector::Config config;
+    config.trackId = 3;
+    config.jitterFrames = 3;
+    AudioInjector injector(&engine, config);
+    CHECK(injector.Start());
+
+    // Silence while nothing is buffered.
+    CHECK(WaitUntil([&] { return engine.Frames().size() >= 5; }));
+    CHECK(Voiced(engine).empty());
+
+    // Two frames are below the jitter depth, the third starts pushing.
+    for (int k = 0; k < 2; ++k) {
+      CHECK_EQ(FRAME_BYTES, injector.Write(Frame(k).data(), FRAME_BYTES));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(Voiced(engine).empty());
+    for (int k = 2; k < 10; ++k) {
+      CHECK_EQ(FRAME_BYTES, injector.Write(Frame(k).data(), FRAME_BYTES));
+    }
+    CHECK(WaitUntil(
+        [&] { return injector.GetStats().framesPushed == 10; }));
+    std::vector<int> voiced = Voiced(engine);
+    CHECK_EQ(10, static_cast<int>(voiced.size()));
+    for (int k = 0; k < static_cast<int>(voiced.size()); ++k) {
+      CHECK_EQ(k, voiced[k]);
+    }
+
+    // The ring ran dry once and the injector went back to priming.
+    CHECK(WaitUntil([&] { return injector.GetStats().underruns == 1; }));
+    AudioInjector::Stats stats = injector.GetStats();
+    CHECK(stats.silentFrames >= 5);
+    CHECK_EQ(0, stats.bufferedFrames);
+    CHECK_EQ(0, stats.pushErrors);
+  }
+  for (const Pushed &pushed : engine.Frames()) {
+    CHECK_EQ(3u, pushed.trackId);
+    CHECK_EQ(FRAME_SAMPLES, pushed.samplesPerChannel);
+    CHECK_EQ(1, pushed.channels);
+    CHECK_EQ(48000, pushed.samplesPerSec);
+  }
+  // Stopped with the injector, which released the engine once.
+  size_t count = engine.Frames().size();
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  CHECK_EQ(count, engine.Frames().size());
+  CHECK_EQ(1, engine.released);
+}
+
+void TestPacing() {
+  FakeMediaEngine engine;
+  AudioInjector::Config config;
+  AudioInjector injector(&engine, config);
+  CHECK(injector.Start());
+  CHECK(WaitUntil([&] { return engine.Frames().size() >= 31; }));
+  injector.Stop();
+  std::vector<Pushed> frames = engine.Frames();
+  // Absolute deadlines: 30 periods take 300 ms, however each wake-up went.
+  double meanMs = (frames[30].timeNs - frames[0].timeNs) / 30 / 1e6;
+  printf("Mean push interval %.2f ms, %lld late ticks\n", meanMs,
+         injector.GetStats().lateTicks);
+  CHECK_NEAR(10.0, meanMs, 1.0);
+}
+
+void TestPartialWritesAndRefusal() {
+  FakeMediaEngine engine;
+  AudioInjector::Config config;
+  config.capacityFrames = 4;
+  config.jitterFrames = 4;
+  AudioInjector injector(&engine, config);
+
+  // Four frames written 7 bytes at a time fill the ring, the rest is refused.
+  std::vector<int16_t> pcm;
+  for (int k = 0; k < 6; ++k) {
+    std::vector<int16_t> frame = Frame(k);
+    pcm.insert(pcm.end(), frame.begin(), frame.end());
+  }
+  const unsigned char *bytes = reinterpret_cast<unsigned char *>(pcm.data());
+  int accepted = 0;
+  for (int offset = 0; offset < 6 * FRAME_BYTES; offset += 7) {
+    int length = 6 * FRAME_BYTES - offset < 7 ? 6 * FRAME_BYTES - offset : 7;
+    accepted += injector.Write(bytes + offset, length);
+  }
+  CHECK_EQ(4 * FRAME_BYTES, accepted);
+  AudioInjector::Stats stats = injector.GetStats();
+  CHECK_EQ(2 * FRAME_BYTES, stats.bytesRefused);
+  CHECK_EQ(4, stats.bufferedFrames);
+  CHECK_EQ(4, stats.capacityFrames);
+  unsigned char *data;
+  CHECK_EQ(0, injector.BeginWrite(data));
+
+  CHECK(injector.Start());
+  CHECK(WaitUntil([&] { return injector.GetStats().framesPushed == 4; }));
+  injector.Stop();
+  std::vector<int> voiced = Voiced(engine);
+  CHECK_EQ(4, static_cast<int>(voiced.size()));
+  for (int k = 0; k < static_cast<int>(voiced.size()); ++k) {
+    CHECK_EQ(k, voiced[k]);
+  }
+}
+
+void TestInPlaceWrites() {
+  FakeMediaEngine engine;
+  AudioInjector::Config config;
+  config.jitterFrames = 1;
+  AudioInjector injector(&engine, config);
+
+  // How a Dart producer fills the ring: synthesize into the slot directly.
+  unsigned char *data;
+  CHECK_EQ(FRAME_BYTES, injector.BeginWrite(data));
+  unsigned char *again;
+  CHECK_EQ(FRAME_BYTES, injector.BeginWrite(again));
+  CHECK(again == data);
+  int16_t *samples = reinterpret_cast<int16_t *>(data);
+  for (int i = 0; i < 100; ++i) {
+    samples[i] = 1;
+  }
+  injector.CommitWrite(200);
+  // The rest of the frame continues where the commit left off.
+  CHECK_EQ(FRAME_BYTES - 200, injector.BeginWrite(data));
+  samples = reinterpret_cast<int16_t *>(data);
+  for (int i = 0; i < FRAME_SAMPLES - 100; ++i) {
+    samples[i] = 1;
+  }
+  CHECK_EQ(0, injector.GetStats().bufferedFrames);
+  injector.CommitWrite(FRAME_BYTES - 200);
+  CHECK_EQ(1, injector.GetStats().bufferedFrames);
+
+  CHECK(injector.Start());
+  CHECK(WaitUntil([&] { return injector.GetStats().framesPushed == 1; }));
+  injector.Stop();
+  std::vector<Pushed> frames = engine.Frames();
+  bool found = false;
+  for (const Pushed &pushed : frames) {
+    if (!IsSilent(pushed)) {
+      CHECK(pushed.pcm == Frame(0));
+      found = true;
+    }
+  }
+  CHECK(found);
+}
+
+void TestPushErrorsAndMissingEngine() {
+  FakeMediaEngine engine;
+  engine.result = -2;
+  AudioInjector::Config config;
+  AudioInjector injector(&engine, config);
+  CHECK(injector.Start());
+  // Starting twice is refused.
+  CHECK(!injector.Start());
+  CHECK(WaitUntil([&] { return injector.GetStats().pushErrors >= 3; }));
+  injector.Stop();
+
+  AudioInjector missing(static_cast<media::IMediaEngine *>(nullptr), config);
+  CHECK(!missing.Start());
+  config.sampleRate = 0;
+  FakeMediaEngine other;
+  AudioInjector invalid(&other, config);
+  CHECK(!invalid.Start());
+  unsigned char *data;
+  CHECK_EQ(0, invalid.BeginWrite(data));
+}
+} // namespace
+
+int main() {
+  TestPrimesThenPushesInOrder();
+  TestPacing();
+  TestPartialWritesAndRefusal();
+  TestInPlaceWrites();
+  TestPushErrorsAndMissingEngine();
+  return test::Result("AudioInjectorTest");
+}
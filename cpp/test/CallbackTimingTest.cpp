@@ -0,0 +1,125 @@
+#include "CallbackTiming.h"
+
+#include "TestUtil.h"
+
+#include <thread>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef LatencyHistogram::Snapshot Snapshot;
+
+void TestBuckets() {
+  // Exact below LINEAR_BUCKETS.
+  for (int us = 0; us < LatencyHistogram::LINEAR_BUCKETS; ++us) {
+    CHECK_EQ(us, LatencyHistogram::BucketIndex(us));
+    CHECK_EQ(us, LatencyHistogram::BucketLowerBound(us));
+  }
+  int previous = LatencyHistogram::BucketIndex(0);
+  for (long long us = 1; us < 16000000; us += us / 64 + 1) {
+    int index = LatencyHistogram::BucketIndex(us);
+    long long lower = LatencyHistogram::BucketLowerBound(index);
+    // Monotonic, and every value within 12.5% of its bucket's lower bound.
+    CHECK(index >= previous);
+    CHECK(lower <= us);
+    CHECK(us - lower <= lower / 8);
+    CHECK(index + 1 == LatencyHistogram::BUCKET_COUNT ||
+          LatencyHistogram::BucketLowerBound(index + 1) > us);
+    previous = index;
+  }
+  // Beyond ~16 s everything lands in the last bucket.
+  CHECK_EQ(LatencyHistogram::BUCKET_COUNT - 1,
+           LatencyHistogram::BucketIndex(1LL << 40));
+}
+
+void TestSnapshot() {
+  LatencyHistogram histogram;
+  Snapshot snapshot;
+  histogram.Read(snapshot);
+  CHECK_EQ(0, snapshot.count);
+  CHECK_EQ(0, snapshot.minUs);
+  CHECK_EQ(0, snapshot.Percentile(0.5));
+
+  // 1..1000 us once each, plus a negative duration clamped to 0.
+  for (int us = 1; us <= 1000; ++us) {
+    histogram.Record(us);
+  }
+  histogram.Record(-5);
+  histogram.Read(snapshot);
+  CHECK_EQ(1001, snapshot.count);
+  CHECK_EQ(500500, snapshot.sumUs);
+  CHECK_EQ(0, snapshot.minUs);
+  CHECK_EQ(1000, snapshot.maxUs);
+  CHECK_NEAR(500, snapshot.Percentile(0.5), 500 / 8);
+  CHECK_NEAR(990, snapshot.Percentile(0.99), 990 / 8);
+  CHECK_EQ(1000, snapshot.Percentile(1.0));
+
+  histogram.Reset();
+  histogram.Read(snapshot);
+  CHECK_EQ(0, snapshot.count);
+  CHECK_EQ(0, snapshot.sumUs);
+  CHECK_EQ(0, snapshot.maxUs);
+}
+
+void TestConcurrentRecord() {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t] {
+      for (int i = 0; i < 10000; ++i) {
+        histogram.Record(t * 100 + i % 100 + 1);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  Snapshot snapshot;
+  histogram.Read(snapshot);
+  CHECK_EQ(40000, snapshot.count);
+  CHECK_EQ(1, snapshot.minUs);
+  CHECK_EQ(400, snapshot.maxUs);
+}
+
+void TestArrivals() {
+  CallbackTiming timing(2);
+  // 10 ms callbacks at position 0, the first arrival only starts the clock.
+  for (int i = 0; i < 100; ++i) {
+    timing.Arrive(0, 1000000 + i * 10000LL);
+  }
+  timing.Record(1, CallbackTiming::METRIC_HANDLER, 250);
+
+  Snapshot snapshot;
+  timing.Read(0, CallbackTiming::METRIC_INTERVAL, snapshot);
+  CHECK_EQ(99, snapshot.count);
+  CHECK_EQ(10000, snapshot.minUs);
+  CHECK_EQ(10000, snapshot.maxUs);
+  // Positions and metrics are kept apart.
+  timing.Read(1, CallbackTiming::METRIC_INTERVAL, snapshot);
+  CHECK_EQ(0, snapshot.count);
+  timing.Read(1, CallbackTiming::METRIC_HANDLER, snapshot);
+  CHECK_EQ(1, snapshot.count);
+  CHECK_EQ(250, snapshot.maxUs);
+
+  // After a reset the next arrival starts a new interval, the gap since the
+  // last one before it is not recorded.
+  timing.Reset();
+  timing.Arrive(0, 5000000);
+  timing.Arrive(0, 5020000);
+  timing.Read(0, CallbackTiming::METRIC_INTERVAL, snapshot);
+  CHECK_EQ(1, snapshot.count);
+  CHECK_EQ(20000, snapshot.minUs);
+
+  long long now = CallbackTiming::NowUs();
+  CHECK(CallbackTiming::NowUs() >= now);
+}
+} // namespace
+
+int main() {
+  TestBuckets();
+  TestSnapshot();
+  TestConcurrentRecord();
+  TestArrivals();
+  return test::Result("CallbackTimingTest");
+}
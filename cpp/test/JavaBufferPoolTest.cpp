@@ -0,0 +1,154 @@
+#include "JavaBufferPool.h"
+
+#include "TestUtil.h"
+#include "include/AgoraMediaBase.h"
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const int FRAMES = 10000;
+
+// 10 ms of 48 kHz stereo PCM16.
+const int AUDIO_BYTES = 480 * 2 * 2;
+
+void TestAudioByteArraysStayFlat() {
+  JNIEnv env;
+  JavaBufferPool pool;
+  jbyteArray first = pool.ByteArray(&env, AUDIO_BYTES);
+  for (int i = 0; i < FRAMES; ++i) {
+    CHECK(pool.ByteArray(&env, AUDIO_BYTES) == first);
+  }
+  CHECK_EQ(1, env.byteArrays);
+  CHECK_EQ(0, env.upcalls);
+  // The pool keeps one global reference, every local one is gone.
+  CHECK_EQ(1, env.globalRefs);
+  CHECK_EQ(0, env.localRefs);
+
+  pool.Release(&env);
+  CHECK_EQ(0, env.globalRefs);
+}
+
+void TestFormatChangesReuseArrays() {
+  JNIEnv env;
+  JavaBufferPool pool;
+  // A stream flipping between 48 kHz stereo and 16 kHz mono.
+  for (int i = 0; i < FRAMES; ++i) {
+    pool.ByteArray(&env, i % 2 ? AUDIO_BYTES : 320);
+  }
+  CHECK_EQ(2, env.byteArrays);
+  pool.Release(&env);
+}
+
+void TestVideoPlanesStayFlat() {
+  JNIEnv env;
+  JavaBufferPool pool(12);
+  // 720p I420, U and V have the same length.
+  const int lengths[3] = {1280 * 720, 640 * 360, 640 * 360};
+  jbyteArray planes[3];
+  for (int i = 0; i < FRAMES; ++i) {
+    for (int p = 0; p < 3; ++p) {
+      jbyteArray array = pool.ByteArray(&env, lengths[p], p);
+      if (i == 0) {
+        planes[p] = array;
+      }
+      CHECK(array == planes[p]);
+    }
+  }
+  // Each plane has its own array, or the V copy would overwrite U.
+  CHECK(planes[1] != planes[2]);
+  CHECK_EQ(3, env.byteArrays);
+  CHECK_EQ(3, env.globalRefs);
+  CHECK_EQ(0, env.localRefs);
+  pool.Release(&env);
+}
+
+void TestDirectBuffersPerAddress() {
+  JNIEnv env;
+  JavaBufferPool pool;
+  // The SDK rotating through three frame buffers.
+  std::vector<unsigned char> sdk[3];
+  for (auto &buffer : sdk) {
+    buffer.resize(AUDIO_BYTES);
+  }
+  for (int i = 0; i < FRAMES; ++i) {
+    void *address = sdk[i % 3].data();
+    jobject jBuffer = pool.DirectByteBuffer(&env, address, AUDIO_BYTES);
+    auto *buffer = static_cast<fake::ByteBuffer *>(JNIEnv::Target(jBuffer));
+    CHECK(buffer->address == address);
+    CHECK_EQ(0, buffer->position);
+    CHECK_EQ(AUDIO_BYTES, buffer->limit);
+    // A handler reading the buffer moves its position.
+    buffer->position = AUDIO_BYTES;
+  }
+  CHECK_EQ(3, env.byteBuffers);
+  CHECK_EQ(0, env.byteArrays);
+  CHECK_EQ(3, env.globalRefs);
+  pool.Release(&env);
+}
+
+// BUFFER_TYPE_DIRECT_BYTE_BUFFER: synthetic SDK frames handed to a "Java"
+// handler that halves every sample through its ByteBuffer.
+void TestDirectAudioFramesAliasSdkBuffer() {
+  JNIEnv env;
+  JavaBufferPool pool;
+  std::vector<int16_t> sdk(480 * 2);
+  media::IAudioFrameObserverBase::AudioFrame frame;
+  frame.samplesPerChannel = 480;
+  frame.channels = 2;
+  frame.samplesPerSec = 48000;
+  frame.buffer = sdk.data();
+  const int length =
+      frame.samplesPerChannel * frame.channels * frame.bytesPerSample;
+
+  for (int i = 0; i < FRAMES; ++i) {
+    for (size_t s = 0; s < sdk.size(); ++s) {
+      sdk[s] = static_cast<int16_t>(i + s);
+    }
+    jobject jBuffer = pool.DirectByteBuffer(&env, frame.buffer, length);
+    auto *buffer = static_cast<fake::ByteBuffer *>(JNIEnv::Target(jBuffer));
+    CHECK_EQ(length, buffer->capacity);
+    int16_t *samples = static_cast<int16_t *>(buffer->address);
+    for (int s = 0; s < length / 2; ++s) {
+      samples[s] = static_cast<int16_t>(samples[s] / 2);
+    }
+    // The edit is in the SDK buffer, there is nothing to copy back.
+    CHECK_EQ((i + 7) / 2, sdk[7]);
+  }
+  // One wrapper for the whole stream and no byte[] at all.
+  CHECK_EQ(1, env.byteBuffers);
+  CHECK_EQ(0, env.byteArrays);
+  CHECK_EQ(0, env.localRefs);
+  pool.Release(&env);
+}
+
+void TestEvictsLeastRecentlyUsed() {
+  JNIEnv env;
+  JavaBufferPool pool(2);
+  pool.ByteArray(&env, 100);
+  pool.ByteArray(&env, 200);
+  pool.ByteArray(&env, 100);
+  // 200 is the least recently used and makes room.
+  pool.ByteArray(&env, 300);
+  CHECK_EQ(3, env.byteArrays);
+  pool.ByteArray(&env, 100);
+  CHECK_EQ(3, env.byteArrays);
+  pool.ByteArray(&env, 200);
+  CHECK_EQ(4, env.byteArrays);
+  // Evicted arrays lose their global reference.
+  CHECK_EQ(2, env.globalRefs);
+  pool.Release(&env);
+  CHECK_EQ(0, env.globalRefs);
+}
+} // namespace
+
+int main() {
+  TestAudioByteArraysStayFlat();
+  TestFormatChangesReuseArrays();
+  TestVideoPlanesStayFlat();
+  TestDirectBuffersPerAddress();
+  TestDirectAudioFramesAliasSdkBuffer();
+  TestEvictsLeastRecentlyUsed();
+  return test::Result("JavaBufferPoolTest");
+}
@@ -0,0 +1,144 @@
+#include "PcmKernels.h"
+
+#include "TestUtil.h"
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+// 10 ms of 48 kHz stereo, one SDK callback.
+const int FRAMES = 480;
+const int COUNT = FRAMES * 2;
+const int ITERATIONS = 200000;
+
+// Keeps the compiler from dropping loops whose results are unused.
+volatile double sink;
+
+int16_t Saturate(float value) {
+  return value > 32767.0f    ? 32767
+         : value < -32768.0f ? -32768
+                             : static_cast<int16_t>(value);
+}
+
+void Report(const char *name, double scalarNs, double kernelNs) {
+  printf("%-22s scalar %8.1f ns  kernel %8.1f ns  x%.1f\n", name, scalarNs,
+         kernelNs, scalarNs / kernelNs);
+}
+} // namespace
+
+// Time per 10 ms stereo frame of each kernel against the plain loop it
+// replaces. The scalar loops get whatever the compiler's auto-vectorizer makes
+// of them at the build flags, which is the fair baseline.
+int main() {
+  test::Random random;
+  std::vector<int16_t> a(COUNT), b(COUNT), mono(FRAMES);
+  std::vector<float> f(COUNT), g(COUNT);
+  for (int i = 0; i < COUNT; ++i) {
+    a[i] = random.NextInt16();
+    b[i] = random.NextInt16();
+    f[i] = random.NextFloat();
+    g[i] = random.NextFloat();
+  }
+
+  Report("Gain",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < COUNT; ++i) {
+                                a[i] = Saturate(a[i] * 0.999f);
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS,
+                            [&] { pcm::Gain(a.data(), COUNT, 0.999f); }));
+
+  Report("MixAdd",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < COUNT; ++i) {
+                                int sum = a[i] + b[i];
+                                a[i] = static_cast<int16_t>(
+                                    sum > 32767    ? 32767
+                                    : sum < -32768 ? -32768
+                                                   : sum);
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::MixAdd(a.data(), b.data(), COUNT);
+         }));
+
+  Report("DownmixStereoToMono",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < FRAMES; ++i) {
+                                mono[i] = static_cast<int16_t>(
+                                    (b[i * 2] + b[i * 2 + 1]) >> 1);
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::DownmixStereoToMono(b.data(), mono.data(), FRAMES);
+         }));
+
+  Report("UpmixMonoToStereo",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < FRAMES; ++i) {
+                                a[i * 2] = a[i * 2 + 1] = mono[i];
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::UpmixMonoToStereo(mono.data(), a.data(), FRAMES);
+         }));
+
+  Report("Int16ToFloat",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < COUNT; ++i) {
+                                f[i] = b[i] * (1.0f / 32768.0f);
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::Int16ToFloat(b.data(), f.data(), COUNT);
+         }));
+
+  Report("FloatToInt16",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              for (int i = 0; i < COUNT; ++i) {
+                                a[i] = Saturate(f[i] * 32768.0f);
+                              }
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::FloatToInt16(f.data(), a.data(), COUNT);
+         }));
+
+  Report("Dot",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              float sum = 0.0f;
+                              for (int i = 0; i < COUNT; ++i) {
+                                sum += f[i] * g[i];
+                              }
+                              sink = sum;
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           sink = pcm::Dot(f.data(), g.data(), COUNT);
+         }));
+
+  Report("Measure",
+         test::NanosPerCall(ITERATIONS,
+                            [&] {
+                              int peak = 0;
+                              double sum = 0.0;
+                              for (int i = 0; i < COUNT; ++i) {
+                                int s = b[i] < 0 ? -b[i] : b[i];
+                                peak = s > peak ? s : peak;
+                                sum += static_cast<double>(b[i]) * b[i];
+                              }
+                              sink = sum + peak;
+                            }),
+         test::NanosPerCall(ITERATIONS, [&] {
+           pcm::Level level = pcm::Measure(b.data(), COUNT);
+           sink = level.sumOfSquares + level.peak;
+         }));
+  return 0;
+}
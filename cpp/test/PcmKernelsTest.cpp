@@ -0,0 +1,214 @@
+#include "PcmKernels.h"
+
+#include "TestUtil.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+// The plain loops every kernel must agree with.
+namespace reference {
+int16_t Saturate(float value) {
+  if (value > 32767.0f) {
+    return 32767;
+  }
+  if (value < -32768.0f) {
+    return -32768;
+  }
+  return static_cast<int16_t>(value);
+}
+
+void Gain(int16_t *samples, int count, float gain) {
+  for (int i = 0; i < count; ++i) {
+    samples[i] = Saturate(samples[i] * gain);
+  }
+}
+
+void MixAdd(int16_t *dst, const int16_t *src, int count) {
+  for (int i = 0; i < count; ++i) {
+    int sum = dst[i] + src[i];
+    dst[i] = static_cast<int16_t>(sum > 32767 ? 32767
+                                              : sum < -32768 ? -32768 : sum);
+  }
+}
+
+double Dot(const float *a, const float *b, int count) {
+  double sum = 0.0;
+  for (int i = 0; i < count; ++i) {
+    sum += static_cast<double>(a[i]) * b[i];
+  }
+  return sum;
+}
+} // namespace reference
+
+// Random samples with the extremes mixed in, where saturation and sign
+// handling go wrong first.
+std::vector<int16_t> Samples(test::Random &random, int count) {
+  std::vector<int16_t> samples(count);
+  for (int i = 0; i < count; ++i) {
+    switch (random.Next() % 8) {
+    case 0:
+      samples[i] = -32768;
+      break;
+    case 1:
+      samples[i] = 32767;
+      break;
+    default:
+      samples[i] = random.NextInt16();
+    }
+  }
+  return samples;
+}
+
+// Lengths around every vector width, so each path and its tail loop run.
+const int COUNTS[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 63, 65, 480, 961};
+
+void TestGain() {
+  test::Random random(1);
+  const float gains[] = {0.0f, 0.5f, 1.0f, 1.7f, -1.0f, 4.0f};
+  for (int count : COUNTS) {
+    for (float gain : gains) {
+      std::vector<int16_t> expected = Samples(random, count);
+      std::vector<int16_t> actual = expected;
+      reference::Gain(expected.data(), count, gain);
+      pcm::Gain(actual.data(), count, gain);
+      CHECK(expected == actual);
+    }
+  }
+}
+
+void TestMixAdd() {
+  test::Random random(2);
+  for (int count : COUNTS) {
+    std::vector<int16_t> src = Samples(random, count);
+    std::vector<int16_t> expected = Samples(random, count);
+    std::vector<int16_t> actual = expected;
+    reference::MixAdd(expected.data(), src.data(), count);
+    pcm::MixAdd(actual.data(), src.data(), count);
+    CHECK(expected == actual);
+  }
+}
+
+void TestDownmixAndUpmix() {
+  test::Random random(3);
+  for (int frames : COUNTS) {
+    std::vector<int16_t> stereo = Samples(random, frames * 2);
+    std::vector<int16_t> mono(frames);
+    pcm::DownmixStereoToMono(stereo.data(), mono.data(), frames);
+    for (int i = 0; i < frames; ++i) {
+      CHECK_EQ((stereo[i * 2] + stereo[i * 2 + 1]) >> 1, mono[i]);
+    }
+
+    // In place, the mono samples land in the first half.
+    std::vector<int16_t> inPlace = stereo;
+    pcm::DownmixStereoToMono(inPlace.data(), inPlace.data(), frames);
+    CHECK(std::vector<int16_t>(inPlace.begin(), inPlace.begin() + frames) ==
+          mono);
+
+    std::vector<int16_t> upmixed(frames * 2);
+    pcm::UpmixMonoToStereo(mono.data(), upmixed.data(), frames);
+    for (int i = 0; i < frames; ++i) {
+      CHECK_EQ(mono[i], upmixed[i * 2]);
+      CHECK_EQ(mono[i], upmixed[i * 2 + 1]);
+    }
+  }
+}
+
+void TestFloatConversion() {
+  test::Random random(4);
+  for (int count : COUNTS) {
+    std::vector<int16_t> samples = Samples(random, count);
+    std::vector<float> floats(count);
+    pcm::Int16ToFloat(samples.data(), floats.data(), count);
+    for (int i = 0; i < count; ++i) {
+      CHECK(floats[i] == samples[i] / 32768.0f);
+    }
+
+    // Exact round trip for every int16 value.
+    std::vector<int16_t> back(count);
+    pcm::FloatToInt16(floats.data(), back.data(), count);
+    CHECK(back == samples);
+
+    // Out of range values saturate like the scalar loop.
+    std::vector<float> loud(count);
+    for (int i = 0; i < count; ++i) {
+      loud[i] = random.NextFloat() * 3.0f;
+    }
+    pcm::FloatToInt16(loud.data(), back.data(), count);
+    for (int i = 0; i < count; ++i) {
+      CHECK_EQ(reference::Saturate(loud[i] * 32768.0f), back[i]);
+    }
+  }
+}
+
+void TestInt16ToFloatPlanar() {
+  test::Random random(5);
+  for (int channels = 1; channels <= 3; ++channels) {
+    for (int frames : COUNTS) {
+      std::vector<int16_t> interleaved = Samples(random, frames * channels);
+      std::vector<float> planar(frames * channels);
+      pcm::Int16ToFloatPlanar(interleaved.data(), planar.data(), frames,
+                              channels);
+      for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+          CHECK(planar[c * frames + i] ==
+                interleaved[i * channels + c] / 32768.0f);
+        }
+      }
+    }
+  }
+}
+
+void TestDot() {
+  test::Random random(6);
+  for (int count : COUNTS) {
+    std::vector<float> a(count), b(count);
+    double magnitude = 0.0;
+    for (int i = 0; i < count; ++i) {
+      a[i] = random.NextFloat();
+      b[i] = random.NextFloat();
+      magnitude += std::fabs(static_cast<double>(a[i]) * b[i]);
+    }
+    // Only the summation order differs, bound by float epsilon per term.
+    CHECK_NEAR(reference::Dot(a.data(), b.data(), count),
+               pcm::Dot(a.data(), b.data(), count), magnitude * 1e-6 + 1e-7);
+  }
+}
+
+void TestMeasure() {
+  test::Random random(7);
+  for (int count : COUNTS) {
+    std::vector<int16_t> samples = Samples(random, count);
+    int peak = 0;
+    double sumOfSquares = 0.0;
+    for (int16_t sample : samples) {
+      int magnitude = sample < 0 ? -sample : sample;
+      peak = magnitude > peak ? magnitude : peak;
+      sumOfSquares += static_cast<double>(sample) * sample;
+    }
+    pcm::Level level = pcm::Measure(samples.data(), count);
+    CHECK_EQ(peak, level.peak);
+    // The vector paths accumulate in float.
+    CHECK_NEAR(sumOfSquares, level.sumOfSquares, sumOfSquares * 1e-5);
+  }
+
+  const int16_t negative[] = {0, -32768, 5, 7, 1, 2, 3, 4, 9};
+  CHECK_EQ(32768, pcm::Measure(negative, 9).peak);
+  const int16_t silence[16] = {};
+  CHECK_EQ(0, pcm::Measure(silence, 16).peak);
+  CHECK(pcm::Measure(silence, 16).sumOfSquares == 0.0);
+}
+} // namespace
+
+int main() {
+  TestGain();
+  TestMixAdd();
+  TestDownmixAndUpmix();
+  TestFloatConversion();
+  TestInt16ToFloatPlanar();
+  TestDot();
+  TestMeasure();
+  return test::Result("PcmKernelsTest");
+}
@@ -0,0 +1,45 @@
+#include "PolyphaseResampler.h"
+
+#include "TestUtil.h"
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const int SECONDS = 20;
+
+// Processing time per second of one channel, and how many times faster than
+// real time that is.
+void Run(int inputRate, int outputRate, int channels) {
+  PolyphaseResampler resampler(inputRate, outputRate, channels);
+  const int frames = inputRate / 100;
+  test::Random random;
+  std::vector<int16_t> input(frames * channels);
+  for (auto &sample : input) {
+    sample = static_cast<int16_t>(random.NextInt16() / 4);
+  }
+  std::vector<int16_t> output(resampler.MaxOutputFrames(frames) * channels);
+
+  double ns = test::NanosPerCall(SECONDS * 100, [&] {
+    resampler.Process(input.data(), frames, output.data());
+  });
+  // 100 frames per second of audio.
+  double usPerChannelSecond = ns * 100 / 1000 / channels;
+  printf("%5d -> %5d Hz x%d: %7.1f us per channel-second, %6.0fx real time\n",
+         inputRate, outputRate, channels, usPerChannelSecond,
+         1e6 / (usPerChannelSecond * channels));
+}
+} // namespace
+
+// Cost of the before-mixing conversions seen in practice, 10 ms frames.
+int main() {
+  Run(48000, 16000, 1);
+  Run(48000, 16000, 2);
+  Run(44100, 48000, 2);
+  Run(48000, 44100, 2);
+  Run(32000, 48000, 1);
+  Run(16000, 48000, 1);
+  Run(8000, 16000, 1);
+  return 0;
+}
@@ -0,0 +1,225 @@
+#include "PolyphaseResampler.h"
+
+#include "TestUtil.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const double PI = 3.14159265358979323846;
+
+// `seconds` of a sine at `frequency` through the resampler in 10 ms frames,
+// returns the first channel of the output.
+std::vector<double> ResampleSine(int inputRate, int outputRate, int channels,
+                                 double frequency, double amplitude,
+                                 double seconds) {
+  PolyphaseResampler resampler(inputRate, outputRate, channels);
+  const int frames = inputRate / 100;
+  std::vector<int16_t> input(frames * channels);
+  std::vector<int16_t> output(resampler.MaxOutputFrames(frames) * channels);
+  std::vector<double> result;
+  long long n = 0;
+  for (int f = 0; f < static_cast<int>(seconds * 100); ++f) {
+    for (int i = 0; i < frames; ++i, ++n) {
+      double value = amplitude * std::sin(2.0 * PI * frequency * n / inputRate);
+      for (int c = 0; c < channels; ++c) {
+        // Later channels are inverted, to catch channels mixing up.
+        input[i * channels + c] =
+            static_cast<int16_t>(std::lround((c % 2 ? -value : value) * 32767));
+      }
+    }
+    int count = resampler.Process(input.data(), frames, output.data());
+    CHECK(count <= resampler.MaxOutputFrames(frames));
+    for (int i = 0; i < count; ++i) {
+      result.push_back(output[i * channels] / 32768.0);
+      if (channels > 1) {
+        CHECK(std::abs(output[i * channels] + output[i * channels + 1]) <= 1);
+      }
+    }
+  }
+  return result;
+}
+
+struct Fit {
+  double amplitude;
+  double snrDb;
+};
+
+// Least-squares fit of a sine at the known `frequency` with free phase, so
+// the filter delay does not matter. Everything the fit leaves over is noise
+// or distortion.
+Fit FitSine(const std::vector<double> &samples, int begin, int rate,
+            double frequency) {
+  double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+  for (size_t n = begin; n < samples.size(); ++n) {
+    double s = std::sin(2.0 * PI * frequency * n / rate);
+    double c = std::cos(2.0 * PI * frequency * n / rate);
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    ys += samples[n] * s;
+    yc += samples[n] * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+
+  double signal = 0, residual = 0;
+  for (size_t n = begin; n < samples.size(); ++n) {
+    double fitted = a * std::sin(2.0 * PI * frequency * n / rate) +
+                    b * std::cos(2.0 * PI * frequency * n / rate);
+    signal += fitted * fitted;
+    residual += (samples[n] - fitted) * (samples[n] - fitted);
+  }
+  Fit fit;
+  fit.amplitude = std::sqrt(a * a + b * b);
+  fit.snrDb = 10.0 * std::log10(signal / residual);
+  return fit;
+}
+
+void CheckSine(int inputRate, int outputRate, int channels, double frequency,
+               double minSnrDb) {
+  std::vector<double> output =
+      ResampleSine(inputRate, outputRate, channels, frequency, 0.5, 1.0);
+  // One second in, one second out, give or take the sample in flight.
+  CHECK(std::abs(static_cast<int>(output.size()) - outputRate) <= 1);
+  // Skip the filter's warm-up, 10 ms is more than its length.
+  Fit fit = FitSine(output, outputRate / 100, outputRate, frequency);
+  printf("%5d -> %5d Hz x%d, %5.0f Hz sine: gain %+.3f dB, SNR %.1f dB\n",
+         inputRate, outputRate, channels, frequency,
+         20.0 * std::log10(fit.amplitude / 0.5), fit.snrDb);
+  // Passband ripple stays within 0.05 dB.
+  CHECK_NEAR(0.5, fit.amplitude, 0.5 * 0.006);
+  CHECK(fit.snrDb > minSnrDb);
+}
+
+void TestSnr() {
+  // int16 output caps a half-scale sine at ~92 dB.
+  CheckSine(48000, 16000, 1, 1000.0, 80.0);
+  CheckSine(48000, 16000, 2, 1000.0, 80.0);
+  CheckSine(16000, 48000, 1, 1000.0, 80.0);
+  CheckSine(44100, 48000, 1, 1000.0, 80.0);
+  CheckSine(48000, 44100, 2, 1000.0, 80.0);
+  CheckSine(32000, 16000, 1, 3000.0, 80.0);
+  CheckSine(8000, 48000, 1, 440.0, 80.0);
+}
+
+void TestAliasRejection() {
+  // 10 kHz is above the 8 kHz Nyquist limit of 16 kHz output and must not
+  // fold back to 6 kHz.
+  std::vector<double> output =
+      ResampleSine(48000, 16000, 1, 10000.0, 0.5, 1.0);
+  double energy = 0;
+  for (size_t n = 160; n < output.size(); ++n) {
+    energy += output[n] * output[n];
+  }
+  // Floored at half an LSB, the output may well be all zeros.
+  double rms = std::sqrt(energy / (output.size() - 160));
+  rms = rms > 0.5 / 32768.0 ? rms : 0.5 / 32768.0;
+  double rejectionDb = 20.0 * std::log10(0.5 / std::sqrt(2.0) / rms);
+  printf("10 kHz alias at 16 kHz output: at least %.1f dB down\n", rejectionDb);
+  CHECK(rejectionDb > 70.0);
+}
+
+void TestSilenceAndReset() {
+  PolyphaseResampler resampler(48000, 16000, 1);
+  std::vector<int16_t> loud(480, 20000), silence(480, 0), output(200);
+  resampler.Process(loud.data(), 480, output.data());
+  // The history still holds the loud frame, a reset forgets it.
+  resampler.Reset();
+  int count = resampler.Process(silence.data(), 480, output.data());
+  CHECK_EQ(160, count);
+  for (int i = 0; i < count; ++i) {
+    CHECK_EQ(0, output[i]);
+  }
+}
+
+void TestUidResamplers() {
+  typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+  UidResamplers resamplers;
+  std::vector<int16_t> pcm(480 * 2, 1000);
+  AudioFrame frame;
+  frame.samplesPerChannel = 480;
+  frame.channels = 2;
+  frame.samplesPerSec = 48000;
+  frame.buffer = pcm.data();
+  frame.renderTimeMs = 1234;
+
+  AudioFrame resampled;
+  // Already at the target rate, left alone.
+  CHECK(!resamplers.Process(1, 48000, frame, resampled, 0));
+
+  CHECK(resamplers.Process(1, 16000, frame, resampled, 0));
+  CHECK_EQ(160, resampled.samplesPerChannel);
+  CHECK_EQ(16000, resampled.samplesPerSec);
+  CHECK_EQ(2, resampled.channels);
+  CHECK_EQ(1234, resampled.renderTimeMs);
+  CHECK(resampled.buffer != frame.buffer);
+
+  // A uid switching to mono gets a new resampler for its new layout.
+  frame.channels = 1;
+  CHECK(resamplers.Process(1, 16000, frame, resampled, 10));
+  CHECK_EQ(1, resampled.channels);
+  CHECK_EQ(160, resampled.samplesPerChannel);
+}
+
+void TestSharedFilters() {
+  std::shared_ptr<const PolyphaseFilter> filter =
+      PolyphaseFilter::Get(44100, 16000);
+  // 160/441, each branch stretched to keep the cutoff sharp.
+  CHECK_EQ(160, filter->up);
+  CHECK_EQ(441, filter->down);
+  CHECK(filter == PolyphaseFilter::Get(44100, 16000));
+  CHECK(filter != PolyphaseFilter::Get(48000, 16000));
+
+  // Resamplers of the same rates share the filter, not just equal copies:
+  // the cache, `filter` and the two resamplers.
+  PolyphaseResampler first(44100, 16000, 1), second(44100, 16000, 2);
+  CHECK_EQ(4, static_cast<int>(filter.use_count()));
+}
+
+void TestIdleUidsDropped() {
+  typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+  UidResamplers resamplers;
+  std::vector<int16_t> pcm(480, 1000);
+  AudioFrame frame;
+  frame.samplesPerChannel = 480;
+  frame.channels = 1;
+  frame.samplesPerSec = 48000;
+  frame.buffer = pcm.data();
+  AudioFrame resampled;
+
+  // uid 1 leaves after a second, uid 2 keeps talking.
+  long long nowMs = 0;
+  for (; nowMs < 1000; nowMs += 10) {
+    resamplers.Process(1, 16000, frame, resampled, nowMs);
+    resamplers.Process(2, 16000, frame, resampled, nowMs);
+  }
+  CHECK_EQ(2, resamplers.size());
+  for (; nowMs < 1000 + UidResamplers::IDLE_MS; nowMs += 10) {
+    resamplers.Process(2, 16000, frame, resampled, nowMs);
+  }
+  CHECK_EQ(2, resamplers.size());
+  for (; nowMs < 3000 + UidResamplers::IDLE_MS; nowMs += 10) {
+    resamplers.Process(2, 16000, frame, resampled, nowMs);
+  }
+  CHECK_EQ(1, resamplers.size());
+
+  // A returning uid starts over.
+  CHECK(resamplers.Process(1, 16000, frame, resampled, nowMs));
+  CHECK_EQ(160, resampled.samplesPerChannel);
+  CHECK_EQ(2, resamplers.size());
+}
+} // namespace
+
+int main() {
+  TestSnr();
+  TestAliasRejection();
+  TestSilenceAndReset();
+  TestUidResamplers();
+  TestSharedFilters();
+  TestIdleUidsDropped();
+  return test::Result("PolyphaseResamplerTest");
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+// Minimal checks for the host tests of cpp/android, which only build the
+// sources that do not depend on JNI or the Android NDK.
+namespace agora {
+namespace test {
+inline int &Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+// Deterministic xorshift generator, so every run sees the same input.
+class Random {
+public:
+  explicit Random(uint32_t seed = 0x12345678u) : state(seed ? seed : 1) {}
+
+  uint32_t Next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  int16_t NextInt16() { return static_cast<int16_t>(Next() >> 16); }
+
+  // Uniform in [-1, 1).
+  float NextFloat() {
+    return static_cast<float>(static_cast<int32_t>(Next())) / 2147483648.0f;
+  }
+
+private:
+  uint32_t state;
+};
+
+// Wall time of `iterations` calls of `body`, in nanoseconds per call.
+template <typename Body>
+double NanosPerCall(int iterations, Body body) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         iterations;
+}
+
+inline int Result(const char *name) {
+  if (Failures() == 0) {
+    printf("%s: passed\n", name);
+    return 0;
+  }
+  printf("%s: %d check(s) failed\n", name, Failures());
+  return 1;
+}
+} // namespace test
+} // namespace agora
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);     \
+      ++agora::test::Failures();                                               \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_EQ(expected, actual)                                             \
+  do {                                                                         \
+    auto e_ = (expected);                                                      \
+    auto a_ = (actual);                                                        \
+    if (!(e_ == a_)) {                                                         \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__,       \
+             __LINE__, #expected, #actual, static_cast<long long>(e_),         \
+             static_cast<long long>(a_));                                      \
+      ++agora::test::Failures();                                               \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_NEAR(expected, actual, tolerance)                                \
+  do {                                                                         \
+    double e_ = (expected);                                                    \
+    double a_ = (actual);                                                      \
+    if (!(e_ - a_ <= (tolerance) && a_ - e_ <= (tolerance))) {                 \
+      printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g != %g\n", __FILE__,         \
+             __LINE__, #expected, #actual, e_, a_);                            \
+      ++agora::test::Failures();                                               \
+    }                                                                          \
+  } while (0)
@@ -0,0 +1,108 @@
+#include "UidFilter.h"
+
+#include "TestUtil.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+void TestFlatUidSet() {
+  FlatUidSet none;
+  CHECK(none.empty());
+  CHECK(!none.contains(0));
+  CHECK(!none.contains(1));
+
+  // 0 is the free-slot marker and kept aside, duplicates count once.
+  const rtc::uid_t uids[] = {0, 7, 7, 0xffffffffu, 1000};
+  FlatUidSet set(uids, 5);
+  CHECK(!set.empty());
+  CHECK(set.contains(0));
+  CHECK(set.contains(7));
+  CHECK(set.contains(0xffffffffu));
+  CHECK(set.contains(1000));
+  CHECK(!set.contains(8));
+  CHECK(!set.contains(0xfffffffeu));
+}
+
+void TestSequentialUids() {
+  // Uids handed out in sequence, the common case the hash mixes for.
+  std::vector<rtc::uid_t> uids;
+  for (rtc::uid_t uid = 1; uid <= 1000; ++uid) {
+    uids.push_back(uid);
+  }
+  FlatUidSet set(uids.data(), static_cast<int>(uids.size()));
+  for (rtc::uid_t uid = 1; uid <= 1000; ++uid) {
+    CHECK(set.contains(uid));
+  }
+  for (rtc::uid_t uid = 1001; uid <= 3000; ++uid) {
+    CHECK(!set.contains(uid));
+  }
+  CHECK(!set.contains(0));
+}
+
+void TestFilter() {
+  UidFilter filter;
+  // No lists, every uid passes.
+  CHECK(filter.accepts(0));
+  CHECK(filter.accepts(42));
+
+  const rtc::uid_t deny[] = {2};
+  filter.set(nullptr, -1, deny, 1);
+  CHECK(filter.accepts(1));
+  CHECK(!filter.accepts(2));
+
+  const rtc::uid_t allow[] = {1, 2, 3};
+  filter.set(allow, 3, deny, 1);
+  CHECK(filter.accepts(1));
+  // The deny-list wins over the allow-list.
+  CHECK(!filter.accepts(2));
+  CHECK(filter.accepts(3));
+  CHECK(!filter.accepts(4));
+
+  // An empty allow-list lets nothing pass.
+  filter.set(nullptr, 0, nullptr, 0);
+  CHECK(!filter.accepts(1));
+  CHECK(!filter.accepts(0));
+
+  filter.clear();
+  CHECK(filter.accepts(1));
+  CHECK(filter.accepts(2));
+}
+
+void TestConcurrentReplace() {
+  UidFilter filter;
+  const rtc::uid_t odd[] = {1, 3, 5};
+  const rtc::uid_t even[] = {2, 4, 6};
+  std::atomic<bool> done(false);
+  // Whatever the writer does, the reader sees one whole pair of lists: uid 7
+  // is on neither allow-list and never passes.
+  filter.set(odd, 3, nullptr, 0);
+  std::thread writer([&] {
+    for (int i = 0; i < 20000; ++i) {
+      if (i % 2) {
+        filter.set(odd, 3, nullptr, 0);
+      } else {
+        filter.set(even, 3, nullptr, 0);
+      }
+    }
+    done = true;
+  });
+  while (!done) {
+    CHECK(!filter.accepts(7));
+  }
+  writer.join();
+  CHECK(filter.accepts(1));
+  CHECK(!filter.accepts(2));
+}
+} // namespace
+
+int main() {
+  TestFlatUidSet();
+  TestSequentialUids();
+  TestFilter();
+  TestConcurrentReplace();
+  return test::Result("UidFilterTest");
+}
@@ -0,0 +1,188 @@
+#include "AlignedBufferPool.h"
+#include "JavaBufferPool.h"
+#include "PixelFormatLayout.h"
+#include "PlaneKernels.h"
+
+#include "TestUtil.h"
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const int FRAMES = 10000;
+
+// An SDK I420 frame with a padded luma stride, as decoders hand them out.
+struct SdkFrame {
+  SdkFrame(int width, int height) : width(width), height(height) {
+    const pixel::PlaneLayout layout =
+        pixel::GetPlaneLayout(media::base::VIDEO_PIXEL_I420);
+    for (int i = 0; i < 3; ++i) {
+      rowBytes[i] = pixel::PlaneRowBytes(layout, i, width);
+      strides[i] = (rowBytes[i] + 63) & ~63;
+      rows[i] = pixel::PlaneRows(layout, i, height);
+      planes[i].resize(static_cast<size_t>(strides[i]) * rows[i], 0x80);
+    }
+  }
+
+  int width, height;
+  int rowBytes[3], strides[3], rows[3];
+  std::vector<uint8_t> planes[3];
+};
+
+struct Result {
+  double ns;
+  long long bytesCopied;
+  long long allocations;
+  // Java heap bytes, what the garbage collector has to reclaim.
+  long long allocatedBytes;
+  // Native blocks, BUFFER_TYPE_CONTIGUOUS only.
+  long long blocks;
+};
+
+// The path before pooling: every callback allocates three byte[]s of stride
+// times rows, padding included, copies into them and back, and drops them
+// for the garbage collector.
+Result NewByteArrays(SdkFrame &frame) {
+  JNIEnv env;
+  Result result = {0, 0, 0, 0, 0};
+  result.ns = test::NanosPerCall(FRAMES, [&] {
+    jbyteArray arrays[3];
+    for (int i = 0; i < 3; ++i) {
+      int length = frame.strides[i] * frame.rows[i];
+      arrays[i] = env.NewByteArray(length);
+      env.SetByteArrayRegion(
+          arrays[i], 0, length,
+          reinterpret_cast<const jbyte *>(frame.planes[i].data()));
+      result.bytesCopied += length;
+    }
+    for (int i = 0; i < 3; ++i) {
+      int length = env.GetArrayLength(arrays[i]);
+      env.GetByteArrayRegion(arrays[i], 0, length,
+                             reinterpret_cast<jbyte *>(frame.planes[i].data()));
+      env.DeleteLocalRef(arrays[i]);
+      result.bytesCopied += length;
+    }
+  });
+  result.allocations = env.byteArrays + env.byteBuffers;
+  result.allocatedBytes = env.byteArrayBytes;
+  return result;
+}
+
+// BUFFER_TYPE_BYTE_ARRAY: every plane is copied into a pooled byte[] and back
+// after the callback.
+Result ByteArrays(SdkFrame &frame) {
+  JNIEnv env;
+  JavaBufferPool pool(12);
+  Result result = {0, 0, 0, 0, 0};
+  result.ns = test::NanosPerCall(FRAMES, [&] {
+    jbyteArray arrays[3];
+    for (int i = 0; i < 3; ++i) {
+      int length = frame.rowBytes[i] * frame.rows[i];
+      arrays[i] = pool.ByteArray(&env, length, i);
+      void *array = env.GetPrimitiveArrayCritical(arrays[i], nullptr);
+      pixel::CopyPlane(frame.planes[i].data(), frame.strides[i],
+                       static_cast<uint8_t *>(array), frame.rowBytes[i],
+                       frame.rowBytes[i], frame.rows[i]);
+      env.ReleasePrimitiveArrayCritical(arrays[i], array, 0);
+      result.bytesCopied += length;
+    }
+    for (int i = 0; i < 3; ++i) {
+      void *array = env.GetPrimitiveArrayCritical(arrays[i], nullptr);
+      pixel::CopyPlane(static_cast<const uint8_t *>(array), frame.rowBytes[i],
+                       frame.planes[i].data(), frame.strides[i],
+                       frame.rowBytes[i], frame.rows[i]);
+      env.ReleasePrimitiveArrayCritical(arrays[i], array, JNI_ABORT);
+      result.bytesCopied += frame.rowBytes[i] * frame.rows[i];
+    }
+  });
+  result.allocations = env.byteArrays + env.byteBuffers;
+  result.allocatedBytes = env.byteArrayBytes;
+  pool.Release(&env);
+  return result;
+}
+
+// BUFFER_TYPE_DIRECT_BYTE_BUFFER: the planes are wrapped where they are.
+Result DirectBuffers(SdkFrame &frame) {
+  JNIEnv env;
+  JavaBufferPool pool(12);
+  Result result = {0, 0, 0, 0, 0};
+  result.ns = test::NanosPerCall(FRAMES, [&] {
+    for (int i = 0; i < 3; ++i) {
+      pool.DirectByteBuffer(&env, frame.planes[i].data(),
+                            frame.strides[i] * frame.rows[i]);
+    }
+  });
+  result.allocations = env.byteArrays + env.byteBuffers;
+  result.allocatedBytes = env.byteArrayBytes;
+  pool.Release(&env);
+  return result;
+}
+
+// BUFFER_TYPE_CONTIGUOUS: the planes are copied into one pooled aligned block
+// behind a single ByteBuffer, and back after the callback.
+Result Contiguous(SdkFrame &frame) {
+  JNIEnv env;
+  JavaBufferPool pool(12);
+  AlignedBufferPool blockPool;
+  Result result = {0, 0, 0, 0, 0};
+  result.ns = test::NanosPerCall(FRAMES, [&] {
+    int offsets[3];
+    int total = 0;
+    for (int i = 0; i < 3; ++i) {
+      offsets[i] = total;
+      total =
+          AlignedBufferPool::Align(total + frame.rowBytes[i] * frame.rows[i]);
+    }
+    AlignedBufferPool::Block block = blockPool.Acquire(total);
+    for (int i = 0; i < 3; ++i) {
+      pixel::CopyPlane(frame.planes[i].data(), frame.strides[i],
+                       block.data + offsets[i], frame.rowBytes[i],
+                       frame.rowBytes[i], frame.rows[i]);
+      result.bytesCopied += frame.rowBytes[i] * frame.rows[i];
+    }
+    pool.DirectByteBuffer(&env, block.data, block.capacity);
+    for (int i = 0; i < 3; ++i) {
+      pixel::CopyPlane(block.data + offsets[i], frame.rowBytes[i],
+                       frame.planes[i].data(), frame.strides[i],
+                       frame.rowBytes[i], frame.rows[i]);
+      result.bytesCopied += frame.rowBytes[i] * frame.rows[i];
+    }
+    blockPool.Recycle(block);
+  });
+  result.allocations = env.byteArrays + env.byteBuffers;
+  result.allocatedBytes = env.byteArrayBytes;
+  result.blocks = blockPool.allocations();
+  pool.Release(&env);
+  return result;
+}
+
+void Report(const char *mode, const Result &result) {
+  double copied = static_cast<double>(result.bytesCopied) / FRAMES;
+  double allocations = static_cast<double>(result.allocations) / FRAMES;
+  double allocatedBytes = static_cast<double>(result.allocatedBytes) / FRAMES;
+  printf("  %-10s %9.1f us  %9.0f bytes copied  %8.4f Java allocations "
+         "and %9.0f bytes per frame (%lld total), %lld native blocks\n",
+         mode, result.ns / 1000, copied, allocations, allocatedBytes,
+         result.allocations, result.blocks);
+}
+
+void Run(int width, int height) {
+  SdkFrame frame(width, height);
+  printf("%dx%d I420, %d frames:\n", width, height, FRAMES);
+  Report("original", NewByteArrays(frame));
+  Report("byte[]", ByteArrays(frame));
+  Report("direct", DirectBuffers(frame));
+  Report("contiguous", Contiguous(frame));
+}
+} // namespace
+
+// Native cost per video frame of handing it to Java, by buffer type. The
+// Java heap is the fake one of fake/jni.h, so the allocation counts are exact
+// while the times leave out the VM.
+int main() {
+  Run(640, 360);
+  Run(1280, 720);
+  Run(1920, 1080);
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include "VideoFrameObserver.h"
+
+#include "TestUtil.h"
+
+#include <vector>
+
+using namespace agora;
+
+namespace {
+const int FRAMES = 10000;
+
+// I420 with padded rows, as the SDK often delivers it.
+const int WIDTH = 64;
+const int HEIGHT = 36;
+const int PADDING = 16;
+
+// What VideoFrame.VideoFrameType.getValue() returns, see VideoFrame.java.
+const std::vector<jint> VIDEO_FRAME_TYPES = {1, 2, 3, 4, 8, 16, 18};
+
+// A frame as the SDK hands it over, over its own planes.
+struct SdkFrame {
+  SdkFrame()
+      : y((WIDTH + PADDING) * HEIGHT),
+        u((WIDTH / 2 + PADDING) * HEIGHT / 2),
+        v((WIDTH / 2 + PADDING) * HEIGHT / 2) {
+    frame.type = media::base::VIDEO_PIXEL_I420;
+    frame.width = WIDTH;
+    frame.height = HEIGHT;
+    frame.yStride = WIDTH + PADDING;
+    frame.uStride = WIDTH / 2 + PADDING;
+    frame.vStride = WIDTH / 2 + PADDING;
+    frame.yBuffer = y.data();
+    frame.uBuffer = u.data();
+    frame.vBuffer = v.data();
+  }
+
+  media::base::VideoFrame frame;
+  std::vector<uint8_t> y, u, v;
+};
+
+jobject NewCaller(JNIEnv &env) {
+  jobject caller = env.NewObject(nullptr, nullptr);
+  env.newObjects = 0;
+  return caller;
+}
+
+// The first luma sample as Java sees it, for each buffer type.
+uint8_t *JavaLuma(fake::Object *jFrame, int bufferType) {
+  switch (bufferType) {
+  case VideoFrameObserver::BUFFER_TYPE_BYTE_ARRAY: {
+    auto *array = static_cast<fake::ByteArray *>(jFrame->objects["yBuffer"]);
+    return reinterpret_cast<uint8_t *>(array->data.data());
+  }
+  case VideoFrameObserver::BUFFER_TYPE_DIRECT_BYTE_BUFFER: {
+    auto *buffer =
+        static_cast<fake::ByteBuffer *>(jFrame->objects["yByteBuffer"]);
+    return static_cast<uint8_t *>(buffer->address);
+  }
+  default: {
+    auto *buffer =
+        static_cast<fake::ByteBuffer *>(jFrame->objects["contiguousBuffer"]);
+    return static_cast<uint8_t *>(buffer->address) + jFrame->values["yOffset"];
+  }
+  }
+}
+
+// Java marks the first luma sample of every frame, the mark has to reach the
+// SDK plane whether it was copied back or written in place. Once every stream
+// has seen a frame, nothing more is allocated on the Java heap.
+void CheckMarshallingStaysFlat(int bufferType, int planeMode) {
+  JNIEnv env;
+  env.enumValues = VIDEO_FRAME_TYPES;
+  jobject caller = NewCaller(env);
+  {
+    VideoFrameObserver observer(&env, caller, 0, bufferType, planeMode,
+                                VideoFrameObserver::Preferences());
+    CHECK_EQ(0, env.newObjects);
+
+    SdkFrame capture, remotes[2];
+    SdkFrame *frames[3] = {&capture, &remotes[0], &remotes[1]};
+    SdkFrame *current = nullptr;
+    uint8_t mark = 0;
+    int aliased = 0, typed = 0;
+    env.onCall = [&](const std::string &, jobject frame) {
+      auto *jFrame = static_cast<fake::Object *>(JNIEnv::Target(frame));
+      uint8_t *luma = JavaLuma(jFrame, bufferType);
+      aliased += luma == current->y.data();
+      auto *type = static_cast<fake::Object *>(jFrame->objects["type"]);
+      typed += type && type->values["value"] == media::base::VIDEO_PIXEL_I420;
+      *luma = mark;
+      return JNI_TRUE;
+    };
+
+    long long newObjects = 0, byteArrays = 0, byteBuffers = 0, localRefs = 0;
+    int wrong = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+      for (int f = 0; f < 3; ++f) {
+        current = frames[f];
+        mark = static_cast<uint8_t>(i * 3 + f);
+        bool ret = f == 0 ? observer.onCaptureVideoFrame(
+                                rtc::VIDEO_SOURCE_CAMERA_PRIMARY,
+                                current->frame)
+                          : observer.onRenderVideoFrame("", 1000 + f,
+                                                        current->frame);
+        CHECK(ret);
+        wrong += current->y[0] != mark;
+      }
+      if (i == 0) {
+        newObjects = env.newObjects;
+        byteArrays = env.byteArrays;
+        byteBuffers = env.byteBuffers;
+        localRefs = env.localRefs;
+      }
+    }
+    CHECK_EQ(0, wrong);
+    CHECK_EQ(3 * FRAMES, typed);
+    if (bufferType == VideoFrameObserver::BUFFER_TYPE_DIRECT_BYTE_BUFFER) {
+      CHECK_EQ(3 * FRAMES, aliased);
+    } else {
+      CHECK_EQ(0, aliased);
+    }
+
+    // One VideoFrame per stream.
+    CHECK_EQ(3, newObjects);
+    CHECK_EQ(newObjects, env.newObjects);
+    CHECK_EQ(byteArrays, env.byteArrays);
+    CHECK_EQ(byteBuffers, env.byteBuffers);
+    CHECK_EQ(localRefs, env.localRefs);
+    CHECK_EQ(0, env.primitiveArrays);
+  }
+  CHECK_EQ(0, env.globalRefs);
+  env.DeleteLocalRef(caller);
+}
+
+void TestByteArraysStayFlat() {
+  CheckMarshallingStaysFlat(VideoFrameObserver::BUFFER_TYPE_BYTE_ARRAY,
+                            VideoFrameObserver::PLANE_MODE_STRIDED);
+  CheckMarshallingStaysFlat(VideoFrameObserver::BUFFER_TYPE_BYTE_ARRAY,
+                            VideoFrameObserver::PLANE_MODE_PACKED);
+}
+
+void TestDirectBuffersStayFlat() {
+  CheckMarshallingStaysFlat(
+      VideoFrameObserver::BUFFER_TYPE_DIRECT_BYTE_BUFFER,
+      VideoFrameObserver::PLANE_MODE_STRIDED);
+}
+
+void TestContiguousBuffersStayFlat() {
+  CheckMarshallingStaysFlat(VideoFrameObserver::BUFFER_TYPE_CONTIGUOUS,
+                            VideoFrameObserver::PLANE_MODE_STRIDED);
+  CheckMarshallingStaysFlat(VideoFrameObserver::BUFFER_TYPE_CONTIGUOUS,
+                            VideoFrameObserver::PLANE_MODE_PACKED);
+}
+} // namespace
+
+int main() {
+  TestByteArraysStayFlat();
+  TestDirectBuffersStayFlat();
+  TestContiguousBuffersStayFlat();
+  return test::Result("VideoFrameObserverTest");
+}
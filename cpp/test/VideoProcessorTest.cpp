@@ -0,0 +1,232 @@
+#include "VideoProcessor.h"
+
+#include "PixelFormatLayout.h"
+#include "TestUtil.h"
+
+#include <string.h>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef media::base::VIDEO_PIXEL_FORMAT FORMAT;
+
+// Bytes of padding after every row, and what they hold. Processors must
+// never write there.
+const int PADDING = 13;
+const uint8_t PAD_BYTE = 0xee;
+
+// Odd sizes, so chroma rounds up.
+const int WIDTH = 37;
+const int HEIGHT = 21;
+
+// A frame whose planes sit in padded rows, with a pattern that covers the
+// whole sample range so saturation is exercised.
+class Frame {
+public:
+  Frame(FORMAT type, int width, int height)
+      : layout(pixel::GetPlaneLayout(type)),
+        unit(type == media::base::VIDEO_PIXEL_I010 ? 2 : 1),
+        maxValue(type == media::base::VIDEO_PIXEL_I010 ? 1023 : 255) {
+    frame.type = type;
+    frame.width = width;
+    frame.height = height;
+    uint8_t *buffers[3] = {nullptr, nullptr, nullptr};
+    int *strideFields[3] = {&frame.yStride, &frame.uStride, &frame.vStride};
+    for (int p = 0; p < layout.planeCount; ++p) {
+      rowBytes[p] = pixel::PlaneRowBytes(layout, p, width);
+      rows[p] = pixel::PlaneRows(layout, p, height);
+      strides[p] = rowBytes[p] + PADDING;
+      planes[p].assign(static_cast<size_t>(strides[p]) * rows[p], PAD_BYTE);
+      for (int y = 0; y < rows[p]; ++y) {
+        for (int x = 0; x < rowBytes[p] / unit; ++x) {
+          Set(p, x, y, (x * 29 + y * 31 + p * 7) % (maxValue + 1));
+        }
+      }
+      buffers[p] = planes[p].data();
+      *strideFields[p] = strides[p];
+    }
+    // The extremes, whatever the pattern happens to hit.
+    Set(0, 0, 0, 0);
+    Set(0, 1, 0, maxValue);
+    frame.yBuffer = buffers[0];
+    frame.uBuffer = buffers[1];
+    frame.vBuffer = buffers[2];
+    for (int p = 0; p < 3; ++p) {
+      original[p] = planes[p];
+    }
+  }
+
+  // Sample `x` of row `y`, a byte or for I010 a 16-bit word.
+  int Get(int plane, int x, int y) const {
+    return Read(planes[plane], plane, x, y);
+  }
+
+  int Original(int plane, int x, int y) const {
+    return Read(original[plane], plane, x, y);
+  }
+
+  int Samples(int plane) const { return rowBytes[plane] / unit; }
+
+  bool PaddingIntact(int plane) const {
+    for (int y = 0; y < rows[plane]; ++y) {
+      for (int x = rowBytes[plane]; x < strides[plane]; ++x) {
+        if (planes[plane][static_cast<size_t>(y) * strides[plane] + x] !=
+            PAD_BYTE) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool Unchanged(int plane) const { return planes[plane] == original[plane]; }
+
+  media::base::VideoFrame frame;
+  const pixel::PlaneLayout layout;
+  const int unit;
+  const int maxValue;
+  int rowBytes[3] = {0, 0, 0};
+  int rows[3] = {0, 0, 0};
+
+private:
+  void Set(int plane, int x, int y, int value) {
+    uint8_t *sample = &planes[plane][static_cast<size_t>(y) * strides[plane] +
+                                     x * unit];
+    if (unit == 2) {
+      uint16_t word = static_cast<uint16_t>(value);
+      memcpy(sample, &word, 2);
+    } else {
+      *sample = static_cast<uint8_t>(value);
+    }
+  }
+
+  int Read(const std::vector<uint8_t> &bytes, int plane, int x, int y) const {
+    const uint8_t *sample =
+        &bytes[static_cast<size_t>(y) * strides[plane] + x * unit];
+    if (unit == 2) {
+      uint16_t word;
+      memcpy(&word, sample, 2);
+      return word;
+    }
+    return *sample;
+  }
+
+  int strides[3] = {0, 0, 0};
+  std::vector<uint8_t> planes[3];
+  std::vector<uint8_t> original[3];
+};
+
+// Chroma value expected at sample `x` of `plane` after filling with (u, v).
+int ExpectedChroma(FORMAT type, int plane, int x, int u, int v) {
+  switch (type) {
+  case media::base::VIDEO_PIXEL_NV12:
+    return x % 2 ? v : u;
+  case media::base::VIDEO_PIXEL_NV21:
+    return x % 2 ? u : v;
+  case media::base::VIDEO_PIXEL_I010:
+    return (plane == 1 ? u : v) << 2;
+  default:
+    return plane == 1 ? u : v;
+  }
+}
+
+void CheckFillChroma(FORMAT type) {
+  Frame frame(type, WIDTH, HEIGHT);
+  FillChromaVideoProcessor processor(60, 200);
+  CHECK(processor.process(frame.frame, 0));
+
+  CHECK(frame.Unchanged(0));
+  for (int p = 1; p < frame.layout.planeCount; ++p) {
+    int wrong = 0;
+    for (int y = 0; y < frame.rows[p]; ++y) {
+      for (int x = 0; x < frame.Samples(p); ++x) {
+        wrong += frame.Get(p, x, y) != ExpectedChroma(type, p, x, 60, 200);
+      }
+    }
+    CHECK_EQ(0, wrong);
+  }
+  for (int p = 0; p < frame.layout.planeCount; ++p) {
+    CHECK(frame.PaddingIntact(p));
+  }
+}
+
+void CheckLumaOffset(FORMAT type, int offset) {
+  Frame frame(type, WIDTH, HEIGHT);
+  LumaOffsetVideoProcessor processor(offset);
+  CHECK(processor.process(frame.frame, 0));
+
+  const int scaled = frame.unit == 2 ? offset << 2 : offset;
+  int wrong = 0, saturated = 0;
+  for (int y = 0; y < frame.rows[0]; ++y) {
+    for (int x = 0; x < frame.Samples(0); ++x) {
+      int expected = frame.Original(0, x, y) + scaled;
+      if (expected < 0 || expected > frame.maxValue) {
+        ++saturated;
+        expected = expected < 0 ? 0 : frame.maxValue;
+      }
+      wrong += frame.Get(0, x, y) != expected;
+    }
+  }
+  CHECK_EQ(0, wrong);
+  CHECK(saturated > 0);
+  // Saturates at the extremes rather than wrapping.
+  if (offset > 0) {
+    CHECK_EQ(frame.maxValue, frame.Get(0, 1, 0));
+  } else {
+    CHECK_EQ(0, frame.Get(0, 0, 0));
+  }
+  for (int p = 1; p < frame.layout.planeCount; ++p) {
+    CHECK(frame.Unchanged(p));
+  }
+  for (int p = 0; p < frame.layout.planeCount; ++p) {
+    CHECK(frame.PaddingIntact(p));
+  }
+}
+
+const FORMAT FORMATS[] = {
+    media::base::VIDEO_PIXEL_I420, media::base::VIDEO_PIXEL_NV12,
+    media::base::VIDEO_PIXEL_NV21, media::base::VIDEO_PIXEL_I422,
+    media::base::VIDEO_PIXEL_I010,
+};
+
+void TestFillChroma() {
+  for (FORMAT type : FORMATS) {
+    CheckFillChroma(type);
+  }
+}
+
+void TestLumaOffset() {
+  for (FORMAT type : FORMATS) {
+    CheckLumaOffset(type, 100);
+    CheckLumaOffset(type, -100);
+  }
+}
+
+void TestOtherFormatsPass() {
+  // RGBA has no chroma plane to fill and no luma to offset.
+  Frame frame(media::base::VIDEO_PIXEL_RGBA, WIDTH, HEIGHT);
+  FillChromaVideoProcessor fill;
+  LumaOffsetVideoProcessor luma(50);
+  CHECK(fill.process(frame.frame, 0));
+  CHECK(luma.process(frame.frame, 0));
+  CHECK(frame.Unchanged(0));
+  CHECK(frame.PaddingIntact(0));
+}
+
+void TestCreate() {
+  std::map<std::string, double> params;
+  params["offset"] = 10;
+  CHECK(CreateVideoProcessor("lumaOffset", params) != nullptr);
+  CHECK(CreateVideoProcessor("fillChroma", params) != nullptr);
+  CHECK(CreateVideoProcessor("sharpen", params) == nullptr);
+}
+} // namespace
+
+int main() {
+  TestFillChroma();
+  TestLumaOffset();
+  TestOtherFormatsPass();
+  TestCreate();
+  return test::Result("VideoProcessorTest");
+}
@@ -0,0 +1,236 @@
+#include "VoiceActivityDetector.h"
+
+#include "TestUtil.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace agora;
+
+namespace {
+typedef media::IAudioFrameObserverBase::AudioFrame AudioFrame;
+
+const double PI = 3.14159265358979323846;
+
+enum SIGNAL {
+  SIGNAL_SILENCE,
+  // Noise 70 dB down, what a muted microphone still picks up.
+  SIGNAL_ROOM_NOISE,
+  SIGNAL_WHITE_NOISE,
+  SIGNAL_TONE,
+  // Harmonics of 140 Hz shaped by two formant-like resonances, with a
+  // syllable-rate envelope: a voiced vowel as far as the features go.
+  SIGNAL_SPEECH,
+};
+
+// A deterministic corpus: tones follow the running sample index, so frames
+// join seamlessly, and noise comes from a fixed seed.
+class Corpus {
+public:
+  Corpus(int sampleRate, int channels)
+      : sampleRate(sampleRate), channels(channels),
+        samples(sampleRate / 100 * channels) {
+    frame.type = media::IAudioFrameObserverBase::FRAME_TYPE_PCM16;
+    frame.samplesPerChannel = sampleRate / 100;
+    frame.bytesPerSample = rtc::TWO_BYTES_PER_SAMPLE;
+    frame.channels = channels;
+    frame.samplesPerSec = sampleRate;
+    frame.buffer = samples.data();
+  }
+
+  // The next 10 ms of `signal`.
+  const AudioFrame &Next(SIGNAL signal) {
+    for (int i = 0; i < frame.samplesPerChannel; ++i, ++index) {
+      int16_t value = Sample(signal, index);
+      for (int c = 0; c < channels; ++c) {
+        samples[i * channels + c] = value;
+      }
+    }
+    return frame;
+  }
+
+private:
+  int16_t Sample(SIGNAL signal, long long n) {
+    double t = static_cast<double>(n) / sampleRate;
+    double value = 0.0;
+    switch (signal) {
+    case SIGNAL_SILENCE:
+      break;
+    case SIGNAL_ROOM_NOISE:
+      value = random.NextFloat() * 0.0003;
+      break;
+    case SIGNAL_WHITE_NOISE:
+      value = random.NextFloat() * 0.3;
+      break;
+    case SIGNAL_TONE:
+      value = 0.3 * std::sin(2.0 * PI * 1000.0 * t);
+      break;
+    case SIGNAL_SPEECH: {
+      // Harmonics of 140 Hz weighted by resonances at 700 and 1200 Hz.
+      for (int h = 1; h * 140.0 < 4000.0; ++h) {
+        double f = h * 140.0;
+        double weight = 1.0 / (1.0 + std::pow((f - 700.0) / 150.0, 2)) +
+                        0.6 / (1.0 + std::pow((f - 1200.0) / 200.0, 2));
+        value += weight * std::sin(2.0 * PI * f * t + h);
+      }
+      value *= 0.08 * (0.6 + 0.4 * std::sin(2.0 * PI * 4.0 * t));
+      break;
+    }
+    }
+    return static_cast<int16_t>(value * 32767.0);
+  }
+
+private:
+  const int sampleRate;
+  const int channels;
+  std::vector<int16_t> samples;
+  AudioFrame frame;
+  long long index = 0;
+  test::Random random;
+};
+
+// A stretch of the corpus and whether its last frame should pass the gate.
+struct Segment {
+  SIGNAL signal;
+  int frames;
+  bool speakingAtEnd;
+};
+
+// Feeds `segments` in order and checks the gate at the end of each, and that
+// the events alternate start/end and agree with the gate.
+void RunCorpus(int sampleRate, int channels, const Segment *segments,
+               int count) {
+  VoiceActivityDetector detector;
+  Corpus corpus(sampleRate, channels);
+  bool speaking = false;
+  for (int s = 0; s < count; ++s) {
+    for (int i = 0; i < segments[s].frames; ++i) {
+      bool wasSpeaking = speaking;
+      VoiceActivityDetector::EVENT event =
+          detector.Process(7, corpus.Next(segments[s].signal), speaking);
+      if (event == VoiceActivityDetector::EVENT_SPEECH_START) {
+        CHECK(!wasSpeaking && speaking);
+      } else if (event == VoiceActivityDetector::EVENT_SPEECH_END) {
+        CHECK(wasSpeaking && !speaking);
+      } else {
+        CHECK_EQ(wasSpeaking, speaking);
+      }
+    }
+    if (speaking != segments[s].speakingAtEnd) {
+      printf("%d Hz x%d, segment %d: gate %d, expected %d\n", sampleRate,
+             channels, s, speaking, segments[s].speakingAtEnd);
+    }
+    CHECK_EQ(segments[s].speakingAtEnd, speaking);
+  }
+}
+
+void TestFeatures() {
+  VoiceActivityDetector detector;
+  Corpus corpus(48000, 1);
+
+  VoiceActivityDetector::Features silence =
+      detector.Analyze(corpus.Next(SIGNAL_SILENCE));
+  CHECK(silence.dbfs <= -100.0f);
+
+  VoiceActivityDetector::Features noise =
+      detector.Analyze(corpus.Next(SIGNAL_WHITE_NOISE));
+  CHECK(noise.dbfs > -20.0f);
+  CHECK(noise.flatness > 0.45f);
+  CHECK(noise.zeroCrossingRate > 0.4f);
+
+  VoiceActivityDetector::Features tone =
+      detector.Analyze(corpus.Next(SIGNAL_TONE));
+  // 0.3 full scale sine, -13.5 dBFS RMS, 2 crossings per 48 samples.
+  CHECK_NEAR(-13.5, tone.dbfs, 0.2);
+  CHECK_NEAR(2.0 / 48.0, tone.zeroCrossingRate, 0.005);
+  CHECK(tone.flatness < 0.05f);
+
+  VoiceActivityDetector::Features speech =
+      detector.Analyze(corpus.Next(SIGNAL_SPEECH));
+  CHECK(speech.dbfs > -45.0f);
+  CHECK(speech.flatness < 0.45f);
+  CHECK(speech.zeroCrossingRate < 0.4f);
+}
+
+void TestCorpus() {
+  // Defaults: 3 speech frames to start, 30 non-speech frames to end.
+  const Segment segments[] = {
+      {SIGNAL_SILENCE, 50, false},
+      {SIGNAL_ROOM_NOISE, 50, false},
+      {SIGNAL_WHITE_NOISE, 100, false},
+      // Two speech frames are not enough to start.
+      {SIGNAL_SPEECH, 2, false},
+      {SIGNAL_SILENCE, 5, false},
+      {SIGNAL_SPEECH, 3, true},
+      {SIGNAL_SPEECH, 100, true},
+      // A 200 ms pause stays inside the utterance.
+      {SIGNAL_SILENCE, 20, true},
+      {SIGNAL_SPEECH, 100, true},
+      // Noise ends it like silence does, after the hangover.
+      {SIGNAL_WHITE_NOISE, 29, true},
+      {SIGNAL_WHITE_NOISE, 1, false},
+      {SIGNAL_SILENCE, 50, false},
+      // A steady tone is peaky and loud: indistinguishable from a vowel by
+      // these features, so it opens the gate.
+      {SIGNAL_TONE, 10, true},
+      {SIGNAL_ROOM_NOISE, 30, false},
+  };
+  const int count = sizeof(segments) / sizeof(segments[0]);
+  RunCorpus(16000, 1, segments, count);
+  RunCorpus(48000, 1, segments, count);
+  RunCorpus(48000, 2, segments, count);
+}
+
+void TestEventsPerUid() {
+  VoiceActivityDetector detector;
+  Corpus speech(48000, 1);
+  Corpus silence(48000, 1);
+  int starts[2] = {0, 0};
+  int ends[2] = {0, 0};
+  bool speaking;
+  // uid 1 talks for 1 s and stops, uid 2 stays silent in between.
+  for (int i = 0; i < 200; ++i) {
+    SIGNAL signal = i < 100 ? SIGNAL_SPEECH : SIGNAL_SILENCE;
+    VoiceActivityDetector::EVENT event =
+        detector.Process(1, speech.Next(signal), speaking);
+    starts[0] += event == VoiceActivityDetector::EVENT_SPEECH_START;
+    ends[0] += event == VoiceActivityDetector::EVENT_SPEECH_END;
+    event = detector.Process(2, silence.Next(SIGNAL_SILENCE), speaking);
+    starts[1] += event == VoiceActivityDetector::EVENT_SPEECH_START;
+    ends[1] += event == VoiceActivityDetector::EVENT_SPEECH_END;
+  }
+  CHECK_EQ(1, starts[0]);
+  CHECK_EQ(1, ends[0]);
+  CHECK_EQ(0, starts[1]);
+  CHECK_EQ(0, ends[1]);
+}
+
+void TestConfig() {
+  VoiceActivityDetector::Config config;
+  config.startFrames = 1;
+  config.hangoverFrames = 1;
+  VoiceActivityDetector detector(config);
+  Corpus corpus(16000, 1);
+  bool speaking;
+  CHECK_EQ(VoiceActivityDetector::EVENT_SPEECH_START,
+           detector.Process(0, corpus.Next(SIGNAL_SPEECH), speaking));
+  CHECK(speaking);
+  CHECK_EQ(VoiceActivityDetector::EVENT_SPEECH_END,
+           detector.Process(0, corpus.Next(SIGNAL_SILENCE), speaking));
+  CHECK(!speaking);
+
+  // Frames the detector cannot read never count as speech.
+  AudioFrame empty;
+  CHECK_EQ(VoiceActivityDetector::EVENT_NONE,
+           detector.Process(0, empty, speaking));
+  CHECK(!speaking);
+}
+} // namespace
+
+int main() {
+  TestFeatures();
+  TestCorpus();
+  TestEventsPerUid();
+  TestConfig();
+  return test::Result("VoiceActivityDetectorTest");
+}
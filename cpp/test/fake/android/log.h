@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// Just enough of <android/log.h> for VMUtil.h, logs go to stderr.
+
+enum {
+  ANDROID_LOG_VERBOSE = 2,
+  ANDROID_LOG_DEBUG = 3,
+  ANDROID_LOG_INFO = 4,
+  ANDROID_LOG_ERROR = 6,
+};
+
+inline int __android_log_print(int, const char *tag, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "%s: ", tag);
+  int written = vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+  va_end(args);
+  return written;
+}
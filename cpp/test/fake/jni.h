@@ -0,0 +1,399 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Just enough of <jni.h> to build JavaBufferPool and the frame observers on
+// the host. The fake JNIEnv hands out plain C++ objects and counts the calls
+// made through it, so tests can check what would be allocated on the Java
+// heap.
+
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef int8_t jbyte;
+typedef uint8_t jboolean;
+typedef float jfloat;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+#define JNI_OK 0
+#define JNI_ABORT 2
+#define JNI_EDETACHED (-2)
+#define JNI_VERSION_1_6 0x00010006
+
+class _jobject {
+public:
+  virtual ~_jobject() {}
+  // What the garbage collector would free once no reference is left.
+  virtual void Collect() {}
+  int refCount = 0;
+};
+
+class _jclass : public _jobject {};
+class _jbyteArray : public _jobject {};
+class _jintArray : public _jobject {};
+class _jlongArray : public _jobject {};
+class _jfloatArray : public _jobject {};
+class _jobjectArray : public _jobject {};
+
+typedef _jobject *jobject;
+typedef _jclass *jclass;
+typedef _jbyteArray *jbyteArray;
+typedef _jintArray *jintArray;
+typedef _jlongArray *jlongArray;
+typedef _jfloatArray *jfloatArray;
+typedef _jobjectArray *jobjectArray;
+
+// Looked up by name, one per name and env.
+struct _jmethodID {
+  std::string name;
+};
+struct _jfieldID {
+  std::string name;
+};
+typedef _jmethodID *jmethodID;
+typedef _jfieldID *jfieldID;
+
+namespace fake {
+// What a primitive array handed out by the fake env holds.
+template <typename T, typename Base> class Array : public Base {
+public:
+  explicit Array(jint length) : data(length) {}
+  void Collect() override { std::vector<T>().swap(data); }
+  std::vector<T> data;
+};
+
+typedef Array<jbyte, _jbyteArray> ByteArray;
+typedef Array<jint, _jintArray> IntArray;
+typedef Array<jlong, _jlongArray> LongArray;
+typedef Array<jfloat, _jfloatArray> FloatArray;
+
+class ByteBuffer : public _jobject {
+public:
+  ByteBuffer(void *address, jlong capacity)
+      : address(address), capacity(capacity), limit(capacity) {}
+  void *address;
+  jlong capacity;
+  jlong position = 0;
+  jlong limit;
+};
+
+// An instance of a Java class, its fields by name. Reference fields hold the
+// object, not a reference to it.
+class Object : public _jobject {
+public:
+  std::map<std::string, jlong> values;
+  std::map<std::string, _jobject *> objects;
+};
+
+class ObjectArray : public _jobjectArray {
+public:
+  std::vector<_jobject *> elements;
+};
+
+// References wrap their object, so local and global references to one
+// object are distinct handles, as with a real VM.
+struct Ref : _jobject {
+  explicit Ref(_jobject *target) : target(target) { ++target->refCount; }
+  _jobject *target;
+};
+} // namespace fake
+
+struct _JNIEnv;
+typedef _JNIEnv JNIEnv;
+
+// For VMUtil.h. Host threads are never attached to anything, a VM handed out
+// by JNIEnv::GetJavaVM acts as if the caller already was.
+struct _JavaVM {
+  jint GetEnv(void **env, jint) {
+    if (!this->env) {
+      return JNI_EDETACHED;
+    }
+    *env = this->env;
+    return JNI_OK;
+  }
+  jint AttachCurrentThread(JNIEnv **, void *) { return -1; }
+  jint DetachCurrentThread() { return -1; }
+  JNIEnv *env = nullptr;
+};
+
+typedef _JavaVM JavaVM;
+
+struct _JNIEnv {
+  // Java heap allocations, the numbers the pools exist to keep flat.
+  long long byteArrays = 0;
+  long long byteArrayBytes = 0;
+  long long byteBuffers = 0;
+  // int[], long[] and float[].
+  long long primitiveArrays = 0;
+  long long newObjects = 0;
+  // Calls into Java code.
+  long long upcalls = 0;
+  long long localRefs = 0;
+  long long globalRefs = 0;
+
+  // Runs for CallBooleanMethod and CallVoidMethod, with the method name and
+  // the last object argument, such as the frame passed to an observer.
+  std::function<jboolean(const std::string &, jobject)> onCall;
+  // What getValue() returns for the constants of an enum's values().
+  std::vector<jint> enumValues;
+
+  jbyteArray NewByteArray(jint length) {
+    ++byteArrays;
+    byteArrayBytes += length;
+    return static_cast<jbyteArray>(NewLocal(new fake::ByteArray(length)));
+  }
+
+  jintArray NewIntArray(jint length) {
+    ++primitiveArrays;
+    return static_cast<jintArray>(NewLocal(new fake::IntArray(length)));
+  }
+
+  jlongArray NewLongArray(jint length) {
+    ++primitiveArrays;
+    return static_cast<jlongArray>(NewLocal(new fake::LongArray(length)));
+  }
+
+  jfloatArray NewFloatArray(jint length) {
+    ++primitiveArrays;
+    return static_cast<jfloatArray>(NewLocal(new fake::FloatArray(length)));
+  }
+
+  jobject NewDirectByteBuffer(void *address, jlong capacity) {
+    ++byteBuffers;
+    return NewLocal(new fake::ByteBuffer(address, capacity));
+  }
+
+  jobject NewObject(jclass, jmethodID, ...) {
+    ++newObjects;
+    return NewLocal(new fake::Object());
+  }
+
+  // Pins nothing, the fake heap never moves.
+  void *GetPrimitiveArrayCritical(jbyteArray ref, jboolean *) {
+    return static_cast<fake::ByteArray *>(Target(ref))->data.data();
+  }
+
+  void ReleasePrimitiveArrayCritical(jbyteArray, void *, jint) {}
+
+  jint GetArrayLength(jobject ref) {
+    _jobject *target = Target(ref);
+    if (auto *array = dynamic_cast<fake::ObjectArray *>(target)) {
+      return static_cast<jint>(array->elements.size());
+    }
+    return static_cast<jint>(
+        static_cast<fake::ByteArray *>(target)->data.size());
+  }
+
+  void SetByteArrayRegion(jbyteArray ref, jint start, jint length,
+                          const jbyte *buffer) {
+    SetRegion<fake::ByteArray>(ref, start, length, buffer);
+  }
+
+  void GetByteArrayRegion(jbyteArray ref, jint start, jint length,
+                          jbyte *buffer) {
+    auto *array = static_cast<fake::ByteArray *>(Target(ref));
+    std::copy(array->data.begin() + start,
+              array->data.begin() + start + length, buffer);
+  }
+
+  void SetIntArrayRegion(jintArray ref, jint start, jint length,
+                         const jint *buffer) {
+    SetRegion<fake::IntArray>(ref, start, length, buffer);
+  }
+
+  void SetLongArrayRegion(jlongArray ref, jint start, jint length,
+                          const jlong *buffer) {
+    SetRegion<fake::LongArray>(ref, start, length, buffer);
+  }
+
+  void SetFloatArrayRegion(jfloatArray ref, jint start, jint length,
+                           const jfloat *buffer) {
+    SetRegion<fake::FloatArray>(ref, start, length, buffer);
+  }
+
+  jobject GetObjectArrayElement(jobjectArray ref, jint index) {
+    auto *array = static_cast<fake::ObjectArray *>(Target(ref));
+    return NewRef(array->elements[index], localRefs);
+  }
+
+  jobject NewGlobalRef(jobject ref) {
+    return ref ? NewRef(Target(ref), globalRefs) : nullptr;
+  }
+
+  void DeleteGlobalRef(jobject ref) { DeleteRef(ref, globalRefs); }
+  void DeleteLocalRef(jobject ref) { DeleteRef(ref, localRefs); }
+
+  jclass FindClass(const char *) {
+    return static_cast<jclass>(NewLocal(new _jclass()));
+  }
+
+  jclass GetObjectClass(jobject) { return FindClass(nullptr); }
+
+  jmethodID GetMethodID(jclass, const char *name, const char *) {
+    return Intern(methods, name);
+  }
+
+  jmethodID GetStaticMethodID(jclass, const char *name, const char *) {
+    return Intern(methods, name);
+  }
+
+  jfieldID GetFieldID(jclass, const char *name, const char *) {
+    return Intern(fields, name);
+  }
+
+  jfieldID GetStaticFieldID(jclass, const char *name, const char *) {
+    return Intern(fields, name);
+  }
+
+  // One object per static field, whichever class it is looked up on.
+  jobject GetStaticObjectField(jclass, jfieldID field) {
+    _jobject *&constant = statics[field->name];
+    if (!constant) {
+      constant = NewObjectOnHeap(new fake::Object());
+    }
+    return NewRef(constant, localRefs);
+  }
+
+  void SetIntField(jobject ref, jfieldID field, jint value) {
+    Instance(ref)->values[field->name] = value;
+  }
+
+  void SetLongField(jobject ref, jfieldID field, jlong value) {
+    Instance(ref)->values[field->name] = value;
+  }
+
+  void SetObjectField(jobject ref, jfieldID field, jobject value) {
+    Instance(ref)->objects[field->name] = value ? Target(value) : nullptr;
+  }
+
+  jobject GetObjectField(jobject ref, jfieldID field) {
+    _jobject *value = Instance(ref)->objects[field->name];
+    return value ? NewRef(value, localRefs) : nullptr;
+  }
+
+  // Only ever Buffer.clear().
+  jobject CallObjectMethod(jobject ref, jmethodID, ...) {
+    ++upcalls;
+    auto *buffer = static_cast<fake::ByteBuffer *>(Target(ref));
+    buffer->position = 0;
+    buffer->limit = buffer->capacity;
+    return NewRef(buffer, localRefs);
+  }
+
+  // Only ever an enum's values(), see enumValues.
+  jobject CallStaticObjectMethod(jclass, jmethodID, ...) {
+    ++upcalls;
+    auto *array = new fake::ObjectArray();
+    NewObjectOnHeap(array);
+    for (jint value : enumValues) {
+      auto *constant = new fake::Object();
+      constant->values["value"] = value;
+      array->elements.push_back(NewObjectOnHeap(constant));
+    }
+    return NewRef(array, localRefs);
+  }
+
+  // Only ever an enum's getValue().
+  jint CallIntMethod(jobject ref, jmethodID) {
+    ++upcalls;
+    return static_cast<jint>(Instance(ref)->values["value"]);
+  }
+
+  template <typename... Args>
+  jboolean CallBooleanMethod(jobject, jmethodID method, Args... args) {
+    return Call(method, args...);
+  }
+
+  template <typename... Args>
+  void CallVoidMethod(jobject, jmethodID method, Args... args) {
+    Call(method, args...);
+  }
+
+  jint GetJavaVM(JavaVM **vm) {
+    this->vm.env = this;
+    *vm = &this->vm;
+    return JNI_OK;
+  }
+
+  // The object behind a reference, for tests.
+  static _jobject *Target(jobject ref) {
+    return static_cast<fake::Ref *>(ref)->target;
+  }
+
+  ~_JNIEnv() {
+    for (auto *ref : refs) {
+      delete ref;
+    }
+  }
+
+private:
+  template <typename... Args> jboolean Call(jmethodID method, Args... args) {
+    ++upcalls;
+    jobject last = nullptr;
+    int unused[] = {0, (Pick(last, args), 0)...};
+    (void)unused;
+    return onCall ? onCall(method->name, last) : JNI_TRUE;
+  }
+
+  static void Pick(jobject &last, jobject arg) { last = arg; }
+  template <typename T> static void Pick(jobject &, T) {}
+
+  template <typename T, typename Ref, typename Value>
+  void SetRegion(Ref ref, jint start, jint length, const Value *buffer) {
+    auto *array = static_cast<T *>(Target(ref));
+    std::copy(buffer, buffer + length, array->data.begin() + start);
+  }
+
+  static fake::Object *Instance(jobject ref) {
+    return static_cast<fake::Object *>(Target(ref));
+  }
+
+  template <typename T>
+  static T *Intern(std::map<std::string, std::unique_ptr<T>> &ids,
+                   const char *name) {
+    std::unique_ptr<T> &id = ids[name];
+    if (!id) {
+      id.reset(new T{name});
+    }
+    return id.get();
+  }
+
+  _jobject *NewObjectOnHeap(_jobject *object) {
+    objects.emplace_back(object);
+    return object;
+  }
+
+  jobject NewLocal(_jobject *object) {
+    return NewRef(NewObjectOnHeap(object), localRefs);
+  }
+
+  jobject NewRef(_jobject *target, long long &count) {
+    ++count;
+    refs.push_back(new fake::Ref(target));
+    return refs.back();
+  }
+
+  void DeleteRef(jobject ref, long long &count) {
+    if (ref) {
+      --count;
+      _jobject *target = Target(ref);
+      if (--target->refCount == 0) {
+        target->Collect();
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<_jobject>> objects;
+  std::vector<fake::Ref *> refs;
+  std::map<std::string, std::unique_ptr<_jmethodID>> methods;
+  std::map<std::string, std::unique_ptr<_jfieldID>> fields;
+  std::map<std::string, _jobject *> statics;
+  _JavaVM vm;
+};
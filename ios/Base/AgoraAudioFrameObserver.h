@@ -11,6 +11,18 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Bits of `AUDIO_FRAME_POSITION`.
+typedef NS_OPTIONS(NSUInteger, AgoraAudioFramePosition) {
+  AgoraAudioFramePositionPlayback = 1 << 0,
+  AgoraAudioFramePositionRecord = 1 << 1,
+  AgoraAudioFramePositionMixed = 1 << 2,
+  AgoraAudioFramePositionBeforeMixing = 1 << 3,
+  AgoraAudioFramePositionEarMonitoring = 1 << 4,
+  AgoraAudioFramePositionDefault =
+      AgoraAudioFramePositionPlayback | AgoraAudioFramePositionRecord |
+      AgoraAudioFramePositionMixed | AgoraAudioFramePositionBeforeMixing,
+};
+
 @protocol AgoraAudioFrameDelegate <NSObject>
 @required
 - (BOOL)onRecordAudioFrame:(AgoraAudioFrame *_Nonnull)audioFrame;
@@ -23,6 +35,9 @@ NS_ASSUME_NONNULL_BEGIN
                                      uid:(NSUInteger)uid;
 
 @optional
+/// Only called when AgoraAudioFramePositionEarMonitoring is observed.
+- (BOOL)onEarMonitoringAudioFrame:(AgoraAudioFrame *_Nonnull)audioFrame;
+
 - (BOOL)isMultipleChannelFrameWanted;
 
 - (BOOL)onPlaybackAudioFrameBeforeMixingEx:(AgoraAudioFrame *_Nonnull)audioFrame
@@ -33,9 +48,19 @@ NS_ASSUME_NONNULL_BEGIN
 @interface AgoraAudioFrameObserver : NSObject
 @property(nonatomic, assign) NSUInteger engineHandle;
 @property(nonatomic, weak) id<AgoraAudioFrameDelegate> _Nullable delegate;
+/// Positions left out are not delivered at all, can be changed at any time.
+@property(nonatomic, assign) NSUInteger observedAudioFramePosition;
 
 - (instancetype)initWithEngineHandle:(NSUInteger)engineHandle;
 
+/// Sets the format the SDK delivers at one of the playback, record, mixed or
+/// ear monitoring positions. Zeros let the SDK choose.
+- (void)setAudioParams:(NSUInteger)position
+            sampleRate:(NSInteger)sampleRate
+              channels:(NSInteger)channels
+                  mode:(NSInteger)mode
+        samplesPerCall:(NSInteger)samplesPerCall;
+
 - (void)registerAudioFrameObserver;
 
 - (void)unregisterAudioFrameObserver;
@@ -10,36 +10,50 @@
 #import <AgoraRtcKit/IAgoraMediaEngine.h>
 #import <AgoraRtcKit/IAgoraRtcEngine.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace agora {
 class AudioFrameObserver : public media::IAudioFrameObserver {
 public:
-  AudioFrameObserver(long long engineHandle, void *observer)
-      : engineHandle(engineHandle),
-        observer((__bridge AgoraAudioFrameObserver *)observer) {
-    auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
-    if (rtcEngine) {
-      util::AutoPtr<media::IMediaEngine> mediaEngine;
-      mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
-      if (mediaEngine) {
-        mediaEngine->registerAudioFrameObserver(this);
-      }
+  enum { POSITION_COUNT = 5 };
+
+  // `audioParams` holds POSITION_COUNT entries indexed by the bit number of
+  // AUDIO_FRAME_POSITION.
+  AudioFrameObserver(long long engineHandle, void *observer,
+                     int observedPosition, const AudioParams *audioParams)
+      : observer((__bridge AgoraAudioFrameObserver *)observer),
+        engineHandle(engineHandle), observedPosition(observedPosition) {
+    for (int i = 0; i < POSITION_COUNT; ++i) {
+      this->audioParams[i] = audioParams[i];
     }
+    RegisterWithMediaEngine(this);
   }
 
-  virtual ~AudioFrameObserver() {
-    auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
-    if (rtcEngine) {
-      util::AutoPtr<media::IMediaEngine> mediaEngine;
-      mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
-      if (mediaEngine) {
-        mediaEngine->registerAudioFrameObserver(nullptr);
-      }
+  virtual ~AudioFrameObserver() { RegisterWithMediaEngine(nullptr); }
+
+  void setObservedAudioFramePosition(int position) {
+    if (observedPosition.exchange(position) != position) {
+      // Registering again makes the SDK call getObservedAudioFramePosition.
+      RegisterWithMediaEngine(this);
     }
   }
 
+  void setAudioParams(int index, const AudioParams &params) {
+    {
+      std::lock_guard<std::mutex> lock(audioParamsMutex);
+      audioParams[index] = params;
+    }
+    // Registering again makes the SDK query the params.
+    RegisterWithMediaEngine(this);
+  }
+
 public:
   bool onRecordAudioFrame(const char *channelId,
                           AudioFrame &audioFrame) override {
+    if (!IsObserved(AUDIO_FRAME_POSITION_RECORD)) {
+      return true;
+    }
     @autoreleasepool {
       AgoraAudioFrameObserver *strongObserverApple = observer;
       if (strongObserverApple) {
@@ -58,6 +72,9 @@ public:
 
   bool onPlaybackAudioFrame(const char *channelId,
                             AudioFrame &audioFrame) override {
+    if (!IsObserved(AUDIO_FRAME_POSITION_PLAYBACK)) {
+      return true;
+    }
     @autoreleasepool {
       AgoraAudioFrameObserver *strongObserverApple = observer;
       if (strongObserverApple) {
@@ -76,6 +93,9 @@ public:
 
   bool onMixedAudioFrame(const char *channelId,
                          AudioFrame &audioFrame) override {
+    if (!IsObserved(AUDIO_FRAME_POSITION_MIXED)) {
+      return true;
+    }
     @autoreleasepool {
       AgoraAudioFrameObserver *strongObserverApple = observer;
       if (strongObserverApple) {
@@ -94,6 +114,9 @@ public:
 
   bool onPlaybackAudioFrameBeforeMixing(const char *channelId, rtc::uid_t uid,
                                         AudioFrame &audioFrame) override {
+    if (!IsObserved(AUDIO_FRAME_POSITION_BEFORE_MIXING)) {
+      return true;
+    }
     @autoreleasepool {
       AgoraAudioFrameObserver *strongObserverApple = observer;
       if (strongObserverApple) {
@@ -112,32 +135,69 @@ public:
     return true;
   }
 
-  bool onEarMonitoringAudioFrame(
-      media::IAudioFrameObserverBase::AudioFrame &audioFrame) override {
-    return false;
+  bool onEarMonitoringAudioFrame(AudioFrame &audioFrame) override {
+    if (!IsObserved(AUDIO_FRAME_POSITION_EAR_MONITORING)) {
+      return true;
+    }
+    @autoreleasepool {
+      AgoraAudioFrameObserver *strongObserverApple = observer;
+      if (strongObserverApple) {
+        AgoraAudioFrame *audioFrameApple = NativeToAppleAudioFrame(audioFrame);
+
+        if (strongObserverApple.delegate != nil &&
+            [strongObserverApple.delegate
+                respondsToSelector:@selector(onEarMonitoringAudioFrame:)]) {
+          return [strongObserverApple.delegate
+              onEarMonitoringAudioFrame:audioFrameApple];
+        }
+      }
+    }
+    return true;
   }
 
-  int getObservedAudioFramePosition() override { return 0; }
+  int getObservedAudioFramePosition() override {
+    return observedPosition.load();
+  }
 
   media::IAudioFrameObserverBase::AudioParams
   getPlaybackAudioParams() override {
-    return media::IAudioFrameObserverBase::AudioParams();
+    return GetAudioParams(0);
   }
 
   media::IAudioFrameObserverBase::AudioParams getRecordAudioParams() override {
-    return media::IAudioFrameObserverBase::AudioParams();
+    return GetAudioParams(1);
   }
 
   media::IAudioFrameObserverBase::AudioParams getMixedAudioParams() override {
-    return media::IAudioFrameObserverBase::AudioParams();
+    return GetAudioParams(2);
   }
 
   media::IAudioFrameObserverBase::AudioParams
   getEarMonitoringAudioParams() override {
-    return media::IAudioFrameObserverBase::AudioParams();
+    return GetAudioParams(4);
   }
 
 private:
+  bool IsObserved(AUDIO_FRAME_POSITION position) const {
+    return (observedPosition.load(std::memory_order_relaxed) & position) != 0;
+  }
+
+  AudioParams GetAudioParams(int index) {
+    std::lock_guard<std::mutex> lock(audioParamsMutex);
+    return audioParams[index];
+  }
+
+  void RegisterWithMediaEngine(media::IAudioFrameObserver *observer) {
+    auto rtcEngine = reinterpret_cast<rtc::IRtcEngine *>(engineHandle);
+    if (rtcEngine) {
+      util::AutoPtr<media::IMediaEngine> mediaEngine;
+      mediaEngine.queryInterface(rtcEngine, agora::rtc::AGORA_IID_MEDIA_ENGINE);
+      if (mediaEngine) {
+        mediaEngine->registerAudioFrameObserver(observer);
+      }
+    }
+  }
+
   AgoraAudioFrame *NativeToAppleAudioFrame(AudioFrame &audioFrame) {
     AgoraAudioFrame *audioFrameApple = [[AgoraAudioFrame alloc] init];
     audioFrameApple.type = (AgoraAudioFrameType)audioFrame.type;
@@ -154,10 +214,16 @@ private:
 private:
   __weak AgoraAudioFrameObserver *observer;
   long long engineHandle;
+  std::atomic<int> observedPosition;
+  std::mutex audioParamsMutex;
+  AudioParams audioParams[POSITION_COUNT];
 };
 } // namespace agora
 
-@interface AgoraAudioFrameObserver ()
+@interface AgoraAudioFrameObserver () {
+  agora::media::IAudioFrameObserverBase::AudioParams
+      _audioParams[agora::AudioFrameObserver::POSITION_COUNT];
+}
 @property(nonatomic) agora::AudioFrameObserver *observer;
 @end
 
@@ -166,14 +232,45 @@ private:
 - (instancetype)initWithEngineHandle:(NSUInteger)engineHandle {
   if (self = [super init]) {
     self.engineHandle = engineHandle;
+    _observedAudioFramePosition = AgoraAudioFramePositionDefault;
   }
   return self;
 }
 
+- (void)setObservedAudioFramePosition:(NSUInteger)observedAudioFramePosition {
+  _observedAudioFramePosition = observedAudioFramePosition;
+  if (_observer) {
+    _observer->setObservedAudioFramePosition((int)observedAudioFramePosition);
+  }
+}
+
+- (void)setAudioParams:(NSUInteger)position
+            sampleRate:(NSInteger)sampleRate
+              channels:(NSInteger)channels
+                  mode:(NSInteger)mode
+        samplesPerCall:(NSInteger)samplesPerCall {
+  // __builtin_ctzl(0) is undefined, check for a single bit first.
+  if (position == 0 || (position & (position - 1)) != 0 ||
+      position == AgoraAudioFramePositionBeforeMixing) {
+    return;
+  }
+  NSUInteger index = __builtin_ctzl(position);
+  if (index >= agora::AudioFrameObserver::POSITION_COUNT) {
+    return;
+  }
+  _audioParams[index] = agora::media::IAudioFrameObserverBase::AudioParams(
+      (int)sampleRate, (int)channels,
+      (agora::rtc::RAW_AUDIO_FRAME_OP_MODE_TYPE)mode, (int)samplesPerCall);
+  if (_observer) {
+    _observer->setAudioParams((int)index, _audioParams[index]);
+  }
+}
+
 - (void)registerAudioFrameObserver {
   if (!_observer) {
-    _observer =
-        new agora::AudioFrameObserver(_engineHandle, (__bridge void *)self);
+    _observer = new agora::AudioFrameObserver(
+        _engineHandle, (__bridge void *)self, (int)_observedAudioFramePosition,
+        _audioParams);
   }
 }
 
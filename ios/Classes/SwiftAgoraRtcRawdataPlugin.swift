@@ -15,11 +15,29 @@ public class SwiftAgoraRtcRawdataPlugin: NSObject, FlutterPlugin, AgoraAudioFram
         switch call.method {
         case "registerAudioFrameObserver":
             if audioObserver == nil {
-                audioObserver = AgoraAudioFrameObserver(engineHandle: call.arguments as! UInt)
+                // The iOS observer already hands out the SDK buffer in place, so
+                // `bufferType` has nothing to select here.
+                let args = call.arguments as! [String: Any]
+                audioObserver = AgoraAudioFrameObserver(engineHandle: args["engineHandle"] as! UInt)
+                if let observedPosition = args["observedPosition"] as? UInt {
+                    audioObserver?.observedAudioFramePosition = observedPosition
+                }
+                if let audioParams = args["audioParams"] as? [Int: [String: Int]] {
+                    for (position, params) in audioParams {
+                        setAudioParams(UInt(position), params)
+                    }
+                }
             }
             audioObserver?.delegate = self
             audioObserver?.register()
             result(nil)
+        case "setObservedAudioFramePosition":
+            audioObserver?.observedAudioFramePosition = call.arguments as! UInt
+            result(nil)
+        case "setAudioParams":
+            let args = call.arguments as! [String: Any]
+            setAudioParams(args["position"] as! UInt, args["params"] as! [String: Int])
+            result(nil)
         case "unregisterAudioFrameObserver":
             if audioObserver != nil {
                 audioObserver?.delegate = nil
@@ -29,7 +47,8 @@ public class SwiftAgoraRtcRawdataPlugin: NSObject, FlutterPlugin, AgoraAudioFram
             result(nil)
         case "registerVideoFrameObserver":
             if videoObserver == nil {
-                videoObserver = AgoraVideoFrameObserver(engineHandle: call.arguments as! UInt)
+                let args = call.arguments as! [String: Any]
+                videoObserver = AgoraVideoFrameObserver(engineHandle: args["engineHandle"] as! UInt)
             }
             videoObserver?.delegate = self
             videoObserver?.register()
@@ -46,6 +65,14 @@ public class SwiftAgoraRtcRawdataPlugin: NSObject, FlutterPlugin, AgoraAudioFram
         }
     }
 
+    private func setAudioParams(_ position: UInt, _ params: [String: Int]) {
+        audioObserver?.setAudioParams(position,
+                                      sampleRate: params["sampleRate"] ?? 0,
+                                      channels: params["channels"] ?? 0,
+                                      mode: params["mode"] ?? 0,
+                                      samplesPerCall: params["samplesPerCall"] ?? 0)
+    }
+
     public func onRecord(_: AgoraAudioFrame) -> Bool {
         return true
     }
@@ -61,6 +88,10 @@ public class SwiftAgoraRtcRawdataPlugin: NSObject, FlutterPlugin, AgoraAudioFram
     public func onPlaybackAudioFrame(beforeMixing _: AgoraAudioFrame, uid _: UInt) -> Bool {
         return true
     }
+
+    public func onEarMonitoringAudioFrame(_: AgoraAudioFrame) -> Bool {
+        return true
+    }
     
     public func getVideoFormatPreference() -> AgoraVideoFrameType {
         return .YUV420
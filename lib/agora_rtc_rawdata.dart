@@ -1,24 +1,687 @@
 import 'dart:async';
 
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 
+import 'src/audio_injection_ring.dart';
+import 'src/audio_render_ring.dart';
+
+/// How the Android observer hands PCM to the Java layer.
+enum AudioBufferType {
+  /// Copy into a reused `byte[]` per callback and copy back afterwards.
+  byteArray,
+
+  /// Wrap the SDK buffer in a direct `ByteBuffer`, valid only for the
+  /// duration of the callback.
+  directByteBuffer,
+
+  /// Convert natively to float32 in `[-1, 1)`, one plane per channel, in a
+  /// pooled direct `ByteBuffer` read through `AudioFrame.getFloatBuffer()`.
+  /// Read-only, meant for models that want float input.
+  floatPlanar,
+}
+
+/// How the Android observer hands video planes to the Java layer.
+enum VideoBufferType {
+  /// Copy each plane into a reused `byte[]` per frame and copy back
+  /// afterwards.
+  byteArray,
+
+  /// Wrap each plane in a direct `ByteBuffer`, valid only for the duration of
+  /// the callback.
+  directByteBuffer,
+
+  /// Copy all planes into one pooled, 64-byte-aligned native block read
+  /// through `VideoFrame.getContiguousBuffer()` at per-plane offsets, and
+  /// copy back afterwards. Nothing is allocated on the Java heap.
+  contiguous,
+}
+
+/// How the Android observer lays out the video rows it copies.
+enum VideoPlaneMode {
+  /// Keep the SDK stride, row padding included.
+  strided,
+
+  /// Pack rows to the visible width, the stride becomes the row size. Ignored
+  /// with [VideoBufferType.directByteBuffer].
+  packed,
+}
+
+/// When the Android observer runs relative to the SDK audio thread.
+enum AudioDeliveryMode {
+  /// On the SDK thread, the frame may be edited.
+  synchronous,
+
+  /// On a dedicated thread fed by a lock-free ring per position. The SDK
+  /// thread only copies the PCM, the frame is read-only.
+  asynchronous,
+
+  /// `deliveryFrames` consecutive frames per position in one call on the SDK
+  /// thread, with per-frame timestamps. Read-only.
+  batched,
+
+  /// Nothing is passed to Java, for use with
+  /// [AgoraRtcRawdata.setAudioLevelMetering] alone.
+  none,
+}
+
+/// Bits of `AUDIO_FRAME_POSITION`, combine them with `|`.
+class AudioFramePosition {
+  static const int playback = 0x0001;
+  static const int record = 0x0002;
+  static const int mixed = 0x0004;
+  static const int beforeMixing = 0x0008;
+  static const int earMonitoring = 0x0010;
+
+  static const int defaultPosition = playback | record | mixed | beforeMixing;
+}
+
+/// Bits of `VIDEO_MODULE_POSITION`, the video observer positions.
+class VideoFramePosition {
+  static const int postCapturer = 0x0001;
+  static const int preRenderer = 0x0002;
+  static const int preEncoder = 0x0004;
+
+  static const int defaultPosition = postCapturer | preRenderer;
+}
+
+/// `VIDEO_PIXEL_FORMAT` values the Android observer can marshal.
+class VideoPixelFormat {
+  static const int i420 = 1;
+  static const int bgra = 2;
+  static const int nv21 = 3;
+  static const int rgba = 4;
+  static const int nv12 = 8;
+  static const int i422 = 16;
+  static const int i010 = 18;
+}
+
+/// A built-in native video stage, run on the SDK planes before anything
+/// reaches the JVM. See `cpp/android/VideoProcessor.h` for the names.
+class VideoProcessorConfig {
+  const VideoProcessorConfig(this.name, [this.params = const {}]);
+
+  /// Sets every chroma sample to ([u], [v]), 128 for both turns the frame
+  /// gray.
+  VideoProcessorConfig.fillChroma({int u = 128, int v = 128})
+      : name = 'fillChroma',
+        params = {'u': u, 'v': v};
+
+  /// Adds [offset] to every luma sample, saturating.
+  VideoProcessorConfig.lumaOffset(int offset)
+      : name = 'lumaOffset',
+        params = {'offset': offset};
+
+  final String name;
+  final Map<String, num> params;
+
+  Map<String, dynamic> toJson() => {
+        'name': name,
+        'params': params,
+      };
+}
+
+/// Values of `RAW_AUDIO_FRAME_OP_MODE_TYPE`.
+class AudioFrameOpMode {
+  static const int readOnly = 0;
+  static const int readWrite = 2;
+}
+
+/// The format the SDK delivers at one [AudioFramePosition]. Zero lets the SDK
+/// choose.
+class AudioFrameParams {
+  const AudioFrameParams({
+    this.sampleRate = 0,
+    this.channels = 0,
+    this.mode = AudioFrameOpMode.readOnly,
+    this.samplesPerCall = 0,
+  });
+
+  final int sampleRate;
+  final int channels;
+  final int mode;
+  final int samplesPerCall;
+
+  Map<String, dynamic> toJson() => {
+        'sampleRate': sampleRate,
+        'channels': channels,
+        'mode': mode,
+        'samplesPerCall': samplesPerCall,
+      };
+}
+
+/// File format of [AgoraRtcRawdata.startAudioRecording].
+enum AudioRecordingFormat {
+  /// A WAV header, finalized when each file is closed.
+  wav,
+
+  /// Headerless interleaved PCM.
+  raw,
+}
+
+/// Progress of one [AgoraRtcRawdata.startAudioRecording].
+class AudioRecordingStats {
+  AudioRecordingStats.fromJson(Map<dynamic, dynamic> json)
+      : bytesWritten = json['bytesWritten'],
+        bytesDropped = json['bytesDropped'],
+        files = json['files'];
+
+  final int bytesWritten;
+
+  /// Audio lost because the writer fell behind or the format changed.
+  final int bytesDropped;
+  final int files;
+}
+
+/// Counters of [AgoraRtcRawdata.startAudioInjection], in 10 ms frames.
+class AudioInjectionStats {
+  AudioInjectionStats.fromJson(Map<dynamic, dynamic> json)
+      : framesPushed = json['framesPushed'],
+        silentFrames = json['silentFrames'],
+        underruns = json['underruns'],
+        bytesRefused = json['bytesRefused'],
+        lateTicks = json['lateTicks'],
+        pushErrors = json['pushErrors'],
+        bufferedFrames = json['bufferedFrames'],
+        capacityFrames = json['capacityFrames'];
+
+  final int framesPushed;
+
+  /// Silence pushed while the jitter buffer filled up.
+  final int silentFrames;
+
+  /// Times the jitter buffer ran dry, the producer is too slow.
+  final int underruns;
+
+  /// PCM refused by [AgoraRtcRawdata.pushAudio] because the ring was full.
+  final int bytesRefused;
+
+  /// Times the pacing thread fell so far behind that it skipped ahead.
+  final int lateTicks;
+  final int pushErrors;
+  final int bufferedFrames;
+  final int capacityFrames;
+}
+
+/// Counters of [AgoraRtcRawdata.startAudioRendering], in pulled frames.
+class AudioRenderStats {
+  AudioRenderStats.fromJson(Map<dynamic, dynamic> json)
+      : framesPulled = json['framesPulled'],
+        pullErrors = json['pullErrors'],
+        overruns = json['overruns'],
+        underruns = json['underruns'],
+        lateTicks = json['lateTicks'],
+        bufferedFrames = json['bufferedFrames'],
+        depthFrames = json['depthFrames'];
+
+  final int framesPulled;
+  final int pullErrors;
+
+  /// Frames dropped because the consumer did not read them in time.
+  final int overruns;
+
+  /// Reads that found no frame ready.
+  final int underruns;
+
+  /// Times the pull thread fell so far behind that it skipped ahead.
+  final int lateTicks;
+  final int bufferedFrames;
+  final int depthFrames;
+}
+
+/// Ring counters of one [AudioFramePosition] in
+/// [AudioDeliveryMode.asynchronous].
+class AudioDeliveryStats {
+  AudioDeliveryStats.fromJson(Map<dynamic, dynamic> json)
+      : delivered = json['delivered'],
+        overflow = json['overflow'],
+        dropped = json['dropped'],
+        highWaterMark = json['highWaterMark'],
+        capacity = json['capacity'];
+
+  final int delivered;
+
+  /// Frames that found the ring full.
+  final int overflow;
+
+  /// Every frame that was not delivered, [overflow] included.
+  final int dropped;
+
+  /// Most frames ever queued at once, out of [capacity].
+  final int highWaterMark;
+  final int capacity;
+}
+
+/// A histogram of callback timings in microseconds. Buckets are exact below
+/// 16 us and within 12.5% above, keyed by their lower bound.
+class CallbackTimingHistogram {
+  CallbackTimingHistogram.fromJson(Map<dynamic, dynamic> json)
+      : count = json['count'],
+        sumUs = json['sumUs'],
+        minUs = json['minUs'],
+        maxUs = json['maxUs'],
+        p50Us = json['p50Us'],
+        p90Us = json['p90Us'],
+        p99Us = json['p99Us'],
+        buckets = Map<int, int>.from(json['buckets']);
+
+  final int count;
+  final int sumUs;
+  final int minUs;
+  final int maxUs;
+  final int p50Us;
+  final int p90Us;
+  final int p99Us;
+
+  /// Sample count per bucket lower bound, empty buckets left out.
+  final Map<int, int> buckets;
+
+  double get meanUs => count == 0 ? 0 : sumUs / count;
+}
+
+/// Timing of the SDK callbacks at one [AudioFramePosition].
+class AudioCallbackTiming {
+  AudioCallbackTiming.fromJson(Map<dynamic, dynamic> json)
+      : interval = CallbackTimingHistogram.fromJson(json['interval']),
+        callback = CallbackTimingHistogram.fromJson(json['callback']),
+        jni = CallbackTimingHistogram.fromJson(json['jni']),
+        handler = CallbackTimingHistogram.fromJson(json['handler']);
+
+  /// Time between consecutive callbacks, widening shows underruns. Always
+  /// empty for [AudioFramePosition.beforeMixing], which is called back once
+  /// per remote uid.
+  final CallbackTimingHistogram interval;
+
+  /// Time spent in the whole native callback.
+  final CallbackTimingHistogram callback;
+
+  /// JNI marshalling of the frame into and out of Java.
+  final CallbackTimingHistogram jni;
+
+  /// The Java observer method itself. With
+  /// [AudioDeliveryMode.asynchronous], [jni] and [handler] are measured on
+  /// the delivery thread rather than inside [callback].
+  final CallbackTimingHistogram handler;
+}
+
+/// The level of one uid over one metering interval. Peak and RMS are linear
+/// in `[0, 1]` of full scale, [dbfs] is the RMS level in dB.
+class AudioLevel {
+  const AudioLevel(this.uid, this.peak, this.rms, this.dbfs);
+
+  /// The remote uid for [AudioFramePosition.beforeMixing], 0 otherwise.
+  final int uid;
+  final double peak;
+  final double rms;
+  final double dbfs;
+}
+
+/// One metering summary of an [AudioFramePosition].
+class AudioLevels {
+  AudioLevels.fromJson(Map<dynamic, dynamic> json)
+      : position = json['position'],
+        levels = List.generate(
+            (json['uids'] as List).length,
+            (i) => AudioLevel(json['uids'][i], json['peak'][i], json['rms'][i],
+                json['dbfs'][i]));
+
+  final int position;
+  final List<AudioLevel> levels;
+}
+
+/// A speech start or end reported by [AgoraRtcRawdata.onVoiceActivity].
+class VoiceActivity {
+  VoiceActivity.fromJson(Map<dynamic, dynamic> json)
+      : position = json['position'],
+        uid = json['uid'],
+        speaking = json['speaking'];
+
+  final int position;
+
+  /// The remote uid for [AudioFramePosition.beforeMixing], 0 otherwise.
+  final int uid;
+  final bool speaking;
+}
+
 class AgoraRtcRawdata {
   static const MethodChannel _channel =
       const MethodChannel('agora_rtc_rawdata');
 
-  static Future<void> registerAudioFrameObserver(int engineHandle) {
-    return _channel.invokeMethod('registerAudioFrameObserver', engineHandle);
+  static StreamController<AudioLevels>? _audioLevels;
+  static StreamController<VoiceActivity>? _voiceActivity;
+
+  /// Android only. Summaries enabled with [setAudioLevelMetering].
+  static Stream<AudioLevels> get onAudioLevels {
+    _listenToPlatform();
+    return (_audioLevels ??= StreamController<AudioLevels>.broadcast()).stream;
+  }
+
+  /// Android only. Events enabled with [setVoiceActivityDetection].
+  static Stream<VoiceActivity> get onVoiceActivity {
+    _listenToPlatform();
+    return (_voiceActivity ??= StreamController<VoiceActivity>.broadcast())
+        .stream;
+  }
+
+  static bool _listening = false;
+
+  static void _listenToPlatform() {
+    if (_listening) {
+      return;
+    }
+    _listening = true;
+    _channel.setMethodCallHandler((call) async {
+      switch (call.method) {
+        case 'onAudioLevels':
+          _audioLevels?.add(AudioLevels.fromJson(call.arguments));
+          break;
+        case 'onVoiceActivity':
+          _voiceActivity?.add(VoiceActivity.fromJson(call.arguments));
+          break;
+      }
+    });
+  }
+
+  static Future<void> registerAudioFrameObserver(int engineHandle,
+      {AudioBufferType bufferType = AudioBufferType.byteArray,
+      int observedPosition = AudioFramePosition.defaultPosition,
+      Map<int, AudioFrameParams> audioParams = const {},
+      AudioDeliveryMode deliveryMode = AudioDeliveryMode.synchronous,
+      int deliveryFrames = 0}) {
+    return _channel.invokeMethod('registerAudioFrameObserver', {
+      'engineHandle': engineHandle,
+      'bufferType': bufferType.index,
+      'observedPosition': observedPosition,
+      'audioParams': audioParams
+          .map((position, params) => MapEntry(position, params.toJson())),
+      'deliveryMode': deliveryMode.index,
+      'deliveryFrames': deliveryFrames,
+    });
+  }
+
+  /// Android only. Computes peak, RMS and dBFS natively at the
+  /// [AudioFramePosition] bits in [positions], per uid before mixing, and
+  /// emits them on [onAudioLevels] every [intervalMs]. With
+  /// [AudioDeliveryMode.none] no PCM crosses into Java at all. Pass 0
+  /// [positions] to stop.
+  static Future<void> setAudioLevelMetering(int positions,
+      {int intervalMs = 100}) {
+    return _channel.invokeMethod('setAudioLevelMetering', {
+      'positions': positions,
+      'intervalMs': intervalMs,
+    });
+  }
+
+  /// Android only. Records one [AudioFramePosition] of the registered audio
+  /// observer to `<pathPrefix>_<n>.wav` or `.pcm`, written by a native thread
+  /// so storage stalls never reach the audio callback. [uid] limits
+  /// [AudioFramePosition.beforeMixing] to one remote user. Files rotate after
+  /// [maxFileBytes] of PCM or [maxFileDurationMs], 0 for no limit. Returns an
+  /// id for [stopAudioRecording], or -1 on failure.
+  static Future<int> startAudioRecording(int position, String pathPrefix,
+      {int? uid,
+      AudioRecordingFormat format = AudioRecordingFormat.wav,
+      int maxFileBytes = 0,
+      int maxFileDurationMs = 0}) async {
+    final id = await _channel.invokeMethod<int>('startAudioRecording', {
+      'position': position,
+      'uid': uid,
+      'pathPrefix': pathPrefix,
+      'format': format.index,
+      'maxFileBytes': maxFileBytes,
+      'maxFileDurationMs': maxFileDurationMs,
+    });
+    return id ?? -1;
+  }
+
+  /// Android only. Writes what is buffered and closes the current file.
+  static Future<void> stopAudioRecording(int id) {
+    return _channel.invokeMethod('stopAudioRecording', id);
+  }
+
+  /// Android only. Null once the recording was stopped.
+  static Future<AudioRecordingStats?> getAudioRecordingStats(int id) async {
+    final stats = await _channel
+        .invokeMapMethod<String, dynamic>('getAudioRecordingStats', id);
+    return stats == null ? null : AudioRecordingStats.fromJson(stats);
+  }
+
+  /// Android only. Detects speech natively from energy, zero-crossing rate and
+  /// spectral flatness at the [AudioFramePosition] bits in [positions], meant
+  /// for [AudioFramePosition.record] and [AudioFramePosition.beforeMixing].
+  /// Only speech start and end events are emitted on [onVoiceActivity], per
+  /// uid. With [gating], only frames of speaking uids reach the Java
+  /// observer. Pass 0 [positions] to stop.
+  static Future<void> setVoiceActivityDetection(int positions,
+      {bool gating = false}) {
+    return _channel.invokeMethod('setVoiceActivityDetection', {
+      'positions': positions,
+      'gating': gating,
+    });
+  }
+
+  /// Android only. Limits the [AudioFramePosition.beforeMixing] frames of the
+  /// registered audio observer to the uids in [allow], or to every uid when it
+  /// is null, minus the uids in [deny]. Other uids are skipped natively before
+  /// any copy. Both lists are replaced atomically on every call.
+  static Future<void> setBeforeMixingUidFilter(
+      {List<int>? allow, List<int> deny = const []}) {
+    return _channel.invokeMethod('setBeforeMixingUidFilter', {
+      'allow': allow,
+      'deny': deny,
+    });
+  }
+
+  /// Android only. Resamples the [AudioFramePosition.beforeMixing] frames of
+  /// the registered audio observer to [sampleRate] natively, with a
+  /// windowed-sinc polyphase filter per uid, since the SDK delivers each
+  /// remote stream at its own rate and [setAudioParams] cannot change it.
+  /// Resampled frames are read-only. Pass 0 to stop.
+  static Future<void> setBeforeMixingSampleRate(int sampleRate) {
+    return _channel.invokeMethod('setBeforeMixingSampleRate', sampleRate);
+  }
+
+  /// Android only. Starts pushing PCM16 into the SDK with
+  /// `IMediaEngine::pushAudioFrame`, at [sampleRate] and [channels], to the
+  /// custom audio track [trackId] or the external audio source. A native
+  /// thread pushes one 10 ms frame every 10 ms once [jitterFrames] are
+  /// buffered, and silence while they are not. Returns false if the engine
+  /// rejects the format.
+  static Future<bool> startAudioInjection(int engineHandle,
+      {int sampleRate = 48000,
+      int channels = 1,
+      int trackId = 0,
+      int jitterFrames = 5,
+      int capacityFrames = 50}) async {
+    // A running injector is replaced, stop writing to it first.
+    AudioInjectionRing.handle = 0;
+    final handle = await _channel.invokeMethod<int>('startAudioInjection', {
+      'engineHandle': engineHandle,
+      'sampleRate': sampleRate,
+      'channels': channels,
+      'trackId': trackId,
+      'jitterFrames': jitterFrames,
+      'capacityFrames': capacityFrames,
+    });
+    AudioInjectionRing.handle = handle ?? 0;
+    return AudioInjectionRing.handle != 0;
+  }
+
+  /// Android only. Queues interleaved PCM16 of any length for
+  /// [startAudioInjection], copied straight into the native ring through
+  /// `dart:ffi` rather than sent as a platform message, so small chunks cost
+  /// no more than large ones. Returns the bytes accepted, fewer than
+  /// `pcm.length` when the buffer is full.
+  static Future<int> pushAudio(Uint8List pcm) async {
+    return AudioInjectionRing.write(pcm);
+  }
+
+  /// Android only. Null unless injecting.
+  static Future<AudioInjectionStats?> getAudioInjectionStats() async {
+    final stats = await _channel
+        .invokeMapMethod<String, dynamic>('getAudioInjectionStats');
+    return stats == null ? null : AudioInjectionStats.fromJson(stats);
+  }
+
+  /// Android only. Stops pushing and drops what is still buffered.
+  static Future<void> stopAudioInjection() {
+    AudioInjectionRing.handle = 0;
+    return _channel.invokeMethod('stopAudioInjection');
+  }
+
+  /// Android only. Enables the external audio sink at [sampleRate] and
+  /// [channels] and pulls the mixed playback with
+  /// `IMediaEngine::pullAudioFrame` every [periodMs], a multiple of 10, into
+  /// a native ring of [depthFrames]. Call before joining the channel, with the
+  /// engine's audio device disabled. Dart reads the ring in place with
+  /// [readRenderedAudio], Java consumers through `AudioRenderPump`.
+  static Future<bool> startAudioRendering(int engineHandle,
+      {int sampleRate = 48000,
+      int channels = 2,
+      int periodMs = 10,
+      int depthFrames = 8}) async {
+    // A running pump is replaced, stop reading from it first.
+    await AudioRenderRing.close();
+    final handle = await _channel.invokeMethod<int>('startAudioRendering', {
+      'engineHandle': engineHandle,
+      'sampleRate': sampleRate,
+      'channels': channels,
+      'periodMs': periodMs,
+      'depthFrames': depthFrames,
+    });
+    AudioRenderRing.open(handle ?? 0);
+    return AudioRenderRing.isOpen;
+  }
+
+  /// Android only. Hands every frame pulled since the last call to [reader],
+  /// oldest first, as interleaved PCM16 read in place from the native ring
+  /// through `dart:ffi`, without a copy or a platform message. A view is only
+  /// valid during its [reader] call, copy what must outlive it. Returns the
+  /// number of frames; with none ready that is 0 and counts as an underrun.
+  static int readRenderedAudio(void Function(Uint8List frame) reader) {
+    return AudioRenderRing.read(reader);
+  }
+
+  /// Android only. Null unless rendering.
+  static Future<AudioRenderStats?> getAudioRenderStats() async {
+    final stats =
+        await _channel.invokeMapMethod<String, dynamic>('getAudioRenderStats');
+    return stats == null ? null : AudioRenderStats.fromJson(stats);
+  }
+
+  /// Android only. Stops pulling and disables the external audio sink.
+  static Future<void> stopAudioRendering() async {
+    await AudioRenderRing.close();
+    await _channel.invokeMethod('stopAudioRendering');
+  }
+
+  /// Android only. Callback interval and duration histograms per
+  /// [AudioFramePosition] that was called back since the last
+  /// [resetAudioCallbackTiming]. Always recorded, without locks.
+  static Future<Map<int, AudioCallbackTiming>> getAudioCallbackTiming() async {
+    final timing = await _channel
+        .invokeMapMethod<int, Map<dynamic, dynamic>>('getAudioCallbackTiming');
+    return (timing ?? {}).map((position, json) =>
+        MapEntry(position, AudioCallbackTiming.fromJson(json)));
+  }
+
+  /// Android only. Clears the histograms of [getAudioCallbackTiming].
+  static Future<void> resetAudioCallbackTiming() {
+    return _channel.invokeMethod('resetAudioCallbackTiming');
+  }
+
+  /// Android only. Ring counters per [AudioFramePosition], empty unless the
+  /// audio observer was registered with [AudioDeliveryMode.asynchronous].
+  static Future<Map<int, AudioDeliveryStats>> getAudioDeliveryStats() async {
+    final stats = await _channel
+        .invokeMapMethod<int, Map<dynamic, dynamic>>('getAudioDeliveryStats');
+    return (stats ?? {}).map((position, json) =>
+        MapEntry(position, AudioDeliveryStats.fromJson(json)));
+  }
+
+  /// Changes the observed [AudioFramePosition] bits of the registered audio
+  /// observer. Positions left out are not delivered at all.
+  static Future<void> setObservedAudioFramePosition(int observedPosition) {
+    return _channel.invokeMethod(
+        'setObservedAudioFramePosition', observedPosition);
+  }
+
+  /// Sets the format the SDK delivers at [position], which is one of
+  /// [AudioFramePosition.playback], [AudioFramePosition.record],
+  /// [AudioFramePosition.mixed] or [AudioFramePosition.earMonitoring].
+  static Future<void> setAudioParams(int position, AudioFrameParams params) {
+    return _channel.invokeMethod('setAudioParams', {
+      'position': position,
+      'params': params.toJson(),
+    });
   }
 
   static Future<void> unregisterAudioFrameObserver() {
     return _channel.invokeMethod('unregisterAudioFrameObserver');
   }
 
-  static Future<void> registerVideoFrameObserver(int engineHandle) {
-    return _channel.invokeMethod('registerVideoFrameObserver', engineHandle);
+  /// Registers the video observer. [formatPreference] is a
+  /// [VideoPixelFormat] and [observedPosition] a set of [VideoFramePosition]
+  /// bits, the SDK defaults are used for those left null.
+  static Future<void> registerVideoFrameObserver(int engineHandle,
+      {VideoBufferType bufferType = VideoBufferType.byteArray,
+      VideoPlaneMode planeMode = VideoPlaneMode.strided,
+      int? formatPreference,
+      bool? rotationApplied,
+      bool? mirrorApplied,
+      int? observedPosition}) {
+    return _channel.invokeMethod('registerVideoFrameObserver', {
+      'engineHandle': engineHandle,
+      'bufferType': bufferType.index,
+      'planeMode': planeMode.index,
+      'formatPreference': formatPreference,
+      'rotationApplied': rotationApplied,
+      'mirrorApplied': mirrorApplied,
+      'observedPosition': observedPosition,
+    });
+  }
+
+  /// Android only. Changes the preferences the SDK queries from the registered
+  /// video observer, those left null are kept. They are held natively, so the
+  /// SDK never calls into the JVM for them.
+  static Future<void> setVideoFramePreferences(
+      {int? formatPreference,
+      bool? rotationApplied,
+      bool? mirrorApplied,
+      int? observedPosition}) {
+    return _channel.invokeMethod('setVideoFramePreferences', {
+      'formatPreference': formatPreference,
+      'rotationApplied': rotationApplied,
+      'mirrorApplied': mirrorApplied,
+      'observedPosition': observedPosition,
+    });
   }
 
   static Future<void> unregisterVideoFrameObserver() {
     return _channel.invokeMethod('unregisterVideoFrameObserver');
   }
+
+  /// Android only. Replaces the native stages run on the video planes at
+  /// [position], one [VideoFramePosition] bit, in order and before the Java
+  /// observer. They persist across re-registration.
+  static Future<void> setVideoProcessors(
+      int position, List<VideoProcessorConfig> processors) {
+    return _channel.invokeMethod('setVideoProcessors', {
+      'position': position,
+      'processors': processors.map((e) => e.toJson()).toList(),
+    });
+  }
+
+  /// Android only. [VideoFramePosition] bits whose frames only go through the
+  /// native stages and never enter the JVM.
+  static Future<void> setVideoNativeOnlyPositions(int positions) {
+    return _channel.invokeMethod('setVideoNativeOnlyPositions', positions);
+  }
+
+  /// Android only. How many times SDK callback threads were attached to and
+  /// detached from the JVM, as `attachCount` and `detachCount`.
+  static Future<Map<String, int>?> getThreadAttachStats() {
+    return _channel.invokeMapMethod<String, int>('getThreadAttachStats');
+  }
 }
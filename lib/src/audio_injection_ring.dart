@@ -0,0 +1,94 @@
+import 'dart:ffi';
+import 'dart:io' show Platform;
+import 'dart:typed_data';
+
+typedef _BeginWriteNative = Int32 Function(Int64 handle);
+typedef _BeginWrite = int Function(int handle);
+typedef _WritePointerNative = Pointer<Uint8> Function(Int64 handle);
+typedef _WritePointer = Pointer<Uint8> Function(int handle);
+typedef _CommitWriteNative = Void Function(Int64 handle, Int32 length);
+typedef _CommitWrite = void Function(int handle, int length);
+typedef _RefuseNative = Void Function(Int64 handle, Int32 length);
+typedef _Refuse = void Function(int handle, int length);
+
+/// The native ring of 10 ms frames behind
+/// `AgoraRtcRawdata.startAudioInjection`, filled through `dart:ffi`. Every
+/// call is a plain function call into `libcpp.so`, no platform message is
+/// involved. The ring has a single producer: only use it from one isolate.
+/// Views of native memory never leave [write], stopping the injector frees
+/// the ring.
+class AudioInjectionRing {
+  static DynamicLibrary? _library;
+  static late final _BeginWrite _beginWrite;
+  static late final _WritePointer _writePointer;
+  static late final _CommitWrite _commitWrite;
+  static late final _Refuse _refuse;
+
+  static bool _load() {
+    if (_library != null) {
+      return true;
+    }
+    if (!Platform.isAndroid) {
+      return false;
+    }
+    final library = DynamicLibrary.open('libcpp.so');
+    _beginWrite = library.lookupFunction<_BeginWriteNative, _BeginWrite>(
+        'AgoraRtcRawdata_AudioInjectorBeginWrite',
+        isLeaf: true);
+    _writePointer = library.lookupFunction<_WritePointerNative, _WritePointer>(
+        'AgoraRtcRawdata_AudioInjectorWritePointer',
+        isLeaf: true);
+    _commitWrite = library.lookupFunction<_CommitWriteNative, _CommitWrite>(
+        'AgoraRtcRawdata_AudioInjectorCommitWrite',
+        isLeaf: true);
+    _refuse = library.lookupFunction<_RefuseNative, _Refuse>(
+        'AgoraRtcRawdata_AudioInjectorRefuse',
+        isLeaf: true);
+    _library = library;
+    return true;
+  }
+
+  /// The native injector, 0 while stopped.
+  static int handle = 0;
+
+  /// The free space of the frame being filled, a view of native memory that
+  /// stays valid until [_commit]. Empty when the ring is full or stopped.
+  static Uint8List _begin() {
+    if (handle == 0 || !_load()) {
+      return Uint8List(0);
+    }
+    final length = _beginWrite(handle);
+    if (length <= 0) {
+      return Uint8List(0);
+    }
+    return _writePointer(handle).asTypedList(length);
+  }
+
+  /// Publishes [length] bytes written at the start of the view from [_begin].
+  static void _commit(int length) {
+    if (handle != 0 && _load()) {
+      _commitWrite(handle, length);
+    }
+  }
+
+  /// Copies as much of [pcm] into the ring as fits, returns the bytes taken.
+  static int write(Uint8List pcm) {
+    var accepted = 0;
+    while (accepted < pcm.length) {
+      final free = _begin();
+      if (free.isEmpty) {
+        break;
+      }
+      final chunk = free.length < pcm.length - accepted
+          ? free.length
+          : pcm.length - accepted;
+      free.setRange(0, chunk, pcm, accepted);
+      _commit(chunk);
+      accepted += chunk;
+    }
+    if (accepted < pcm.length && handle != 0 && _load()) {
+      _refuse(handle, pcm.length - accepted);
+    }
+    return accepted;
+  }
+}
@@ -0,0 +1,109 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:io' show Platform;
+import 'dart:typed_data';
+
+typedef _AcquireNative = Pointer<Uint8> Function(Int64 handle);
+typedef _Acquire = Pointer<Uint8> Function(int handle);
+typedef _FrameBytesNative = Int32 Function(Int64 handle);
+typedef _FrameBytes = int Function(int handle);
+typedef _ReleaseNative = Void Function(Int64 handle);
+typedef _Release = void Function(int handle);
+typedef _BufferedFramesNative = Int32 Function(Int64 handle);
+typedef _BufferedFrames = int Function(int handle);
+
+/// The native ring of pulled frames behind
+/// `AgoraRtcRawdata.startAudioRendering`, read in place through `dart:ffi`.
+/// Every call is a plain function call into `libcpp.so`, no platform message
+/// is involved. The ring has a single consumer: only use it from one isolate.
+/// A frame is only lent to the reader for the duration of one call, stopping
+/// the pump frees the ring.
+class AudioRenderRing {
+  static DynamicLibrary? _library;
+  static late final _Acquire _acquire;
+  static late final _FrameBytes _frameBytes;
+  static late final _Release _release;
+  static late final _BufferedFrames _bufferedFrames;
+
+  static bool _load() {
+    if (_library != null) {
+      return true;
+    }
+    if (!Platform.isAndroid) {
+      return false;
+    }
+    final library = DynamicLibrary.open('libcpp.so');
+    _acquire = library.lookupFunction<_AcquireNative, _Acquire>(
+        'AgoraRtcRawdata_AudioRenderPumpAcquire',
+        isLeaf: true);
+    _frameBytes = library.lookupFunction<_FrameBytesNative, _FrameBytes>(
+        'AgoraRtcRawdata_AudioRenderPumpFrameBytes',
+        isLeaf: true);
+    _release = library.lookupFunction<_ReleaseNative, _Release>(
+        'AgoraRtcRawdata_AudioRenderPumpRelease',
+        isLeaf: true);
+    _bufferedFrames =
+        library.lookupFunction<_BufferedFramesNative, _BufferedFrames>(
+            'AgoraRtcRawdata_AudioRenderPumpBufferedFrames',
+            isLeaf: true);
+    _library = library;
+    return true;
+  }
+
+  /// The native pump, 0 while stopped. Only set through [open] and [close].
+  static int _handle = 0;
+  static bool _reading = false;
+  static Completer<void>? _idle;
+
+  static void open(int handle) {
+    _handle = handle;
+  }
+
+  /// Stops handing out frames. Completes once no frame is lent out any more,
+  /// only then may the pump be stopped.
+  static Future<void> close() {
+    _handle = 0;
+    if (!_reading) {
+      return Future.value();
+    }
+    return (_idle ??= Completer<void>()).future;
+  }
+
+  static bool get isOpen => _handle != 0;
+
+  /// Hands the pulled frames to [reader] as views of the ring slots the SDK
+  /// wrote them into, oldest first, and returns how many there were. Each view
+  /// is only valid during its [reader] call. With nothing ready the ring is
+  /// still asked once, which counts as an underrun.
+  static int read(void Function(Uint8List frame) reader) {
+    if (_handle == 0 || _reading || !_load()) {
+      return 0;
+    }
+    final handle = _handle;
+    final frameBytes = _frameBytes(handle);
+    final buffered = _bufferedFrames(handle);
+    var frames = 0;
+    _reading = true;
+    try {
+      // Frames pulled meanwhile wait for the next call. [close] from within
+      // [reader] stops the loop, the pump stays alive until it returns.
+      while (frames < (buffered > 0 ? buffered : 1) && _handle == handle) {
+        final data = _acquire(handle);
+        if (data == nullptr) {
+          break;
+        }
+        try {
+          reader(data.asTypedList(frameBytes));
+        } finally {
+          _release(handle);
+        }
+        ++frames;
+      }
+    } finally {
+      _reading = false;
+      _idle?.complete();
+      _idle = null;
+    }
+    return frames;
+  }
+}